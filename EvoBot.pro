@@ -1,21 +1,17 @@
-QT += bluetooth quick
+TEMPLATE = subdirs
 
-CONFIG += c++14
+SUBDIRS += \
+    bench \
+    demo \
+    eventdump \
+    evobot \
+    tests
 
-DEFINES += \
-    QT_DEPRECATED_WARNINGS \
-    QT_DISABLE_DEPRECATED_BEFORE=0x060000
+# the daemon reads standard input through a socket notifier
+unix: SUBDIRS += daemon
 
-HEADERS += \
-    controller.h \
-    robotservice.h \
-    utilities.h
-
-SOURCES += \
-    controller.cpp \
-    main.cpp \
-    robotservice.cpp \
-    utilities.cpp
-
-RESOURCES += \
-    main.qrc
+bench.depends = evobot
+daemon.depends = evobot
+demo.depends = evobot
+eventdump.depends = evobot
+tests.depends = evobot
@@ -0,0 +1,11 @@
+TARGET = evobot-bench
+
+QT = core
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../evobot/evobot.pri)
+
+SOURCES += \
+    main.cpp
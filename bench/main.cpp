@@ -0,0 +1,250 @@
+#include "robotmetrics.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+
+struct Settings
+{
+    int duration = 3000;
+    int commandInterval = 20;
+    int writeLatency = 15;
+    int writeJitter = 0;
+    double packetLoss = 0;
+    bool writeWithoutResponse = false;
+};
+
+struct Result
+{
+    int commands = 0;
+    int writesIssued = 0;
+    int writesAcknowledged = 0;
+    int writesLost = 0;
+    int framesReceived = 0;
+    double commandLatency = 0;
+    double acknowledgeLatency = 0;
+    double elapsed = 0;
+    double cpuTime = 0;
+};
+
+// A simulated robot, and the change it still waits for. The command latency is the time from
+// changing the service's message until the robot received a frame carrying that change.
+struct Robot
+{
+    std::unique_ptr<RobotService> service;
+    SimulatedTransport *transport = {};
+    RobotFrame pendingFrame;
+    qint64 pendingSince = -1;
+    qint64 totalLatency = 0;
+    int latencySamples = 0;
+};
+
+Result measure(int count, const Settings &settings)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    std::vector<Robot> robots;
+    robots.reserve(static_cast<size_t>(count));
+
+    for (auto i = 0; i < count; ++i) {
+        Robot robot;
+        robot.service = std::make_unique<RobotService>();
+        robot.service->setWriteWithoutResponse(settings.writeWithoutResponse);
+
+        robot.transport = new SimulatedTransport;
+        robot.transport->setWriteLatency(settings.writeLatency);
+        robot.transport->setWriteJitter(settings.writeJitter);
+        robot.transport->setPacketLoss(settings.packetLoss);
+        robot.service->attach(robot.transport);
+
+        robots.push_back(std::move(robot));
+    }
+
+    // the vector doesn't grow anymore, so the robots can be captured
+    for (auto &robot: robots) {
+        const auto entry = &robot;
+
+        QObject::connect(robot.transport, &SimulatedTransport::currentFrameChanged,
+                         robot.service.get(), [entry, &clock](const auto &frame) {
+            if (entry->pendingSince >= 0 && frame == entry->pendingFrame) {
+                entry->totalLatency += clock.nsecsElapsed() - std::exchange(entry->pendingSince, -1);
+                ++entry->latencySamples;
+            }
+        });
+
+        robot.transport->connectToRobot();
+    }
+
+    Result result;
+    auto tick = 0;
+
+    // cycles through the drive actions, each robot at its own phase
+    QTimer commandTimer;
+    commandTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&commandTimer, &QTimer::timeout, [&robots, &result, &tick, &clock] {
+        for (size_t i = 0; i < robots.size(); ++i) {
+            auto &robot = robots[i];
+
+            robot.service->setDrive(1 + static_cast<int>((static_cast<size_t>(tick) + i) % 16));
+            robot.pendingFrame = robot.service->currentMessage();
+
+            if (robot.pendingSince < 0)
+                robot.pendingSince = clock.nsecsElapsed();
+
+            ++result.commands;
+        }
+
+        ++tick;
+    });
+
+    QEventLoop loop;
+    QTimer::singleShot(settings.duration, &loop, &QEventLoop::quit);
+
+    const auto cpuStart = std::clock();
+    const auto start = clock.nsecsElapsed();
+
+    commandTimer.start(settings.commandInterval);
+    loop.exec();
+    commandTimer.stop();
+
+    result.elapsed = static_cast<double>(clock.nsecsElapsed() - start) / 1e9;
+    result.cpuTime = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    qint64 totalLatency = 0;
+    auto latencySamples = 0;
+    auto totalAcknowledgeLatency = 0.0;
+
+    for (const auto &robot: robots) {
+        const auto metrics = robot.service->metrics();
+
+        result.writesIssued += metrics->writesIssued();
+        result.writesAcknowledged += metrics->writesAcknowledged();
+        result.writesLost += metrics->writesLost();
+        result.framesReceived += robot.transport->framesReceived();
+        totalAcknowledgeLatency += metrics->averageLatency() * metrics->writesAcknowledged();
+
+        totalLatency += robot.totalLatency;
+        latencySamples += robot.latencySamples;
+    }
+
+    if (latencySamples > 0)
+        result.commandLatency = static_cast<double>(totalLatency) / latencySamples / 1e6;
+    if (result.writesAcknowledged > 0)
+        result.acknowledgeLatency = totalAcknowledgeLatency / result.writesAcknowledged;
+
+    return result;
+}
+
+bool parseInt(const QCommandLineParser &options, const QCommandLineOption &option, int minimum, int *value)
+{
+    if (!options.isSet(option))
+        return true;
+
+    auto valid = false;
+    *value = options.value(option).toInt(&valid);
+
+    if (!valid || *value < minimum) {
+        qWarning("Invalid value `%ls' for --%ls", qUtf16Printable(options.value(option)),
+                 qUtf16Printable(option.names().first()));
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+// Drives 1..N simulated robots and reports the figures of RobotMetrics for each fleet size.
+class BenchmarkApplication : public QCoreApplication
+{
+    Q_OBJECT
+
+public:
+    using QCoreApplication::QCoreApplication;
+
+    int run()
+    {
+        setApplicationName("evobot-bench");
+
+        const QCommandLineOption robotsOption{"robots", tr("Measure up to <count> robots, 8 by default."), tr("count")};
+        const QCommandLineOption durationOption{"duration", tr("Run each fleet size for <ms> milliseconds."), tr("ms")};
+        const QCommandLineOption intervalOption{"command-interval", tr("Change each robot's drive every <ms> milliseconds."), tr("ms")};
+        const QCommandLineOption latencyOption{"latency", tr("Simulate a write latency of <ms> milliseconds."), tr("ms")};
+        const QCommandLineOption jitterOption{"jitter", tr("Add up to <ms> milliseconds of random latency."), tr("ms")};
+        const QCommandLineOption lossOption{"packet-loss", tr("Lose writes with the probability <ratio>."), tr("ratio")};
+        const QCommandLineOption withoutResponseOption{"without-response", tr("Write without response.")};
+
+        QCommandLineParser options;
+        options.setApplicationDescription(tr("Measures the control stack with simulated robots."));
+        options.addHelpOption();
+        options.addOptions({robotsOption, durationOption, intervalOption, latencyOption,
+                            jitterOption, lossOption, withoutResponseOption});
+        options.process(*this);
+
+        Settings settings;
+        auto robots = 8;
+
+        if (!parseInt(options, robotsOption, 1, &robots)
+                || !parseInt(options, durationOption, 1, &settings.duration)
+                || !parseInt(options, intervalOption, 1, &settings.commandInterval)
+                || !parseInt(options, latencyOption, 0, &settings.writeLatency)
+                || !parseInt(options, jitterOption, 0, &settings.writeJitter))
+            return EXIT_FAILURE;
+
+        if (options.isSet(lossOption)) {
+            auto valid = false;
+            settings.packetLoss = options.value(lossOption).toDouble(&valid);
+
+            if (!valid || settings.packetLoss < 0 || settings.packetLoss >= 1) {
+                qWarning("Invalid packet loss `%ls'", qUtf16Printable(options.value(lossOption)));
+                return EXIT_FAILURE;
+            }
+        }
+
+        settings.writeWithoutResponse = options.isSet(withoutResponseOption);
+
+        std::printf("# %d ms per fleet size, drive changes every %d ms, write latency %d+%d ms, "
+                    "%.1f%% packet loss, writes %s response\n",
+                    settings.duration, settings.commandInterval, settings.writeLatency, settings.writeJitter,
+                    100 * settings.packetLoss, settings.writeWithoutResponse ? "without" : "with");
+        std::printf("%6s %10s %10s %10s %10s %12s %12s %8s %12s\n", "robots", "commands/s", "writes/s",
+                    "frames/s", "acks/s", "latency/ms", "ack/ms", "lost", "cpu/frame/us");
+
+        for (auto count = 1; count <= robots; ++count) {
+            const auto result = measure(count, settings);
+            const auto cpuPerFrame = result.writesIssued > 0 ? 1e6 * result.cpuTime / result.writesIssued : 0.0;
+
+            std::printf("%6d %10.1f %10.1f %10.1f %10.1f %12.2f %12.2f %8d %12.2f\n", count,
+                        result.commands / result.elapsed, result.writesIssued / result.elapsed,
+                        result.framesReceived / result.elapsed, result.writesAcknowledged / result.elapsed,
+                        result.commandLatency, result.acknowledgeLatency, result.writesLost, cpuPerFrame);
+            std::fflush(stdout);
+        }
+
+        return EXIT_SUCCESS;
+    }
+};
+
+} // namespace EvoBot
+
+int main(int argc, char *argv[])
+{
+    return EvoBot::BenchmarkApplication{argc, argv}.run();
+}
+
+#include "main.moc"
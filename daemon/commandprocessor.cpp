@@ -0,0 +1,148 @@
+#include "commandprocessor.h"
+
+#include "controller.h"
+#include "robotservice.h"
+#include "sequencer.h"
+
+#include <QLoggingCategory>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcCommandProcessor, "evobot.commandprocessor")
+
+const auto s_helpText = QByteArrayLiteral(
+        "ok commands: <actions> like \"F2 O -F2\", pause, drive <x> <y>, "
+        "sound <index>, loop <index>, macro <name> <macro> like \"F3 500ms; L1 200ms; V5\", "
+        "play <name>, state, help, quit");
+
+QByteArray ok(const QByteArray &text = {})
+{
+    return text.isEmpty() ? QByteArrayLiteral("ok") : "ok " + text;
+}
+
+QByteArray error(const QByteArray &text)
+{
+    return "error " + text;
+}
+
+} // namespace
+
+class CommandProcessor::Private
+{
+public:
+    explicit Private(Controller *controller, CommandProcessor *q)
+        : q{q}
+        , m_controller{controller}
+    {
+        m_sequencer.addRobotService(controller->robotService());
+    }
+
+    QByteArray execute(const QByteArray &line)
+    {
+        const auto arguments = line.simplified().split(' ');
+        const auto &command = arguments.first();
+
+        qCDebug(lcCommandProcessor, "Executing `%s'", line.constData());
+
+        if (command.isEmpty())
+            return {};
+
+        if (command == "help")
+            return s_helpText;
+        if (command == "state")
+            return ok(state());
+
+        if (command == "quit") {
+            emit q->quitRequested();
+            return ok();
+        }
+
+        if (command == "macro") {
+            if (arguments.size() < 3)
+                return error("usage: macro <name> <macro>");
+            if (!m_sequencer.defineMacro(QString::fromLatin1(arguments[1]),
+                                         QString::fromLatin1(arguments.mid(2).join(' '))))
+                return error(m_sequencer.errorString().toUtf8());
+
+            return ok();
+        }
+
+        if (m_controller->state() != Controller::ConnectedState)
+            return error(QByteArrayLiteral("not connected, state is ") + Controller::stateName(m_controller->state()));
+
+        if (command == "play") {
+            if (arguments.size() != 2)
+                return error("usage: play <name>");
+            if (!m_sequencer.playMacro(QString::fromLatin1(arguments[1])))
+                return error(m_sequencer.errorString().toUtf8());
+
+            return ok();
+        }
+
+        // any other command takes over from a playing macro
+        m_sequencer.stop();
+
+        const auto service = m_controller->robotService();
+
+        if (command == "pause")
+            return result(service->startAction(RobotService::PauseAction));
+
+        if (command == "drive") {
+            auto xValid = false;
+            auto yValid = false;
+            const auto x = arguments.value(1).toDouble(&xValid);
+            const auto y = arguments.value(2).toDouble(&yValid);
+
+            if (arguments.size() != 3 || !xValid || !yValid)
+                return error("usage: drive <x> <y>");
+
+            service->setDriveVector(x, y);
+            return ok();
+        }
+
+        if (command == "sound" || command == "loop") {
+            auto valid = false;
+            const auto index = arguments.value(1).toInt(&valid);
+
+            if (arguments.size() != 2 || !valid)
+                return error("usage: " + command + " <index>");
+
+            return result(command == "sound" ? service->playSound(index) : service->playLoop(index));
+        }
+
+        return result(service->applyActions(QString::fromLatin1(line)));
+    }
+
+    QByteArray state() const
+    {
+        return Controller::stateName(m_controller->state());
+    }
+
+private:
+    static QByteArray result(bool succeeded)
+    {
+        return succeeded ? ok() : error("command rejected");
+    }
+
+    CommandProcessor *const q;
+    Controller *const m_controller;
+    Sequencer m_sequencer;
+};
+
+CommandProcessor::CommandProcessor(Controller *controller, QObject *parent)
+    : QObject{parent}
+    , d{new Private{controller, this}}
+{}
+
+CommandProcessor::~CommandProcessor()
+{
+    delete d;
+}
+
+QByteArray CommandProcessor::execute(const QByteArray &line)
+{
+    return d->execute(line);
+}
+
+} // namespace EvoBot
@@ -0,0 +1,32 @@
+#ifndef EVOBOT_COMMANDPROCESSOR_H
+#define EVOBOT_COMMANDPROCESSOR_H
+
+#include <QObject>
+
+namespace EvoBot {
+
+class Controller;
+
+// Executes the text commands of the daemon, one command per line. Each command gets
+// a single line reply starting with "ok" or "error"; see "help" for the commands.
+class CommandProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CommandProcessor(Controller *controller, QObject *parent = {});
+    ~CommandProcessor() override;
+
+    QByteArray execute(const QByteArray &line);
+
+signals:
+    void quitRequested();
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_COMMANDPROCESSOR_H
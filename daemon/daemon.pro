@@ -0,0 +1,17 @@
+TARGET = evobotd
+
+QT = core network
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../evobot/evobot.pri)
+
+HEADERS += \
+    commandprocessor.h \
+    robotgateway.h
+
+SOURCES += \
+    commandprocessor.cpp \
+    main.cpp \
+    robotgateway.cpp
@@ -0,0 +1,233 @@
+#include "commandprocessor.h"
+#include "robotgateway.h"
+
+#include "controller.h"
+#include "eventsink.h"
+#include "robotservice.h"
+#include "sessionrecorder.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSocketNotifier>
+
+#include <cstdio>
+#include <unistd.h>
+
+namespace EvoBot {
+
+namespace {
+
+const auto s_maximumLineLength = 4096;
+
+} // namespace
+
+// Controls a robot without any GUI, for headless boxes. Commands are read from standard
+// input, and optionally from a local socket. State changes are reported to all clients.
+class DaemonApplication : public QCoreApplication
+{
+    Q_OBJECT
+
+public:
+    using QCoreApplication::QCoreApplication;
+
+    int run()
+    {
+        setApplicationName("evobotd");
+
+        const QCommandLineOption socketOption{"socket", tr("Accept commands on the local socket <name>."), tr("name")};
+        const QCommandLineOption gatewayOption{"udp-port", tr("Accept binary commands on UDP port <port>."), tr("port")};
+        const QCommandLineOption recordOption{"record", tr("Record the robot's traffic to the session log <file>."), tr("file")};
+        const QCommandLineOption eventsOption{"events", tr("Log diagnostic events to <file>, "
+                                                          "see evobot-eventdump."), tr("file")};
+        const QCommandLineOption profileOption{"connection-profile", tr("Request the connection <profile>: "
+                                                                        "low-latency, balanced or power-saving."), tr("profile")};
+        const QCommandLineOption cacheOption{"device-cache", tr("Contact the last connected robot directly, "
+                                                                "without device discovery.")};
+        const QCommandLineOption noInputOption{"no-stdin", tr("Do not read commands from standard input.")};
+
+        QCommandLineParser options;
+        options.setApplicationDescription(tr("Controls an Evolution Robot from the command line."));
+        options.addHelpOption();
+        options.addOptions({socketOption, gatewayOption, recordOption, eventsOption, profileOption,
+                            cacheOption, noInputOption});
+        options.process(*this);
+
+        connect(&m_processor, &CommandProcessor::quitRequested, this, &QCoreApplication::quit, Qt::QueuedConnection);
+        connect(&m_controller, &Controller::stateChanged, this, [this](auto state) { this->onStateChanged(state); });
+        connect(&m_controller, &Controller::errorOccured, this, [this](auto, auto errorString) {
+            broadcast("error " + errorString.toUtf8());
+        });
+
+        if (options.isSet(socketOption) && !listen(options.value(socketOption)))
+            return EXIT_FAILURE;
+
+        if (options.isSet(profileOption)) {
+            const auto profile = options.value(profileOption);
+
+            if (profile == "low-latency") {
+                m_controller.setConnectionProfile(Controller::LowLatencyProfile);
+            } else if (profile == "balanced") {
+                m_controller.setConnectionProfile(Controller::BalancedProfile);
+            } else if (profile == "power-saving") {
+                m_controller.setConnectionProfile(Controller::PowerSavingProfile);
+            } else {
+                qWarning("Unknown connection profile `%ls'", qUtf16Printable(profile));
+                return EXIT_FAILURE;
+            }
+        }
+
+        m_controller.setDeviceCacheEnabled(options.isSet(cacheOption));
+
+        if (options.isSet(recordOption)) {
+            if (!m_recorder.open(options.value(recordOption)))
+                return EXIT_FAILURE;
+
+            m_controller.robotService()->setRecorder(&m_recorder);
+        }
+
+        if (options.isSet(eventsOption)) {
+            if (!m_eventSink.open(options.value(eventsOption)))
+                return EXIT_FAILURE;
+
+            EventSink::install(&m_eventSink);
+        }
+
+        if (options.isSet(gatewayOption)) {
+            auto valid = false;
+            const auto port = options.value(gatewayOption).toUShort(&valid);
+
+            if (!valid || !m_gateway.listen(QHostAddress::Any, port)) {
+                qWarning("Cannot accept commands on UDP port `%ls'", qUtf16Printable(options.value(gatewayOption)));
+                return EXIT_FAILURE;
+            }
+
+            m_gateway.addRobot(0, m_controller.robotService());
+        }
+
+        if (!options.isSet(noInputOption)) {
+            m_input = new QSocketNotifier{STDIN_FILENO, QSocketNotifier::Read, this};
+            connect(m_input, &QSocketNotifier::activated, this, [this] { this->onInputReady(); });
+        } else if (!m_server.isListening() && !m_gateway.isListening()) {
+            qWarning("Neither standard input, a local socket nor the UDP gateway accept commands");
+            return EXIT_FAILURE;
+        }
+
+        return exec();
+    }
+
+private:
+    bool listen(const QString &name)
+    {
+        QLocalServer::removeServer(name);
+
+        if (!m_server.listen(name)) {
+            qWarning("Cannot listen on `%ls': %ls", qUtf16Printable(name), qUtf16Printable(m_server.errorString()));
+            return false;
+        }
+
+        connect(&m_server, &QLocalServer::newConnection, this, [this] { this->onNewConnection(); });
+        return true;
+    }
+
+    void onStateChanged(Controller::State state)
+    {
+        broadcast(QByteArrayLiteral("state ") + Controller::stateName(state));
+    }
+
+    void onInputReady()
+    {
+        char buffer[512];
+        const auto length = ::read(STDIN_FILENO, buffer, sizeof buffer);
+
+        if (length <= 0) {
+            m_input->setEnabled(false);
+
+            if (!m_server.isListening() && !m_gateway.isListening())
+                quit();
+
+            return;
+        }
+
+        m_inputBuffer.append(buffer, static_cast<int>(length));
+
+        for (auto end = m_inputBuffer.indexOf('\n'); end >= 0; end = m_inputBuffer.indexOf('\n')) {
+            const auto line = m_inputBuffer.left(end);
+            m_inputBuffer.remove(0, end + 1);
+            writeOutput(m_processor.execute(line));
+        }
+
+        if (m_inputBuffer.size() > s_maximumLineLength) {
+            m_inputBuffer.clear();
+            writeOutput("error line too long");
+        }
+    }
+
+    void onNewConnection()
+    {
+        while (const auto client = m_server.nextPendingConnection()) {
+            connect(client, &QLocalSocket::disconnected, client, &QObject::deleteLater);
+            connect(client, &QLocalSocket::readyRead, client, [this, client] { this->onClientReady(client); });
+            m_clients.append(client);
+
+            connect(client, &QObject::destroyed, this, [this, client] { m_clients.removeOne(client); });
+        }
+    }
+
+    void onClientReady(QLocalSocket *client)
+    {
+        while (client->canReadLine())
+            writeReply(client, m_processor.execute(client->readLine().trimmed()));
+
+        if (client->bytesAvailable() > s_maximumLineLength) {
+            writeReply(client, "error line too long");
+            client->disconnectFromServer();
+        }
+    }
+
+    void writeOutput(const QByteArray &reply)
+    {
+        if (!reply.isEmpty()) {
+            std::fwrite(reply.constData(), 1, static_cast<size_t>(reply.size()), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout);
+        }
+    }
+
+    static void writeReply(QLocalSocket *client, const QByteArray &reply)
+    {
+        if (!reply.isEmpty())
+            client->write(reply + '\n');
+    }
+
+    void broadcast(const QByteArray &event)
+    {
+        if (m_input)
+            writeOutput(event);
+
+        for (const auto client: m_clients)
+            writeReply(client, event);
+    }
+
+    // declared first, so that the events of tearing down the controller still get written
+    EventSink m_eventSink;
+    // declared before the server, whose destructor deletes the sockets still listed here
+    QList<QLocalSocket *> m_clients;
+    Controller m_controller;
+    CommandProcessor m_processor{&m_controller};
+    RobotGateway m_gateway;
+    SessionRecorder m_recorder;
+    QLocalServer m_server;
+    QSocketNotifier *m_input = nullptr;
+    QByteArray m_inputBuffer;
+};
+
+} // namespace EvoBot
+
+int main(int argc, char *argv[])
+{
+    return EvoBot::DaemonApplication{argc, argv}.run();
+}
+
+#include "main.moc"
@@ -0,0 +1,348 @@
+#include "robotgateway.h"
+
+#include "robotservice.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcRobotGateway, "evobot.robotgateway")
+
+const auto s_defaultSubscriptionTimeout = 30000;
+const auto s_headerSize = 2;
+const auto s_actionSize = s_headerSize + 3;
+const auto s_frameSize = s_headerSize + RobotFrame::Size;
+
+} // namespace
+
+class RobotGateway::Private
+{
+    struct Subscriber
+    {
+        QHostAddress address;
+        quint16 port;
+        quint8 robot;
+        qint64 lastSeen;
+    };
+
+public:
+    explicit Private(RobotGateway *q)
+        : q{q}
+    {
+        m_clock.start();
+
+        connect(&m_socket, &QUdpSocket::readyRead, q, [this] { onReadyRead(); });
+    }
+
+    bool listen(const QHostAddress &address, quint16 port)
+    {
+        close();
+
+        if (!m_socket.bind(address, port)) {
+            qCWarning(lcRobotGateway, "Cannot bind to port %d: %ls", port, qUtf16Printable(m_socket.errorString()));
+            return false;
+        }
+
+        qCInfo(lcRobotGateway, "Listening on port %d", m_socket.localPort());
+        return true;
+    }
+
+    void close()
+    {
+        m_socket.close();
+        m_subscribers.clear();
+    }
+
+    bool isListening() const { return m_socket.state() == QUdpSocket::BoundState; }
+    quint16 port() const { return m_socket.localPort(); }
+    QString errorString() const { return m_socket.errorString(); }
+
+    void addRobot(quint8 id, RobotService *service)
+    {
+        removeRobot(id);
+
+        if (!service)
+            return;
+
+        m_robots.insert(id, service);
+
+        connect(service, &RobotService::currentMessageChanged, q, [this, id](const auto &message) {
+            publish(id, FrameMessage, message.constData(), RobotFrame::Size);
+        });
+        connect(service, &RobotService::stateChanged, q, [this, id](auto state) {
+            const auto value = static_cast<char>(state);
+            publish(id, StateMessage, &value, 1);
+        });
+        connect(service, &RobotService::currentSoundChanged, q, [this, id](auto sound) {
+            const auto value = static_cast<char>(sound);
+            publish(id, SoundMessage, &value, 1);
+        });
+        connect(service, &QObject::destroyed, q, [this, id] { m_robots.remove(id); });
+    }
+
+    void removeRobot(quint8 id)
+    {
+        if (const auto service = m_robots.take(id))
+            service->disconnect(q);
+    }
+
+    void setSubscriptionTimeout(int timeout)
+    {
+        timeout = qMax(0, timeout);
+
+        if (std::exchange(m_subscriptionTimeout, timeout) != timeout)
+            emit q->subscriptionTimeoutChanged(m_subscriptionTimeout);
+    }
+
+    int subscriptionTimeout() const { return m_subscriptionTimeout; }
+
+private:
+    // All pending datagrams are handled before committing, so that commands
+    // arriving together reach the transmit scheduler as a single change.
+    void onReadyRead()
+    {
+        while (m_socket.hasPendingDatagrams()) {
+            m_datagram.resize(static_cast<int>(qMax<qint64>(0, m_socket.pendingDatagramSize())));
+
+            QHostAddress sender;
+            quint16 senderPort = 0;
+
+            const auto size = m_socket.readDatagram(m_datagram.data(), m_datagram.size(), &sender, &senderPort);
+
+            if (size >= 0)
+                handleDatagram(m_datagram.constData(), static_cast<int>(size), sender, senderPort);
+        }
+
+        for (const auto service: std::exchange(m_updatedRobots, {}))
+            service->commit();
+    }
+
+    void handleDatagram(const char *data, int size, const QHostAddress &sender, quint16 senderPort)
+    {
+        if (size < s_headerSize) {
+            qCDebug(lcRobotGateway, "Ignoring truncated datagram from %ls", qUtf16Printable(sender.toString()));
+            return;
+        }
+
+        const auto type = static_cast<quint8>(data[0]);
+        const auto id = static_cast<quint8>(data[1]);
+
+        refreshSubscriber(sender, senderPort);
+
+        switch (type) {
+        case SubscribeMessage:
+            subscribe(sender, senderPort, id);
+            return;
+
+        case UnsubscribeMessage:
+            unsubscribe(sender, senderPort, id);
+            return;
+
+        case FrameMessage:
+            if (size != s_frameSize)
+                break;
+
+            if (const auto service = beginUpdate(id)) {
+                service->setCurrentMessage(RobotFrame::fromByteArray(QByteArray::fromRawData(data + s_headerSize, RobotFrame::Size)));
+                return;
+            }
+
+            reply(sender, senderPort, type, id, UnknownRobotError);
+            return;
+
+        case StartActionMessage:
+        case StopActionMessage:
+            if (size != s_actionSize)
+                break;
+
+            if (const auto service = beginUpdate(id)) {
+                const auto action = QChar::fromLatin1(data[s_headerSize]);
+                const auto index = qFromBigEndian<quint16>(data + s_headerSize + 1);
+                const auto accepted = (type == StartActionMessage ? service->startAction(action, index)
+                                                                  : service->stopAction(action, index));
+
+                if (!accepted)
+                    reply(sender, senderPort, type, id, RejectedError);
+
+                return;
+            }
+
+            reply(sender, senderPort, type, id, UnknownRobotError);
+            return;
+        }
+
+        reply(sender, senderPort, type, id, MalformedMessageError);
+    }
+
+    RobotService *beginUpdate(quint8 id)
+    {
+        const auto service = m_robots.value(id);
+
+        if (service && std::find(m_updatedRobots.begin(), m_updatedRobots.end(), service) == m_updatedRobots.end()) {
+            service->beginUpdate();
+            m_updatedRobots.push_back(service);
+        }
+
+        return service;
+    }
+
+    void subscribe(const QHostAddress &address, quint16 port, quint8 robot)
+    {
+        if (robot != AllRobots && !m_robots.contains(robot)) {
+            reply(address, port, SubscribeMessage, robot, UnknownRobotError);
+            return;
+        }
+
+        if (findSubscriber(address, port, robot) == m_subscribers.end()) {
+            qCDebug(lcRobotGateway, "%ls:%d subscribed to robot %d", qUtf16Printable(address.toString()), port, robot);
+            m_subscribers.push_back({address, port, robot, m_clock.elapsed()});
+        }
+
+        // a new subscriber needs the current state to start with
+        for (auto it = m_robots.cbegin(); it != m_robots.cend(); ++it) {
+            if (robot == AllRobots || robot == it.key()) {
+                const auto state = static_cast<char>(it.value()->state());
+                const auto message = it.value()->currentMessage();
+
+                send(address, port, StateMessage, it.key(), &state, 1);
+                send(address, port, FrameMessage, it.key(), message.constData(), RobotFrame::Size);
+            }
+        }
+    }
+
+    void unsubscribe(const QHostAddress &address, quint16 port, quint8 robot)
+    {
+        const auto it = findSubscriber(address, port, robot);
+
+        if (it != m_subscribers.end())
+            m_subscribers.erase(it);
+    }
+
+    std::vector<Subscriber>::iterator findSubscriber(const QHostAddress &address, quint16 port, quint8 robot)
+    {
+        return std::find_if(m_subscribers.begin(), m_subscribers.end(), [&](const auto &subscriber) {
+            return subscriber.port == port && subscriber.robot == robot && subscriber.address == address;
+        });
+    }
+
+    void refreshSubscriber(const QHostAddress &address, quint16 port)
+    {
+        const auto now = m_clock.elapsed();
+
+        for (auto &subscriber: m_subscribers) {
+            if (subscriber.port == port && subscriber.address == address)
+                subscriber.lastSeen = now;
+        }
+    }
+
+    void publish(quint8 robot, MessageType type, const char *payload, int size)
+    {
+        if (m_subscriptionTimeout > 0) {
+            const auto deadline = m_clock.elapsed() - m_subscriptionTimeout;
+
+            m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(), [deadline](const auto &subscriber) {
+                return subscriber.lastSeen < deadline;
+            }), m_subscribers.end());
+        }
+
+        for (const auto &subscriber: m_subscribers) {
+            if (subscriber.robot == robot || subscriber.robot == AllRobots)
+                send(subscriber.address, subscriber.port, type, robot, payload, size);
+        }
+    }
+
+    void reply(const QHostAddress &address, quint16 port, quint8 type, quint8 robot, Error error)
+    {
+        const char payload[] = {static_cast<char>(type), static_cast<char>(error)};
+        send(address, port, ErrorMessage, robot, payload, sizeof payload);
+    }
+
+    void send(const QHostAddress &address, quint16 port, quint8 type, quint8 robot, const char *payload, int size)
+    {
+        char datagram[s_frameSize];
+
+        Q_ASSERT(size <= s_frameSize - s_headerSize);
+
+        datagram[0] = static_cast<char>(type);
+        datagram[1] = static_cast<char>(robot);
+        std::copy(payload, payload + size, datagram + s_headerSize);
+
+        m_socket.writeDatagram(datagram, s_headerSize + size, address, port);
+    }
+
+    RobotGateway *const q;
+
+    QUdpSocket m_socket;
+    QElapsedTimer m_clock;
+    QByteArray m_datagram;
+    QHash<quint8, RobotService *> m_robots;
+    std::vector<RobotService *> m_updatedRobots;
+    std::vector<Subscriber> m_subscribers;
+    int m_subscriptionTimeout = s_defaultSubscriptionTimeout;
+};
+
+RobotGateway::RobotGateway(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+RobotGateway::~RobotGateway()
+{
+    delete d;
+}
+
+bool RobotGateway::listen(const QHostAddress &address, quint16 port)
+{
+    return d->listen(address, port);
+}
+
+void RobotGateway::close()
+{
+    d->close();
+}
+
+bool RobotGateway::isListening() const
+{
+    return d->isListening();
+}
+
+quint16 RobotGateway::port() const
+{
+    return d->port();
+}
+
+QString RobotGateway::errorString() const
+{
+    return d->errorString();
+}
+
+void RobotGateway::addRobot(quint8 id, RobotService *service)
+{
+    d->addRobot(id, service);
+}
+
+void RobotGateway::removeRobot(quint8 id)
+{
+    d->removeRobot(id);
+}
+
+void RobotGateway::setSubscriptionTimeout(int timeout)
+{
+    d->setSubscriptionTimeout(timeout);
+}
+
+int RobotGateway::subscriptionTimeout() const
+{
+    return d->subscriptionTimeout();
+}
+
+} // namespace EvoBot
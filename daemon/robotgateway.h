@@ -0,0 +1,82 @@
+#ifndef EVOBOT_ROBOTGATEWAY_H
+#define EVOBOT_ROBOTGATEWAY_H
+
+#include <QHostAddress>
+#include <QObject>
+
+namespace EvoBot {
+
+class RobotService;
+
+// Exposes robot services to remote controllers over UDP. Each datagram holds one message:
+// the message type, the robot id, and the payload. Commands that arrive together are
+// applied as one update per robot, so that a burst of datagrams results in a single
+// frame change for the transmit scheduler instead of one write per datagram.
+//
+//   Subscribe      0x01 id                    receive the robot's messages, 0xff for all robots
+//   Unsubscribe    0x02 id
+//   Frame          0x10 id frame[6]           sets the current message; also sent on changes
+//   StartAction    0x11 id action index[2]    index in network byte order
+//   StopAction     0x12 id action index[2]
+//   State          0x20 id state              sent to subscribers
+//   Sound          0x21 id sound              the sound currently playing, as signed byte
+//   Error          0x7f id type error         reply to a rejected command
+//
+// Subscriptions expire unless the subscriber sends a message within the subscription timeout.
+class RobotGateway : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int subscriptionTimeout READ subscriptionTimeout WRITE setSubscriptionTimeout NOTIFY subscriptionTimeoutChanged FINAL)
+
+public:
+    enum MessageType : quint8 {
+        SubscribeMessage = 0x01,
+        UnsubscribeMessage = 0x02,
+        FrameMessage = 0x10,
+        StartActionMessage = 0x11,
+        StopActionMessage = 0x12,
+        StateMessage = 0x20,
+        SoundMessage = 0x21,
+        ErrorMessage = 0x7f,
+    };
+
+    Q_ENUM(MessageType)
+
+    enum Error : quint8 {
+        NoError,
+        UnknownRobotError,
+        MalformedMessageError,
+        RejectedError,
+    };
+
+    Q_ENUM(Error)
+
+    static constexpr quint8 AllRobots = 0xff;
+
+    explicit RobotGateway(QObject *parent = {});
+    ~RobotGateway() override;
+
+    bool listen(const QHostAddress &address, quint16 port);
+    void close();
+    bool isListening() const;
+    quint16 port() const;
+    QString errorString() const;
+
+    // The gateway doesn't take ownership of the services.
+    void addRobot(quint8 id, RobotService *service);
+    void removeRobot(quint8 id);
+
+    void setSubscriptionTimeout(int timeout);
+    int subscriptionTimeout() const;
+
+signals:
+    void subscriptionTimeoutChanged(int timeout);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ROBOTGATEWAY_H
@@ -0,0 +1,11 @@
+TARGET = evobot-demo
+
+QT += quick
+
+include(../evobot/evobot.pri)
+
+SOURCES += \
+    main.cpp
+
+RESOURCES += \
+    main.qrc
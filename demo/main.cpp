@@ -0,0 +1,54 @@
+#include "actionmodel.h"
+#include "controller.h"
+#include "controllerproxy.h"
+#include "robotservice.h"
+#include "robotserviceproxy.h"
+
+#include <QGuiApplication>
+#include <QQmlApplicationEngine>
+#include <QQmlContext>
+
+#include <memory>
+
+namespace EvoBot {
+
+class TestApplication : public QGuiApplication
+{
+    Q_OBJECT
+
+public:
+    using QGuiApplication::QGuiApplication;
+
+    int run()
+    {
+        qmlRegisterType<ActionModel>("EvoBotTest", 1, 0, "ActionModel");
+        qmlRegisterUncreatableType<Controller>("EvoBotTest", 1, 0, "Controller", {});
+        qmlRegisterUncreatableType<ControllerProxy>("EvoBotTest", 1, 0, "ControllerProxy", {});
+        qmlRegisterUncreatableType<RobotService>("EvoBotTest", 1, 0, "RobotService", {});
+        qmlRegisterUncreatableType<RobotServiceProxy>("EvoBotTest", 1, 0, "RobotServiceProxy", {});
+
+        // with --threaded the Bluetooth stack runs in a worker thread
+        if (arguments().contains(QStringLiteral("--threaded")))
+            m_controller = std::make_unique<ControllerProxy>();
+        else
+            m_controller = std::make_unique<Controller>();
+
+        QQmlApplicationEngine qml;
+        qml.rootContext()->setContextProperty("_evobot", m_controller.get());
+        qml.load("qrc:/main.qml");
+
+        return exec();
+    }
+
+private:
+    std::unique_ptr<QObject> m_controller;
+};
+
+} // namespace EvoBot
+
+int main(int argc, char *argv[])
+{
+    return EvoBot::TestApplication{argc, argv}.run();
+}
+
+#include "main.moc"
@@ -0,0 +1,115 @@
+import EvoBotTest 1.0
+
+import QtQuick 2.9
+import QtQuick.Controls 2.2
+import QtQuick.Layouts 1.3
+import QtQuick.Window 2.3
+
+ApplicationWindow {
+    width: 1024
+    height: 768
+    visible: true
+
+    font.pointSize: 16
+
+    ColumnLayout {
+        Label {
+            text: {
+                var text = "%1 (service state: %2)".arg(_evobot.stateName(_evobot.state)).arg(_evobot.robotService.state);
+                if (_evobot.state == Controller.ErrorState)
+                    text += " - " + _evobot.errorString;
+                return text;
+            }
+        }
+
+        Label {
+            text: "current sound: " + _evobot.robotService.currentSound
+        }
+    }
+
+    GridLayout {
+        anchors.centerIn: parent
+
+        enabled: _evobot.state === Controller.ConnectedState
+        opacity: enabled ? 1 : 0.5
+        Behavior on opacity { NumberAnimation {} }
+
+        Repeater {
+            model: ActionModel {
+                currentMessage: _evobot.robotService.currentMessage
+                firmwareRevision: _evobot.robotService.firmwareRevision
+            }
+
+            Button {
+                readonly property string action: model.action
+                readonly property int force: model.force
+
+                Layout.column: model.column
+                Layout.row: model.row
+                Layout.fillWidth: true
+
+                checkable: action === "V"
+                checked: checkable && Math.max(0, _evobot.robotService.currentSound) === force
+                enabled: !checkable || force === 0 || _evobot.robotService.currentSound <= 0
+                highlighted: model.active
+                font.pointSize: 20
+                text: model.label
+
+                onPressed: {
+                    if (action !== "V" && action !== "E")
+                        _evobot.robotService.startAction(action, force);
+                }
+
+                onReleased: {
+                    if (action !== "V" && action !== "E")
+                        _evobot.robotService.stopAction(action, force);
+                }
+
+                onClicked: {
+                    if (action === "V" || action === "E")
+                        _evobot.robotService.startAction(action, force);
+                }
+
+                onPressAndHold: {
+                    if (action === "V")
+                        _evobot.robotService.playLoop(force, true);
+                }
+            }
+        }
+
+        RowLayout {
+            Layout.column: 0
+            Layout.columnSpan: 10
+            Layout.row: 11
+
+            Repeater {
+                id: messageRepeater
+
+                model: ["header", "drive", "claw", "arm", "sound", "eyes"]
+
+                TextField {
+                    Layout.fillWidth: true
+
+                    //inputMask: "#dd9"
+                    inputMethodHints: Qt.ImhPreferNumbers
+                    text: _evobot.robotService[modelData]
+                    validator: IntValidator { bottom: -128; top: 127 }
+                    maximumLength: 3
+                }
+            }
+
+            Button {
+                text: "Send"
+
+                onClicked: {
+                    _evobot.robotService.beginUpdate();
+
+                    for (var i = 0; i < messageRepeater.count; ++i)
+                        _evobot.robotService[messageRepeater.model[i]] = parseInt(messageRepeater.itemAt(i).text);
+
+                    _evobot.robotService.commit();
+                }
+            }
+        }
+    }
+}
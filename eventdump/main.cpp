@@ -0,0 +1,140 @@
+#include "controller.h"
+#include "eventsink.h"
+#include "notificationdecoder.h"
+#include "robotservice.h"
+#include "utilities.h"
+
+#include <QBluetoothAddress>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <cstdio>
+
+namespace EvoBot {
+
+namespace {
+
+QByteArray frameText(quint64 value)
+{
+    QByteArray frame{RobotFrame::Size, Qt::Uninitialized};
+
+    for (auto i = 0; i < frame.size(); ++i, value >>= 8)
+        frame[i] = static_cast<char>(value & 0xff);
+
+    return frame.toHex();
+}
+
+QByteArray notificationText(int type, quint64 index)
+{
+    switch (static_cast<Notification::Type>(type)) {
+    case Notification::SoundStarted:
+        return "sound " + QByteArray::number(index) + " started";
+    case Notification::SoundEnded:
+        return "sound " + QByteArray::number(index) + " ended";
+    case Notification::UnknownNotification:
+        break;
+    }
+
+    return QByteArrayLiteral("unknown");
+}
+
+// Formats what the sink recorded in binary, see the event descriptions in eventsink.h.
+QByteArray details(const EventRecord &record)
+{
+    switch (static_cast<EventSink::Event>(record.event)) {
+    case EventSink::TransportStateChanged:
+        return key(static_cast<RobotService::State>(record.argument));
+    case EventSink::ControllerStateChanged:
+        return key(static_cast<Controller::State>(record.argument));
+    case EventSink::FirmwareRevisionChanged:
+        return "revision " + QByteArray::number(record.argument);
+    case EventSink::FrameIssued:
+        return frameText(record.value) + (record.argument ? " with response" : " without response");
+    case EventSink::FrameAcknowledged:
+        return frameText(record.value);
+    case EventSink::NotificationReceived:
+        return notificationText(record.argument, record.value);
+    case EventSink::DeviceDiscovered:
+        return QBluetoothAddress{record.value}.toString().toLatin1() + " rssi " + QByteArray::number(record.argument);
+    case EventSink::FrameLost:
+    case EventSink::InvalidEvent:
+        break;
+    }
+
+    return {};
+}
+
+} // namespace
+
+// Prints event logs written by the EventSink as text, one event per line.
+class EventDumpApplication : public QCoreApplication
+{
+    Q_OBJECT
+
+public:
+    using QCoreApplication::QCoreApplication;
+
+    int run()
+    {
+        setApplicationName("evobot-eventdump");
+
+        const QCommandLineOption robotOption{"robot", tr("Only print the events of robot <id>."), tr("id")};
+
+        QCommandLineParser options;
+        options.setApplicationDescription(tr("Prints the diagnostic event logs of EvoBot applications."));
+        options.addHelpOption();
+        options.addOption(robotOption);
+        options.addPositionalArgument("file", tr("The event log to print."));
+        options.process(*this);
+
+        if (options.positionalArguments().size() != 1)
+            options.showHelp(EXIT_FAILURE);
+
+        auto robot = -1;
+
+        if (options.isSet(robotOption)) {
+            auto valid = false;
+            robot = options.value(robotOption).toInt(&valid);
+
+            if (!valid || robot < 0) {
+                qWarning("Invalid robot id `%ls'", qUtf16Printable(options.value(robotOption)));
+                return EXIT_FAILURE;
+            }
+        }
+
+        QList<EventRecord> records;
+        qint64 startTime = 0;
+        QString errorString;
+
+        if (!EventSink::read(options.positionalArguments().first(), &records, &startTime, &errorString)) {
+            qWarning("%ls", qUtf16Printable(errorString));
+            return EXIT_FAILURE;
+        }
+
+        std::printf("# started %s\n", qPrintable(QDateTime::fromMSecsSinceEpoch(startTime).toString(Qt::ISODateWithMs)));
+
+        for (const auto &record: records) {
+            if (robot >= 0 && record.robot != robot)
+                continue;
+
+            const auto robotText = (record.robot == EventSink::NoRobot ? QByteArrayLiteral("-")
+                                                                       : QByteArray::number(record.robot));
+            const auto event = key(static_cast<EventSink::Event>(record.event));
+
+            std::printf("%14.9f %3s %-24s %s\n", static_cast<double>(record.timestamp) / 1e9, robotText.constData(),
+                        event ? event : "UnknownEvent", details(record).constData());
+        }
+
+        return EXIT_SUCCESS;
+    }
+};
+
+} // namespace EvoBot
+
+int main(int argc, char *argv[])
+{
+    return EvoBot::EventDumpApplication{argc, argv}.run();
+}
+
+#include "main.moc"
@@ -0,0 +1,37 @@
+#include "actionencoding.h"
+
+namespace EvoBot {
+
+namespace {
+
+constexpr ActionEncoding s_firmware1Encoding{1};
+constexpr ActionEncoding s_firmware2Encoding{2};
+
+constexpr bool differs(char action, int index) noexcept
+{
+    return s_firmware1Encoding.encode(action, index).offset != s_firmware2Encoding.encode(action, index).offset
+            || s_firmware1Encoding.encode(action, index).value != s_firmware2Encoding.encode(action, index).value;
+}
+
+static_assert(s_firmware1Encoding.encode('F', 2).value == 3, "Unexpected drive encoding");
+static_assert(s_firmware1Encoding.encode('E', 5).value == 0x3a, "Unexpected eyes encoding");
+static_assert(s_firmware2Encoding.encode('E', 5).value == 0x4c, "Unexpected eyes encoding");
+static_assert(s_firmware2Encoding.encode('E', 0).value == 0x3b, "Unexpected eyes encoding");
+static_assert(s_firmware2Encoding.encode('M', 4).value == 25, "Unexpected sound encoding");
+static_assert(!s_firmware2Encoding.encode('X', 0), "Unexpected action");
+static_assert(differs('E', 5) && !differs('E', 0), "Unexpected firmware dependency");
+static_assert(!differs('F', 2) && !differs('V', 7) && !differs('O', 0), "Unexpected firmware dependency");
+
+} // namespace
+
+const ActionEncoding &ActionEncoding::forFirmware(int firmwareRevision) noexcept
+{
+    return firmwareRevision == 1 ? s_firmware1Encoding : s_firmware2Encoding;
+}
+
+bool ActionEncoding::dependsOnFirmware(char action, int index) noexcept
+{
+    return differs(action, index);
+}
+
+} // namespace EvoBot
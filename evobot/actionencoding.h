@@ -0,0 +1,108 @@
+#ifndef EVOBOT_ACTIONENCODING_H
+#define EVOBOT_ACTIONENCODING_H
+
+#include "robotframe.h"
+
+namespace EvoBot {
+
+// Maps an action like 'F' and its index to the frame byte that triggers it. There is one
+// table per firmware revision, generated at compile time, so encoding is a single lookup.
+class ActionEncoding
+{
+public:
+    struct Fragment
+    {
+        constexpr explicit operator bool() const noexcept { return RobotFrame::isValidOffset(offset); }
+
+        int offset = -1;
+        char value = 0;
+    };
+
+    constexpr explicit ActionEncoding(int firmwareRevision) noexcept;
+
+    // Unknown revisions use the encoding of the current firmware.
+    static const ActionEncoding &forFirmware(int firmwareRevision) noexcept;
+
+    // Tells whether the action is encoded differently by the known firmware revisions.
+    static bool dependsOnFirmware(char action, int index) noexcept;
+
+    // Indices are clamped to the range supported by the action.
+    constexpr Fragment encode(char action, int index) const noexcept
+    {
+        const auto &entry = m_actions[static_cast<unsigned char>(action)];
+        const auto clamped = index < 0 ? 0 : index > entry.lastIndex ? entry.lastIndex : index;
+
+        return {entry.offset, m_values[entry.firstValue + clamped]};
+    }
+
+private:
+    struct Entry
+    {
+        signed char offset = -1;
+        unsigned char firstValue = 0;
+        unsigned char lastIndex = 0;
+    };
+
+    static constexpr int DriveValueCount = 4;
+    static constexpr int SoundValueCount = 128 - 21;
+    static constexpr int EyesValueCount = 64;
+    static constexpr int ValueCount = 4 * DriveValueCount + 4 + SoundValueCount + EyesValueCount;
+
+    constexpr int addAction(char action, RobotFrame::Field field, int firstValue, int count) noexcept
+    {
+        auto &entry = m_actions[static_cast<unsigned char>(action)];
+
+        entry.offset = static_cast<signed char>(field);
+        entry.firstValue = static_cast<unsigned char>(firstValue);
+        entry.lastIndex = static_cast<unsigned char>(count - 1);
+
+        return firstValue + count;
+    }
+
+    Entry m_actions[256];
+    char m_values[ValueCount] = {};
+};
+
+constexpr ActionEncoding::ActionEncoding(int firmwareRevision) noexcept
+{
+    auto next = 0;
+
+    const char drives[] = {'F', 'B', 'L', 'R'};
+
+    for (auto i = 0; i < 4; ++i) {
+        for (auto index = 0; index < DriveValueCount; ++index)
+            m_values[next + index] = static_cast<char>(1 + i * DriveValueCount + index);
+
+        next = addAction(drives[i], RobotFrame::DriveField, next, DriveValueCount);
+    }
+
+    m_values[next] = 0x3c;
+    next = addAction('O', RobotFrame::ClawField, next, 1);
+    m_values[next] = 0x3d;
+    next = addAction('C', RobotFrame::ClawField, next, 1);
+    m_values[next] = 0x3e;
+    next = addAction('U', RobotFrame::ArmField, next, 1);
+    m_values[next] = 0x3f;
+    next = addAction('D', RobotFrame::ArmField, next, 1);
+
+    // sounds and audio loops share their values
+    for (auto index = 0; index < SoundValueCount; ++index)
+        m_values[next + index] = static_cast<char>(21 + index);
+
+    addAction('M', RobotFrame::SoundField, next, SoundValueCount);
+    next = addAction('V', RobotFrame::SoundField, next, SoundValueCount);
+
+    // index zero resets the eyes, the colors moved with the second firmware revision
+    const auto eyesBase = (firmwareRevision == 1 ? 0x35 : 0x47);
+
+    m_values[next] = 0x3b;
+
+    for (auto index = 1; index < EyesValueCount; ++index)
+        m_values[next + index] = static_cast<char>(eyesBase + index);
+
+    addAction('E', RobotFrame::EyesField, next, EyesValueCount);
+}
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ACTIONENCODING_H
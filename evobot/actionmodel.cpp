@@ -0,0 +1,226 @@
+#include "actionmodel.h"
+
+#include "actionencoding.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+
+struct Layout
+{
+    int row;
+    int column;
+};
+
+Layout layoutFor(char action, int force)
+{
+    switch (action) {
+    case 'L': return {5, 3 - force};
+    case 'R': return {5, 5 + force};
+    case 'F': return {4 - force, 4};
+    case 'B': return {6 + force, 4};
+    case 'S': return {5, 4};
+    case 'O': return {2, 2};
+    case 'C': return {2, 0};
+    case 'U': return {1, 1};
+    case 'D': return {3, 1};
+    case 'E': return {force / 2 + 7, force % 2 + 1};
+    case 'V': return {force / 4 + (force >= 16 ? 3 : 0), force % 4 + 6};
+    }
+
+    return {0, 0};
+}
+
+} // namespace
+
+class ActionModel::Private
+{
+    struct Item
+    {
+        char action;
+        int force;
+        Layout layout;
+        QString label;
+        bool active = false;
+    };
+
+public:
+    explicit Private(ActionModel *q)
+        : q{q}
+    {
+        // four drive actions per direction, followed by the arm, claw, pause, eyes and sounds
+        static const char s_actions[] = "LLLLRRRRFFFFBBBBUDOCSEEEEEEVVVVVVVVVVVVVVVVVVVVVVVVVVVVVVVV";
+
+        m_items.reserve(sizeof s_actions - 1);
+
+        for (auto i = 0; s_actions[i]; ++i) {
+            const auto action = s_actions[i];
+            auto force = -1;
+
+            if (i < 16)
+                force = i % 4;
+            else if (action == 'V' || action == 'E')
+                force = i - static_cast<int>(std::strchr(s_actions, action) - s_actions);
+
+            QString label{QLatin1Char{action}};
+
+            if (force >= 0)
+                label += QString::number(force);
+
+            Item item{action, force, layoutFor(action, force), label};
+            item.active = isActive(item);
+            m_items.push_back(std::move(item));
+        }
+    }
+
+    void setCurrentMessage(const RobotFrame &currentMessage)
+    {
+        if (std::exchange(m_currentMessage, currentMessage) != currentMessage) {
+            updateActive();
+            emit q->currentMessageChanged(m_currentMessage);
+        }
+    }
+
+    RobotFrame currentMessage() const { return m_currentMessage; }
+
+    void setFirmwareRevision(int firmwareRevision)
+    {
+        if (std::exchange(m_firmwareRevision, firmwareRevision) != firmwareRevision) {
+            m_encoding = &ActionEncoding::forFirmware(m_firmwareRevision);
+            updateActive();
+            emit q->firmwareRevisionChanged(m_firmwareRevision);
+        }
+    }
+
+    int firmwareRevision() const { return m_firmwareRevision; }
+
+    int count() const { return static_cast<int>(m_items.size()); }
+
+    QVariant data(int row, int role) const
+    {
+        if (row < 0 || row >= count())
+            return {};
+
+        const auto &item = m_items[static_cast<size_t>(row)];
+
+        switch (static_cast<Role>(role)) {
+        case ActionRole:
+            return QString{QLatin1Char{item.action}};
+        case ForceRole:
+            return item.force;
+        case RowRole:
+            return item.layout.row;
+        case ColumnRole:
+            return item.layout.column;
+        case LabelRole:
+            return item.label;
+        case ActiveRole:
+            return item.active;
+        }
+
+        if (role == Qt::DisplayRole)
+            return item.label;
+
+        return {};
+    }
+
+private:
+    bool isActive(const Item &item) const
+    {
+        if (item.action == 'S')
+            return m_currentMessage == RobotFrame::pause();
+
+        const auto fragment = m_encoding->encode(item.action, qMax(0, item.force));
+        return fragment && m_currentMessage.at(fragment.offset) == fragment.value;
+    }
+
+    // only rows whose state actually changed get notified
+    void updateActive()
+    {
+        for (auto row = 0; row < count(); ++row) {
+            auto &item = m_items[static_cast<size_t>(row)];
+            const auto active = isActive(item);
+
+            if (std::exchange(item.active, active) != active) {
+                const auto modelIndex = q->index(row);
+                emit q->dataChanged(modelIndex, modelIndex, {ActiveRole});
+            }
+        }
+    }
+
+    ActionModel *const q;
+
+    std::vector<Item> m_items;
+    RobotFrame m_currentMessage = RobotFrame::pause();
+    int m_firmwareRevision = -1;
+    const ActionEncoding *m_encoding = &ActionEncoding::forFirmware(-1);
+};
+
+ActionModel::ActionModel(QObject *parent)
+    : QAbstractListModel{parent}
+    , d{new Private{this}}
+{}
+
+ActionModel::~ActionModel()
+{
+    delete d;
+}
+
+void ActionModel::setCurrentMessage(const RobotFrame &currentMessage)
+{
+    d->setCurrentMessage(currentMessage);
+}
+
+RobotFrame ActionModel::currentMessage() const
+{
+    return d->currentMessage();
+}
+
+void ActionModel::setFirmwareRevision(int firmwareRevision)
+{
+    d->setFirmwareRevision(firmwareRevision);
+}
+
+int ActionModel::firmwareRevision() const
+{
+    return d->firmwareRevision();
+}
+
+int ActionModel::count() const
+{
+    return d->count();
+}
+
+int ActionModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d->count();
+}
+
+QVariant ActionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.parent().isValid())
+        return {};
+
+    return d->data(index.row(), role);
+}
+
+QHash<int, QByteArray> ActionModel::roleNames() const
+{
+    return {
+        {ActionRole, "action"},
+        {ForceRole, "force"},
+        {RowRole, "row"},
+        {ColumnRole, "column"},
+        {LabelRole, "label"},
+        {ActiveRole, "active"},
+    };
+}
+
+} // namespace EvoBot
@@ -0,0 +1,57 @@
+#ifndef EVOBOT_ACTIONMODEL_H
+#define EVOBOT_ACTIONMODEL_H
+
+#include "robotframe.h"
+
+#include <QAbstractListModel>
+
+namespace EvoBot {
+
+// The actions offered by the control surface, with their position in its grid. The active
+// role follows the current message, which usually is bound to a robot service's message.
+class ActionModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(EvoBot::RobotFrame currentMessage READ currentMessage WRITE setCurrentMessage NOTIFY currentMessageChanged FINAL)
+    Q_PROPERTY(int firmwareRevision READ firmwareRevision WRITE setFirmwareRevision NOTIFY firmwareRevisionChanged FINAL)
+    Q_PROPERTY(int count READ count CONSTANT FINAL)
+
+public:
+    enum Role {
+        ActionRole = Qt::UserRole + 1,
+        ForceRole,
+        RowRole,
+        ColumnRole,
+        LabelRole,
+        ActiveRole,
+    };
+
+    Q_ENUM(Role)
+
+    explicit ActionModel(QObject *parent = {});
+    ~ActionModel() override;
+
+    void setCurrentMessage(const RobotFrame &currentMessage);
+    RobotFrame currentMessage() const;
+
+    void setFirmwareRevision(int firmwareRevision);
+    int firmwareRevision() const;
+
+    int count() const;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+    void currentMessageChanged(const EvoBot::RobotFrame &currentMessage);
+    void firmwareRevisionChanged(int firmwareRevision);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ACTIONMODEL_H
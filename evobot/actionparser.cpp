@@ -0,0 +1,69 @@
+#include "actionparser.h"
+
+#include <QCoreApplication>
+
+namespace EvoBot {
+
+namespace {
+
+const auto s_maximumIndex = 0xffff;
+
+bool isSeparator(QChar ch)
+{
+    return ch.isSpace() || ch == ',' || ch == ';';
+}
+
+} // namespace
+
+bool parseActions(const QString &text, ActionCommandList *commands, QString *errorString)
+{
+    ActionCommandList parsedCommands;
+
+    for (auto it = text.begin(), end = text.end(); it != end; ) {
+        if (isSeparator(*it)) {
+            ++it;
+            continue;
+        }
+
+        ActionCommand command;
+
+        if (*it == '-') {
+            command.stop = true;
+            ++it;
+        }
+
+        if (it == end || it->unicode() > 127 || !it->isLetter()) {
+            if (errorString) {
+                *errorString = QCoreApplication::translate("EvoBot::ActionParser", "Action code expected at position %1 of `%2'").
+                        arg(static_cast<int>(it - text.begin())).arg(text);
+            }
+
+            return false;
+        }
+
+        command.action = it->toLatin1();
+
+        for (++it; it != end && it->isDigit(); ++it) {
+            if (command.index <= s_maximumIndex)
+                command.index = 10 * command.index + it->digitValue();
+        }
+
+        if (it != end && !isSeparator(*it)) {
+            if (errorString) {
+                *errorString = QCoreApplication::translate("EvoBot::ActionParser", "Unexpected character at position %1 of `%2'").
+                        arg(static_cast<int>(it - text.begin())).arg(text);
+            }
+
+            return false;
+        }
+
+        parsedCommands.push_back(command);
+    }
+
+    if (commands)
+        *commands = std::move(parsedCommands);
+
+    return true;
+}
+
+} // namespace EvoBot
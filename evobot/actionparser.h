@@ -0,0 +1,26 @@
+#ifndef EVOBOT_ACTIONPARSER_H
+#define EVOBOT_ACTIONPARSER_H
+
+#include <QString>
+
+#include <vector>
+
+namespace EvoBot {
+
+struct ActionCommand
+{
+    char action = 0;
+    int index = 0;
+    bool stop = false;
+};
+
+using ActionCommandList = std::vector<ActionCommand>;
+
+// Parses action lists like "F2 O V5". Actions are separated by whitespace or commas,
+// and are stopped instead of started when prefixed with a minus sign, like in "-F2".
+// Only the syntax gets checked, unknown action codes are reported by the encoder.
+bool parseActions(const QString &text, ActionCommandList *commands, QString *errorString = nullptr);
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ACTIONPARSER_H
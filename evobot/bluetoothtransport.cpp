@@ -0,0 +1,332 @@
+#include "bluetoothtransport.h"
+
+#include "utilities.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QLowEnergyCharacteristic>
+#include <QLowEnergyController>
+
+#include <memory>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcBluetoothTransport, "evobot.bluetoothtransport", QtInfoMsg)
+
+const QBluetoothUuid s_serviceUuid{quint16{0xfff3}};
+const QBluetoothUuid s_notifyUuid{quint16{0xfff4}};
+const QBluetoothUuid s_writeUuid{quint16{0xfff5}};
+
+} // namespace
+
+class BluetoothTransport::Private
+{
+public:
+    explicit Private(BluetoothTransport *q)
+        : q{q}
+    {}
+
+    bool attach(QLowEnergyController *central);
+
+    RobotService::State state() const;
+    int firmwareRevision() const { return m_firmwareRevision; }
+    bool canWriteWithoutResponse() const;
+    RobotService::Layout layout() const;
+
+    void writeFrame(const RobotFrame &frame, WriteMode mode);
+
+private:
+    std::unique_ptr<QLowEnergyService> createService(QLowEnergyController *central, const QBluetoothUuid &serviceUuid);
+    void checkState();
+    void reset();
+
+    bool readFirmwareVersion();
+    void startPipeline();
+    bool startNotification();
+    bool startTransmission();
+
+    void onServiceStateChanged(QLowEnergyService *service, QLowEnergyService::ServiceState newState);
+    void onCharacteristicChanged(const QLowEnergyCharacteristic &info, const QByteArray &value);
+    void onCharacteristicWritten(const QLowEnergyCharacteristic &info, const QByteArray &value);
+
+    BluetoothTransport *const q;
+
+    RobotService::State m_oldState = RobotService::DisconnectedState;
+    QLowEnergyService *m_deviceInformation = {};
+    QLowEnergyService *m_robotControl = {};
+
+    QLowEnergyCharacteristic m_writeCharacteristic;
+    int m_firmwareRevision = -1;
+    QElapsedTimer m_attachTimer;
+};
+
+BluetoothTransport::BluetoothTransport(QObject *parent)
+    : RobotTransport{parent}
+    , d{new Private{this}}
+{}
+
+BluetoothTransport::~BluetoothTransport()
+{
+    delete d;
+}
+
+bool BluetoothTransport::attach(QLowEnergyController *central)
+{
+    return d->attach(central);
+}
+
+RobotService::State BluetoothTransport::state() const
+{
+    return d->state();
+}
+
+int BluetoothTransport::firmwareRevision() const
+{
+    return d->firmwareRevision();
+}
+
+bool BluetoothTransport::canWriteWithoutResponse() const
+{
+    return d->canWriteWithoutResponse();
+}
+
+RobotService::Layout BluetoothTransport::layout() const
+{
+    return d->layout();
+}
+
+void BluetoothTransport::writeFrame(const RobotFrame &frame, WriteMode mode)
+{
+    d->writeFrame(frame, mode);
+}
+
+bool BluetoothTransport::Private::attach(QLowEnergyController *central)
+{
+    if (state() != RobotService::DisconnectedState) {
+        qCWarning(lcBluetoothTransport, "Attached already");
+        return false;
+    }
+
+    // The attach pipeline: both detail discoveries are requested right away, the robot
+    // control service first, since backends serializing GATT requests process them in
+    // order. Once it is discovered the CCCD write is queued and transmission starts
+    // without waiting for its confirmation, or for the firmware revision.
+    auto robotControl = createService(central, s_serviceUuid);
+    auto deviceInformation = createService(central, QBluetoothUuid::DeviceInformation);
+
+    if (deviceInformation && robotControl) {
+        connect(central, &QLowEnergyController::disconnected, q, [this] { reset(); });
+        connect(central, &QObject::destroyed, q, [this] { reset(); });
+
+        m_deviceInformation = deviceInformation.release();
+        m_robotControl = robotControl.release();
+        m_attachTimer.start();
+        checkState();
+
+        // the services might have been discovered already
+        onServiceStateChanged(m_robotControl, m_robotControl->state());
+        onServiceStateChanged(m_deviceInformation, m_deviceInformation->state());
+
+        return true;
+    }
+
+    qCWarning(lcBluetoothTransport, "Could not resolve required services");
+    return false;
+}
+
+RobotService::State BluetoothTransport::Private::state() const
+{
+    if (m_writeCharacteristic.isValid())
+        return RobotService::ConnectedState;
+    if (m_robotControl && m_deviceInformation)
+        return RobotService::ConnectingState;
+
+    return RobotService::DisconnectedState;
+}
+
+bool BluetoothTransport::Private::canWriteWithoutResponse() const
+{
+    return m_writeCharacteristic.properties().testFlag(QLowEnergyCharacteristic::WriteNoResponse);
+}
+
+RobotService::Layout BluetoothTransport::Private::layout() const
+{
+    RobotService::Layout layout;
+
+    if (m_robotControl) {
+        const auto notifyCharacteristic = m_robotControl->characteristic(s_notifyUuid);
+        const auto notifyDescriptor = notifyCharacteristic.descriptor(QBluetoothUuid::ClientCharacteristicConfiguration);
+
+        layout.notifyHandle = notifyCharacteristic.handle();
+        layout.notifyConfigHandle = notifyDescriptor.handle();
+        layout.writeHandle = m_writeCharacteristic.handle();
+    }
+
+    return layout;
+}
+
+void BluetoothTransport::Private::writeFrame(const RobotFrame &frame, WriteMode mode)
+{
+    if (!m_robotControl || !m_writeCharacteristic.isValid())
+        return;
+
+    if (mode == WriteWithoutResponse) {
+        m_robotControl->writeCharacteristic(m_writeCharacteristic, frame.toByteArray(),
+                                            QLowEnergyService::WriteWithoutResponse);
+    } else {
+        m_robotControl->writeCharacteristic(m_writeCharacteristic, frame.toByteArray());
+    }
+}
+
+std::unique_ptr<QLowEnergyService> BluetoothTransport::Private::createService(QLowEnergyController *central,
+                                                                              const QBluetoothUuid &serviceUuid)
+{
+    std::unique_ptr<QLowEnergyService> service{central->createServiceObject(serviceUuid, q)};
+
+    if (service) {
+        connect(service.get(), &QLowEnergyService::stateChanged, q, [this, service = service.get()](auto newState) {
+            this->onServiceStateChanged(service, newState);
+        });
+    }
+
+    return service;
+}
+
+void BluetoothTransport::Private::checkState()
+{
+    const auto newState = state();
+
+    if (newState != m_oldState) {
+        qCInfo(lcBluetoothTransport, "state changed: %s => %s", key(m_oldState), key(newState));
+        emit q->stateChanged(newState, m_oldState);
+        m_oldState = newState;
+    }
+}
+
+void BluetoothTransport::Private::reset()
+{
+    if (!m_deviceInformation && !m_robotControl)
+        return;
+
+    qCInfo(lcBluetoothTransport, "Device has disconnected");
+
+    m_writeCharacteristic = {};
+
+    if (auto service = std::exchange(m_deviceInformation, {}))
+        service->deleteLater();
+    if (auto service = std::exchange(m_robotControl, {}))
+        service->deleteLater();
+
+    checkState();
+}
+
+bool BluetoothTransport::Private::readFirmwareVersion()
+{
+    if (m_deviceInformation) {
+        const auto revisionCharacteristic = m_deviceInformation->characteristic(QBluetoothUuid::FirmwareRevisionString);
+
+        if (revisionCharacteristic.isValid()) {
+            const auto value = revisionCharacteristic.value();
+            const auto revision = (value == "Ver2.0" ? 2 : value == "Ver1.0" ? 1 : -1);
+
+            if (revision > 0) {
+                qCInfo(lcBluetoothTransport, "Firmware revision %d identified after %lld ms",
+                       revision, m_attachTimer.elapsed());
+
+                if (std::exchange(m_firmwareRevision, revision) != revision)
+                    emit q->firmwareRevisionChanged(m_firmwareRevision);
+
+                return true;
+            }
+        }
+    }
+
+    qCWarning(lcBluetoothTransport, "Could not identify firmware revision");
+    return false;
+}
+
+// Notifications only report sounds, so driving must not depend on them.
+void BluetoothTransport::Private::startPipeline()
+{
+    startNotification();
+    startTransmission();
+}
+
+bool BluetoothTransport::Private::startNotification()
+{
+    if (m_robotControl) {
+        const auto characteristic = m_robotControl->characteristic(s_notifyUuid);
+        auto descriptor = characteristic.descriptor(QBluetoothUuid::ClientCharacteristicConfiguration);
+
+        if (characteristic.isValid() && descriptor.isValid()) {
+            m_robotControl->writeDescriptor(descriptor, QByteArray::fromHex("0100"));
+            return true;
+        }
+    }
+
+    qCWarning(lcBluetoothTransport, "Could not setup notification characteristic");
+    return false;
+}
+
+bool BluetoothTransport::Private::startTransmission()
+{
+    if (m_robotControl) {
+        m_writeCharacteristic = m_robotControl->characteristic(s_writeUuid);
+
+        if (m_writeCharacteristic.isValid()) {
+            connect(m_robotControl, &QLowEnergyService::characteristicChanged,
+                    q, [this](const auto &info, const auto &value) {
+                this->onCharacteristicChanged(info, value);
+            });
+
+            connect(m_robotControl, &QLowEnergyService::characteristicWritten,
+                    q, [this](const auto &info, const auto &value) {
+                this->onCharacteristicWritten(info, value);
+            });
+
+            qCInfo(lcBluetoothTransport, "Ready to transmit after %lld ms", m_attachTimer.elapsed());
+
+            checkState();
+            return true;
+        }
+    }
+
+    qCWarning(lcBluetoothTransport, "Could not setup write characteristic");
+    return false;
+}
+
+void BluetoothTransport::Private::onServiceStateChanged(QLowEnergyService *service, QLowEnergyService::ServiceState newState)
+{
+    qCInfo(lcBluetoothTransport, "State of service %ls has changed: %s",
+           qUtf16Printable(service->serviceUuid().toString()), key(newState));
+
+    if (newState == QLowEnergyService::DiscoveryRequired) {
+        service->discoverDetails();
+    } else if (newState == QLowEnergyService::ServiceDiscovered) {
+        if (service == m_deviceInformation)
+            readFirmwareVersion();
+        else if (service == m_robotControl && !m_writeCharacteristic.isValid())
+            startPipeline();
+    }
+}
+
+void BluetoothTransport::Private::onCharacteristicChanged(const QLowEnergyCharacteristic &info, const QByteArray &value)
+{
+    qCDebug(lcBluetoothTransport, "Value of characteristic %ls has changed: %s",
+            qUtf16Printable(info.uuid().toString()), value.toHex().constData());
+
+    if (info.uuid() == s_notifyUuid)
+        emit q->notificationReceived(value);
+}
+
+void BluetoothTransport::Private::onCharacteristicWritten(const QLowEnergyCharacteristic &info, const QByteArray &value)
+{
+    qCDebug(lcBluetoothTransport, "Value of characteristic %ls has been written: %s",
+            qUtf16Printable(info.uuid().toString()), value.toHex().constData());
+
+    if (info == m_writeCharacteristic)
+        emit q->frameWritten(RobotFrame::fromByteArray(value));
+}
+
+} // namespace EvoBot
@@ -0,0 +1,34 @@
+#ifndef EVOBOT_BLUETOOTHTRANSPORT_H
+#define EVOBOT_BLUETOOTHTRANSPORT_H
+
+#include "robottransport.h"
+
+class QLowEnergyController;
+
+namespace EvoBot {
+
+class BluetoothTransport : public RobotTransport
+{
+    Q_OBJECT
+
+public:
+    explicit BluetoothTransport(QObject *parent = {});
+    ~BluetoothTransport() override;
+
+    bool attach(QLowEnergyController *central);
+
+    RobotService::State state() const override;
+    int firmwareRevision() const override;
+    bool canWriteWithoutResponse() const override;
+    RobotService::Layout layout() const override;
+
+    void writeFrame(const RobotFrame &frame, WriteMode mode) override;
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_BLUETOOTHTRANSPORT_H
@@ -0,0 +1,835 @@
+#include "controller.h"
+
+#include "devicecache.h"
+#include "deviceregistry.h"
+#include "eventsink.h"
+#include "robotservice.h"
+#include "transmitscheduler.h"
+#include "utilities.h"
+
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QBluetoothLocalDevice>
+#include <QLoggingCategory>
+#include <QLowEnergyConnectionParameters>
+#include <QLowEnergyController>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcController, "evobot.controller")
+
+const auto s_connectTimeout = 5s;
+const auto s_minimumReconnectDelay = 250ms;
+const auto s_maximumReconnectDelay = 8s;
+const auto s_maximumReconnectAttempts = 8;
+const auto s_signalSelectionWindow = 1500ms;
+
+const QBluetoothUuid s_serviceUuid{quint16{0xfff3}};
+const auto s_robotName = QStringLiteral("Evolution-Robot");
+
+constexpr auto s_pauseFrame = RobotFrame::pause();
+
+// Intervals in milliseconds, latency in skipped connection events, supervision timeout in milliseconds.
+QLowEnergyConnectionParameters connectionParameters(Controller::ConnectionProfile profile)
+{
+    QLowEnergyConnectionParameters parameters;
+
+    switch (profile) {
+    case Controller::LowLatencyProfile:
+        parameters.setIntervalRange(7.5, 15);
+        parameters.setLatency(0);
+        parameters.setSupervisionTimeout(2000);
+        break;
+
+    case Controller::BalancedProfile:
+        parameters.setIntervalRange(30, 50);
+        parameters.setLatency(0);
+        parameters.setSupervisionTimeout(4000);
+        break;
+
+    case Controller::PowerSavingProfile:
+        parameters.setIntervalRange(100, 200);
+        parameters.setLatency(4);
+        parameters.setSupervisionTimeout(6000);
+        break;
+
+    case Controller::DefaultProfile:
+        break;
+    }
+
+    return parameters;
+}
+
+QBluetoothDeviceInfo lowEnergyDevice(const QBluetoothAddress &address, const QString &name)
+{
+    QBluetoothDeviceInfo device{address, name, 0};
+    device.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    return device;
+}
+
+} // namespace
+
+class Controller::Private
+{
+    class StateGuard
+    {
+    public:
+        StateGuard(Private *d) : d{d} {}
+        ~StateGuard() { d->checkState(); }
+
+    private:
+        Private *const d;
+    };
+
+public:
+    explicit Private(Controller *q)
+        : q{q}
+    {
+        if (!m_localDevice.isValid()) {
+            raiseError(BluetoothMissingError, tr("No Bluetooth controller available"));
+            return;
+        }
+
+        connect(&m_localDevice, &QBluetoothLocalDevice::hostModeStateChanged,
+                q, [this](auto state) { this->onHostStateChanged(state); });
+
+        connect(&m_deviceDiscovery, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered,
+                q, [this](const auto &device) { m_deviceRegistry.addDevice(device); });
+        connect(&m_deviceDiscovery, &QBluetoothDeviceDiscoveryAgent::deviceUpdated,
+                q, [this](const auto &device) { m_deviceRegistry.addDevice(device); });
+        connect(&m_deviceRegistry, &DeviceRegistry::deviceDiscovered,
+                q, [this](const auto &device) { this->onDeviceDiscovered(device); });
+        connect(&m_deviceDiscovery, QOverload<QBluetoothDeviceDiscoveryAgent::Error>::of(&QBluetoothDeviceDiscoveryAgent::error),
+                q, [this](auto error) { this->onDeviceDiscoveryError(error); });
+        connect(&m_deviceDiscovery,  &QBluetoothDeviceDiscoveryAgent::finished,
+                q, [this] { onDeviceDiscoveryFinished(); });
+
+        connect(&m_robotService, &RobotService::stateChanged, q, [this] { onRobotServiceStateChanged(); });
+        connect(&m_robotService, &RobotService::firmwareRevisionChanged, q, [this] { updateDeviceCache(); });
+
+        m_connectTimer.setSingleShot(true);
+        connect(&m_connectTimer, &QTimer::timeout, q, [this] { onConnectTimeout(); });
+
+        m_reconnectTimer.setSingleShot(true);
+        connect(&m_reconnectTimer, &QTimer::timeout, q, [this] { reconnect(); });
+
+        m_selectionTimer.setSingleShot(true);
+        connect(&m_selectionTimer, &QTimer::timeout, q, [this] { connectToStrongestDevice(); });
+
+        // defer startup, so that options can be configured after construction
+        QTimer::singleShot(0, q, [this] { onHostStateChanged(m_localDevice.hostMode()); });
+    }
+
+    Error error() const { return m_error; }
+    QString errorString() const { return m_errorString; }
+
+    State state() const
+    {
+        if (m_error != NoError)
+            return ErrorState;
+
+        if (m_robotService.state() == RobotService::ConnectedState)
+            return ConnectedState;
+        if (isReconnecting())
+            return ReconnectingState;
+        if (m_central)
+            return ServiceDiscoveryState;
+        if (m_deviceDiscovery.isActive())
+            return DeviceDiscoveryState;
+
+        return UninitializedState;
+    }
+
+    RobotService *robotService()
+    {
+        return &m_robotService;
+    }
+
+    DeviceRegistry *deviceRegistry()
+    {
+        return &m_deviceRegistry;
+    }
+
+    void setDeviceCacheEnabled(bool enabled)
+    {
+        if (std::exchange(m_deviceCacheEnabled, enabled) != enabled)
+            emit q->deviceCacheEnabledChanged(m_deviceCacheEnabled);
+    }
+
+    bool isDeviceCacheEnabled() const { return m_deviceCacheEnabled; }
+
+    void setLowEnergyDiscoveryTimeout(int timeout)
+    {
+        timeout = qMax(0, timeout);
+
+        if (m_deviceDiscovery.lowEnergyDiscoveryTimeout() != timeout) {
+            m_deviceDiscovery.setLowEnergyDiscoveryTimeout(timeout);
+            emit q->lowEnergyDiscoveryTimeoutChanged(timeout);
+        }
+    }
+
+    int lowEnergyDiscoveryTimeout() const { return m_deviceDiscovery.lowEnergyDiscoveryTimeout(); }
+
+    void setDiscoveryPolicy(DiscoveryPolicy policy)
+    {
+        if (std::exchange(m_discoveryPolicy, policy) != policy)
+            emit q->discoveryPolicyChanged(m_discoveryPolicy);
+    }
+
+    DiscoveryPolicy discoveryPolicy() const { return m_discoveryPolicy; }
+
+    void setServiceFilterEnabled(bool enabled)
+    {
+        if (enabled == isServiceFilterEnabled())
+            return;
+
+        // the name often is only sent in the scan response, the service is advertised right away
+        m_deviceRegistry.setServiceUuid(enabled ? s_serviceUuid : QBluetoothUuid{});
+        m_deviceRegistry.setNameFilter(enabled ? QString{} : s_robotName);
+
+        emit q->serviceFilterEnabledChanged(enabled);
+    }
+
+    bool isServiceFilterEnabled() const { return m_deviceRegistry.serviceUuid() == s_serviceUuid; }
+
+    void setAddressFilter(const QStringList &addresses)
+    {
+        QList<QBluetoothAddress> filter;
+        filter.reserve(addresses.size());
+
+        for (const auto &address: addresses) {
+            const QBluetoothAddress parsed{address};
+
+            if (parsed.isNull())
+                qCWarning(lcController, "Ignoring invalid address `%ls'", qUtf16Printable(address));
+            else
+                filter.append(parsed);
+        }
+
+        const auto oldFilter = addressFilter();
+        m_deviceRegistry.setAddressFilter(filter);
+
+        if (addressFilter() != oldFilter)
+            emit q->addressFilterChanged(addressFilter());
+    }
+
+    QStringList addressFilter() const
+    {
+        QStringList addresses;
+
+        for (const auto &address: m_deviceRegistry.addressFilter())
+            addresses.append(address.toString());
+
+        addresses.sort();
+        return addresses;
+    }
+
+    void setAutoReconnectEnabled(bool enabled)
+    {
+        if (std::exchange(m_autoReconnectEnabled, enabled) != enabled)
+            emit q->autoReconnectEnabledChanged(m_autoReconnectEnabled);
+    }
+
+    bool isAutoReconnectEnabled() const { return m_autoReconnectEnabled; }
+
+    void setRestoreFrameEnabled(bool enabled)
+    {
+        if (std::exchange(m_restoreFrameEnabled, enabled) != enabled)
+            emit q->restoreFrameEnabledChanged(m_restoreFrameEnabled);
+    }
+
+    bool isRestoreFrameEnabled() const { return m_restoreFrameEnabled; }
+
+    void setConnectionProfile(ConnectionProfile profile)
+    {
+        if (std::exchange(m_connectionProfile, profile) != profile) {
+            emit q->connectionProfileChanged(m_connectionProfile);
+
+            if (m_central && m_central->state() >= QLowEnergyController::ConnectedState)
+                requestConnectionUpdate();
+        }
+    }
+
+    ConnectionProfile connectionProfile() const { return m_connectionProfile; }
+    double connectionInterval() const { return m_connectionInterval; }
+
+private:
+    void checkState()
+    {
+        const auto newState = state();
+
+        if (m_oldState != newState) {
+            qCInfo(lcController, "state changed: %s => %s", key(m_oldState), key(newState));
+            postEvent(EventSink::ControllerStateChanged, EventSink::NoRobot, newState);
+            emit q->stateChanged(newState, m_oldState);
+            m_oldState = newState;
+        }
+    }
+
+    void raiseError(Error error, const QString &errorString)
+    {
+        StateGuard stateGuard{this};
+
+        m_error = error;
+        m_errorString = errorString;
+        qCCritical(lcController, "%ls", qUtf16Printable(errorString));
+        emit q->errorOccured(m_error, m_errorString);
+    }
+
+    // DeviceRegistry
+    void onDeviceDiscovered(const QBluetoothDeviceInfo &device)
+    {
+        postEvent(EventSink::DeviceDiscovered, EventSink::NoRobot, device.rssi(), device.address().toUInt64());
+
+        qCDebug(lcController, "Bluetooth device `%ls' (%ls) discovered",
+                qUtf16Printable(device.name()), qUtf16Printable(device.address().toString()));
+
+        if (m_central)
+            return;
+
+        if (m_discoveryPolicy == StrongestSignalPolicy) {
+            if (!m_selectionTimer.isActive())
+                m_selectionTimer.start(s_signalSelectionWindow);
+
+            return;
+        }
+
+        StateGuard stateGuard{this};
+
+        m_deviceDiscovery.stop();
+        connectToDevice(device);
+    }
+
+    void connectToStrongestDevice()
+    {
+        m_selectionTimer.stop();
+
+        if (m_central)
+            return;
+
+        // ignore robots which have not been seen by the current discovery run
+        const auto strongest = m_deviceRegistry.strongestEntry(m_discoveryStarted);
+
+        if (!strongest.isValid())
+            return;
+
+        StateGuard stateGuard{this};
+
+        qCInfo(lcController, "Choosing %ls out of %d robots (RSSI %d)",
+               qUtf16Printable(strongest.device.address().toString()), m_deviceRegistry.count(), strongest.rssi);
+
+        m_deviceDiscovery.stop();
+        connectToDevice(strongest.device);
+    }
+
+    // Robots still known from an earlier run are reported again once they advertise,
+    // so that restarting discovery doesn't depend on their entries having expired.
+    void startDeviceDiscovery()
+    {
+        m_selectionTimer.stop();
+        m_discoveryStarted = m_deviceRegistry.now();
+        m_deviceRegistry.beginDiscoveryRun();
+        m_deviceDiscovery.start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    }
+
+    void onHostStateChanged(QBluetoothLocalDevice::HostMode state)
+    {
+        StateGuard stateGuard{this};
+
+        if (state == QBluetoothLocalDevice::HostPoweredOff) {
+            qCInfo(lcController, "Activating Bluetooth controller");
+            m_localDevice.powerOn();
+        } else if (!m_central) {
+            if (!connectToCachedDevice())
+                startDeviceDiscovery();
+        }
+    }
+
+    void connectToDevice(const QBluetoothDeviceInfo &device)
+    {
+        m_central = QLowEnergyController::createCentral(device, q);
+
+        connect(m_central, &QLowEnergyController::connected, q, [this] { onDeviceConnected(); });
+        connect(m_central, QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+                q, [this](auto error) { this->onDeviceError(error); });
+        connect(m_central, &QLowEnergyController::disconnected, q, [this] { onDeviceDisconnected(); });
+        connect(m_central, &QLowEnergyController::discoveryFinished,
+                q, [this] { onServiceDiscoveryFinished(); });
+        connect(m_central, &QLowEnergyController::connectionUpdated,
+                q, [this](const auto &parameters) { this->onConnectionUpdated(parameters); });
+
+        qCInfo(lcController, "Connecting to `%ls' (%ls)", qUtf16Printable(device.name()),
+               qUtf16Printable(device.address().toString()));
+
+        m_central->connectToDevice();
+    }
+
+    // Device cache
+    bool connectToCachedDevice()
+    {
+        if (!m_deviceCacheEnabled)
+            return false;
+
+        m_cachedDevice = m_deviceCache.lastEntry();
+
+        if (!m_cachedDevice.isValid())
+            return false;
+
+        const auto addressFilter = m_deviceRegistry.addressFilter();
+
+        if (!addressFilter.isEmpty() && !addressFilter.contains(m_cachedDevice.address)) {
+            m_cachedDevice = {};
+            return false;
+        }
+
+        qCInfo(lcController, "Skipping device discovery for cached device");
+
+        m_connectTimer.start(s_connectTimeout);
+        connectToDevice(lowEnergyDevice(m_cachedDevice.address, m_cachedDevice.name));
+        return true;
+    }
+
+    bool fallBackToDeviceDiscovery()
+    {
+        if (!isConnectingToCachedDevice())
+            return false;
+
+        StateGuard stateGuard{this};
+
+        qCWarning(lcController, "Could not connect to cached device %ls, starting device discovery",
+                  qUtf16Printable(m_cachedDevice.address.toString()));
+
+        m_connectTimer.stop();
+        m_cachedDevice = {};
+        resetCentral();
+
+        startDeviceDiscovery();
+        return true;
+    }
+
+    bool isConnectingToCachedDevice() const
+    {
+        return m_central && m_cachedDevice.isValid() && !isReconnecting()
+                && m_cachedDevice.address == m_central->remoteAddress()
+                && m_robotService.state() != RobotService::ConnectedState;
+    }
+
+    void onConnectTimeout()
+    {
+        if (isReconnecting())
+            scheduleReconnect();
+        else
+            fallBackToDeviceDiscovery();
+    }
+
+    // Auto reconnect
+    bool isReconnecting() const
+    {
+        return !m_reconnectAddress.isNull();
+    }
+
+    bool startReconnecting()
+    {
+        if (!m_autoReconnectEnabled || !m_central || m_central->remoteAddress().isNull())
+            return false;
+
+        StateGuard stateGuard{this};
+
+        m_reconnectAddress = m_central->remoteAddress();
+        m_reconnectName = m_central->remoteName();
+        m_reconnectAttempts = 0;
+
+        // don't let the robot continue the last action when it comes back
+        const auto frame = m_robotService.currentMessage();
+
+        if (frame != s_pauseFrame)
+            m_restorableFrame = frame;
+
+        // the transport is gone, the robot receives the pause once it is connected again
+        m_robotService.resetCurrentMessage(s_pauseFrame);
+
+        qCInfo(lcController, "Lost connection to %ls, reconnecting", qUtf16Printable(m_reconnectAddress.toString()));
+
+        scheduleReconnect();
+        return true;
+    }
+
+    void scheduleReconnect()
+    {
+        StateGuard stateGuard{this};
+
+        m_connectTimer.stop();
+        resetCentral();
+
+        if (m_reconnectAttempts >= s_maximumReconnectAttempts) {
+            qCWarning(lcController, "Could not reconnect to %ls, starting device discovery",
+                      qUtf16Printable(m_reconnectAddress.toString()));
+
+            stopReconnecting();
+            startDeviceDiscovery();
+            return;
+        }
+
+        const auto delay = backoffDelay(m_reconnectAttempts, s_minimumReconnectDelay, s_maximumReconnectDelay);
+
+        qCDebug(lcController, "Reconnecting in %d ms (attempt %d)",
+                static_cast<int>(delay.count()), m_reconnectAttempts + 1);
+
+        ++m_reconnectAttempts;
+        m_reconnectTimer.start(delay);
+    }
+
+    void stopReconnecting()
+    {
+        m_reconnectTimer.stop();
+        m_reconnectAddress = {};
+        m_reconnectName.clear();
+        m_reconnectAttempts = 0;
+    }
+
+    void reconnect()
+    {
+        StateGuard stateGuard{this};
+
+        m_connectTimer.start(s_connectTimeout);
+        connectToDevice(lowEnergyDevice(m_reconnectAddress, m_reconnectName));
+    }
+
+    void restoreFrame()
+    {
+        if (m_restoreFrameEnabled && m_restorableFrame != s_pauseFrame) {
+            qCInfo(lcController, "Restoring last frame");
+            m_robotService.setCurrentMessage(m_restorableFrame);
+        }
+
+        m_restorableFrame = s_pauseFrame;
+    }
+
+    void updateDeviceCache()
+    {
+        if (!m_deviceCacheEnabled || !m_central || m_robotService.state() != RobotService::ConnectedState)
+            return;
+
+        DeviceCache::Entry entry;
+        entry.address = m_central->remoteAddress();
+        entry.name = m_central->remoteName();
+        entry.firmwareRevision = m_robotService.firmwareRevision();
+        entry.layout = m_robotService.layout();
+
+        const auto &cached = m_cachedDevice;
+
+        if (entry.name.isEmpty() && cached.address == entry.address)
+            entry.name = cached.name;
+
+        if (cached.address == entry.address && cached.name == entry.name
+                && cached.firmwareRevision == entry.firmwareRevision && cached.layout == entry.layout)
+            return;
+
+        if (cached.address == entry.address && cached.layout.isValid() && cached.layout != entry.layout)
+            qCWarning(lcController, "Cached attribute layout of %ls was outdated", qUtf16Printable(entry.address.toString()));
+
+        m_deviceCache.store(entry);
+        m_cachedDevice = entry;
+    }
+
+    // RobotService
+    void onRobotServiceStateChanged()
+    {
+        StateGuard stateGuard{this};
+
+        if (m_robotService.state() == RobotService::ConnectedState && isReconnecting()) {
+            qCInfo(lcController, "Reconnected after %d attempt(s)", m_reconnectAttempts);
+            stopReconnecting();
+            restoreFrame();
+        }
+
+        updateDeviceCache();
+    }
+
+    // QBluetoothDeviceDiscoveryAgent
+    void onDeviceDiscoveryError(QBluetoothDeviceDiscoveryAgent::Error error)
+    {
+        raiseError(DeviceDiscoveryError, tr("Device discovery failed: %ls (%d)").
+                   arg(m_deviceDiscovery.errorString()).arg(error));
+    }
+
+    void onDeviceDiscoveryFinished()
+    {
+        StateGuard stateGuard{this};
+        qCInfo(lcController, "Device discovery has finished");
+
+        // no need to wait for the rest of the selection window
+        if (m_selectionTimer.isActive())
+            connectToStrongestDevice();
+    }
+
+    // QLowEnergyController
+    void onDeviceConnected()
+    {
+        StateGuard stateGuard{this};
+
+        m_connectTimer.stop();
+
+        qCInfo(lcController, "Connected to %ls (%ls)", qUtf16Printable(m_central->remoteName()),
+               qUtf16Printable(m_central->remoteAddress().toString()));
+
+        // the update is negotiated in parallel to service discovery
+        requestConnectionUpdate();
+        m_central->discoverServices();
+    }
+
+    void requestConnectionUpdate()
+    {
+        if (m_connectionProfile == DefaultProfile)
+            return;
+
+        const auto parameters = connectionParameters(m_connectionProfile);
+
+        qCInfo(lcController, "Requesting connection interval of %.1f to %.1f ms",
+               parameters.minimumInterval(), parameters.maximumInterval());
+
+        // not all platforms support this, the robot also might reject the parameters
+        m_central->requestConnectionUpdate(parameters);
+    }
+
+    void onConnectionUpdated(const QLowEnergyConnectionParameters &parameters)
+    {
+        qCInfo(lcController, "Connection interval is %.2f ms, latency %d, timeout %d ms",
+               parameters.minimumInterval(), parameters.latency(), parameters.supervisionTimeout());
+
+        setConnectionInterval(parameters.minimumInterval());
+    }
+
+    void setConnectionInterval(double interval)
+    {
+        if (std::exchange(m_connectionInterval, interval) != interval) {
+            if (const auto scheduler = m_robotService.transmitScheduler())
+                scheduler->setConnectionInterval(static_cast<int>(std::ceil(m_connectionInterval)));
+
+            emit q->connectionIntervalChanged(m_connectionInterval);
+        }
+    }
+
+    void onDeviceError(QLowEnergyController::Error error)
+    {
+        if (isReconnecting()) {
+            scheduleReconnect();
+            return;
+        }
+
+        if (fallBackToDeviceDiscovery() || startReconnecting())
+            return;
+
+        raiseError(DeviceError, tr("Device communication failed (%1 (%2))").
+                   arg(m_central->errorString()).arg(error));
+        resetCentral();
+    }
+
+    void onDeviceDisconnected()
+    {
+        setConnectionInterval(0);
+
+        if (isReconnecting())
+            scheduleReconnect();
+        else
+            startReconnecting();
+    }
+
+    void onServiceDiscoveryFinished()
+    {
+        StateGuard stateGuard{this};
+
+        qCInfo(lcController, "Service discovery has finished");
+
+        if (m_deviceCacheEnabled) {
+            if (m_cachedDevice.address != m_central->remoteAddress())
+                m_cachedDevice = m_deviceCache.entry(m_central->remoteAddress());
+            if (m_cachedDevice.isValid())
+                m_robotService.setFirmwareRevision(m_cachedDevice.firmwareRevision);
+        }
+
+        if (!m_robotService.attach(m_central)) {
+            qCWarning(lcController, "Could not find Evolution Robot service at `%ls' (%ls)",
+                      qUtf16Printable(m_central->remoteName()), qUtf16Printable(m_central->remoteAddress().toString()));
+            resetCentral();
+        }
+    }
+
+    void resetCentral()
+    {
+        StateGuard stateGuard{this};
+
+        if (auto central = std::exchange(m_central, {})) {
+            central->disconnect(q);
+            central->deleteLater();
+        }
+
+        setConnectionInterval(0);
+    }
+
+    //
+
+    Controller *const q;
+
+    Error m_error = NoError;
+    QString m_errorString;
+    State m_oldState = UninitializedState;
+
+    QBluetoothLocalDevice m_localDevice;
+    QBluetoothDeviceDiscoveryAgent m_deviceDiscovery;
+    DeviceRegistry m_deviceRegistry;
+    DiscoveryPolicy m_discoveryPolicy = FirstDiscoveredPolicy;
+    QTimer m_selectionTimer;
+    qint64 m_discoveryStarted = 0;
+    QLowEnergyController *m_central = {};
+    RobotService m_robotService;
+
+    bool m_deviceCacheEnabled = false;
+    DeviceCache m_deviceCache;
+    DeviceCache::Entry m_cachedDevice;
+    QTimer m_connectTimer;
+
+    bool m_autoReconnectEnabled = false;
+    bool m_restoreFrameEnabled = false;
+    ConnectionProfile m_connectionProfile = DefaultProfile;
+    double m_connectionInterval = 0;
+    QBluetoothAddress m_reconnectAddress;
+    QString m_reconnectName;
+    int m_reconnectAttempts = 0;
+    RobotFrame m_restorableFrame = s_pauseFrame;
+    QTimer m_reconnectTimer;
+};
+
+Controller::Controller(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+Controller::~Controller()
+{
+    delete d;
+}
+
+Controller::Error Controller::error() const
+{
+    return d->error();
+}
+
+QString Controller::errorString() const
+{
+    return d->errorString();
+}
+
+Controller::State Controller::state() const
+{
+    return d->state();
+}
+
+const char *Controller::stateName(Controller::State state)
+{
+    return key(state);
+}
+
+RobotService *Controller::robotService() const
+{
+    return d->robotService();
+}
+
+DeviceRegistry *Controller::deviceRegistry() const
+{
+    return d->deviceRegistry();
+}
+
+void Controller::setLowEnergyDiscoveryTimeout(int timeout)
+{
+    d->setLowEnergyDiscoveryTimeout(timeout);
+}
+
+int Controller::lowEnergyDiscoveryTimeout() const
+{
+    return d->lowEnergyDiscoveryTimeout();
+}
+
+void Controller::setDiscoveryPolicy(DiscoveryPolicy policy)
+{
+    d->setDiscoveryPolicy(policy);
+}
+
+Controller::DiscoveryPolicy Controller::discoveryPolicy() const
+{
+    return d->discoveryPolicy();
+}
+
+void Controller::setServiceFilterEnabled(bool enabled)
+{
+    d->setServiceFilterEnabled(enabled);
+}
+
+bool Controller::isServiceFilterEnabled() const
+{
+    return d->isServiceFilterEnabled();
+}
+
+void Controller::setAddressFilter(const QStringList &addresses)
+{
+    d->setAddressFilter(addresses);
+}
+
+QStringList Controller::addressFilter() const
+{
+    return d->addressFilter();
+}
+
+void Controller::setDeviceCacheEnabled(bool enabled)
+{
+    d->setDeviceCacheEnabled(enabled);
+}
+
+bool Controller::isDeviceCacheEnabled() const
+{
+    return d->isDeviceCacheEnabled();
+}
+
+void Controller::setAutoReconnectEnabled(bool enabled)
+{
+    d->setAutoReconnectEnabled(enabled);
+}
+
+bool Controller::isAutoReconnectEnabled() const
+{
+    return d->isAutoReconnectEnabled();
+}
+
+void Controller::setRestoreFrameEnabled(bool enabled)
+{
+    d->setRestoreFrameEnabled(enabled);
+}
+
+bool Controller::isRestoreFrameEnabled() const
+{
+    return d->isRestoreFrameEnabled();
+}
+
+void Controller::setConnectionProfile(ConnectionProfile profile)
+{
+    d->setConnectionProfile(profile);
+}
+
+Controller::ConnectionProfile Controller::connectionProfile() const
+{
+    return d->connectionProfile();
+}
+
+double Controller::connectionInterval() const
+{
+    return d->connectionInterval();
+}
+
+} // namespace EvoBot
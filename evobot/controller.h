@@ -0,0 +1,142 @@
+#ifndef EVOBOT_CONTROLLER_H
+#define EVOBOT_CONTROLLER_H
+
+#include <QObject>
+#include <QStringList>
+
+namespace EvoBot {
+
+class DeviceRegistry;
+class RobotService;
+
+class Controller : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int error READ error NOTIFY errorOccured FINAL)
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorOccured FINAL)
+    Q_PROPERTY(int state READ state NOTIFY stateChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotService *robotService READ robotService CONSTANT FINAL)
+    Q_PROPERTY(EvoBot::DeviceRegistry *deviceRegistry READ deviceRegistry CONSTANT FINAL)
+    Q_PROPERTY(int lowEnergyDiscoveryTimeout READ lowEnergyDiscoveryTimeout
+               WRITE setLowEnergyDiscoveryTimeout NOTIFY lowEnergyDiscoveryTimeoutChanged FINAL)
+    Q_PROPERTY(DiscoveryPolicy discoveryPolicy READ discoveryPolicy WRITE setDiscoveryPolicy NOTIFY discoveryPolicyChanged FINAL)
+    Q_PROPERTY(bool serviceFilterEnabled READ isServiceFilterEnabled WRITE setServiceFilterEnabled NOTIFY serviceFilterEnabledChanged FINAL)
+    Q_PROPERTY(QStringList addressFilter READ addressFilter WRITE setAddressFilter NOTIFY addressFilterChanged FINAL)
+    Q_PROPERTY(bool deviceCacheEnabled READ isDeviceCacheEnabled WRITE setDeviceCacheEnabled NOTIFY deviceCacheEnabledChanged FINAL)
+    Q_PROPERTY(bool autoReconnectEnabled READ isAutoReconnectEnabled WRITE setAutoReconnectEnabled NOTIFY autoReconnectEnabledChanged FINAL)
+    Q_PROPERTY(bool restoreFrameEnabled READ isRestoreFrameEnabled WRITE setRestoreFrameEnabled NOTIFY restoreFrameEnabledChanged FINAL)
+    Q_PROPERTY(ConnectionProfile connectionProfile READ connectionProfile WRITE setConnectionProfile NOTIFY connectionProfileChanged FINAL)
+    Q_PROPERTY(double connectionInterval READ connectionInterval NOTIFY connectionIntervalChanged FINAL)
+
+public:
+    enum State {
+        UninitializedState,
+        DeviceDiscoveryState,
+        ServiceDiscoveryState,
+        ConnectingState,
+        ConnectedState,
+        ReconnectingState,
+        ErrorState,
+    };
+
+    Q_ENUM(State)
+
+    enum Error {
+        NoError,
+        BluetoothMissingError,
+        DeviceDiscoveryError,
+        DeviceError,
+    };
+
+    Q_ENUM(Error)
+
+    enum DiscoveryPolicy {
+        FirstDiscoveredPolicy,
+        StrongestSignalPolicy,
+    };
+
+    Q_ENUM(DiscoveryPolicy)
+
+    enum ConnectionProfile {
+        DefaultProfile,
+        LowLatencyProfile,
+        BalancedProfile,
+        PowerSavingProfile,
+    };
+
+    Q_ENUM(ConnectionProfile)
+
+    explicit Controller(QObject *parent = {});
+    ~Controller();
+
+    Error error() const;
+    QString errorString() const;
+    State state() const;
+
+    Q_INVOKABLE static QByteArray stateName(int state) { return stateName(static_cast<State>(state)); }
+    static const char *stateName(State state);
+
+    RobotService *robotService() const;
+    DeviceRegistry *deviceRegistry() const;
+
+    // Device discovery stops after this many milliseconds, zero keeps it running until a robot is found.
+    void setLowEnergyDiscoveryTimeout(int timeout);
+    int lowEnergyDiscoveryTimeout() const;
+
+    // With StrongestSignalPolicy the robots found shortly after the first one are
+    // compared, and the one with the strongest signal is connected.
+    void setDiscoveryPolicy(DiscoveryPolicy policy);
+    DiscoveryPolicy discoveryPolicy() const;
+
+    // When enabled robots are recognized by their advertised control service instead of their name.
+    void setServiceFilterEnabled(bool enabled);
+    bool isServiceFilterEnabled() const;
+
+    // When not empty only robots with one of these addresses are considered.
+    void setAddressFilter(const QStringList &addresses);
+    QStringList addressFilter() const;
+
+    // When enabled the last connected robot is contacted directly, bypassing device discovery.
+    // Disabled by default, since the cached robot might not be the one that is wanted today.
+    void setDeviceCacheEnabled(bool enabled);
+    bool isDeviceCacheEnabled() const;
+
+    // When enabled a lost robot is contacted again directly, with growing delays between
+    // the attempts. Device discovery is restarted only after all attempts have failed.
+    void setAutoReconnectEnabled(bool enabled);
+    bool isAutoReconnectEnabled() const;
+
+    // The robot is paused while reconnecting. When enabled the last frame
+    // other than the pause frame is sent again after reconnecting.
+    void setRestoreFrameEnabled(bool enabled);
+    bool isRestoreFrameEnabled() const;
+
+    // The connection parameters requested once connected. The default profile keeps
+    // the parameters chosen by the platform, which often uses 30 to 50 ms intervals.
+    void setConnectionProfile(ConnectionProfile profile);
+    ConnectionProfile connectionProfile() const;
+
+    // The negotiated connection interval in milliseconds, zero while unknown.
+    double connectionInterval() const;
+
+signals:
+    void errorOccured(Error error, const QString &errorString);
+    void stateChanged(State newState, State oldState);
+    void lowEnergyDiscoveryTimeoutChanged(int timeout);
+    void discoveryPolicyChanged(EvoBot::Controller::DiscoveryPolicy policy);
+    void serviceFilterEnabledChanged(bool enabled);
+    void addressFilterChanged(const QStringList &addresses);
+    void deviceCacheEnabledChanged(bool enabled);
+    void autoReconnectEnabledChanged(bool enabled);
+    void restoreFrameEnabledChanged(bool enabled);
+    void connectionProfileChanged(EvoBot::Controller::ConnectionProfile profile);
+    void connectionIntervalChanged(double connectionInterval);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_CONTROLLER_H
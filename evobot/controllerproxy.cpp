@@ -0,0 +1,270 @@
+#include "controllerproxy.h"
+
+#include "controller.h"
+#include "robotserviceproxy.h"
+
+#include <QLoggingCategory>
+#include <QThread>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcControllerProxy, "evobot.controllerproxy")
+} // namespace
+
+class ControllerProxy::Private
+{
+public:
+    explicit Private(ControllerProxy *q)
+        : q{q}
+    {
+        qRegisterMetaType<Controller::Error>();
+        qRegisterMetaType<Controller::State>();
+        qRegisterMetaType<Controller::DiscoveryPolicy>();
+        qRegisterMetaType<Controller::ConnectionProfile>();
+
+        m_thread.setObjectName(QStringLiteral("EvoBot"));
+        m_thread.start(QThread::HighPriority);
+
+        // everything Bluetooth must be created in the worker thread, the controller's
+        // members are no QObject children and therefore would not follow moveToThread()
+        const auto context = new QObject;
+        context->moveToThread(&m_thread);
+        connect(&m_thread, &QThread::finished, context, &QObject::deleteLater);
+
+        QMetaObject::invokeMethod(context, [this, context] {
+            m_controller = new Controller{context};
+
+            connect(m_controller, &Controller::errorOccured, this->q, [this](auto error, const auto &errorString) {
+                m_error = error;
+                m_errorString = errorString;
+                emit this->q->errorOccured(m_error, m_errorString);
+            });
+
+            connect(m_controller, &Controller::stateChanged, this->q, [this](auto newState) {
+                const auto oldState = std::exchange(m_state, newState);
+
+                if (oldState != newState)
+                    emit this->q->stateChanged(m_state, oldState);
+            });
+
+            connect(m_controller, &Controller::lowEnergyDiscoveryTimeoutChanged, this->q, [this](int timeout) {
+                if (std::exchange(m_lowEnergyDiscoveryTimeout, timeout) != timeout)
+                    emit this->q->lowEnergyDiscoveryTimeoutChanged(m_lowEnergyDiscoveryTimeout);
+            });
+            connect(m_controller, &Controller::discoveryPolicyChanged, this->q, [this](int policy) {
+                if (std::exchange(m_discoveryPolicy, policy) != policy)
+                    emit this->q->discoveryPolicyChanged(m_discoveryPolicy);
+            });
+            connect(m_controller, &Controller::serviceFilterEnabledChanged, this->q, [this](bool enabled) {
+                if (std::exchange(m_serviceFilterEnabled, enabled) != enabled)
+                    emit this->q->serviceFilterEnabledChanged(m_serviceFilterEnabled);
+            });
+            connect(m_controller, &Controller::addressFilterChanged, this->q, [this](const QStringList &addresses) {
+                if (std::exchange(m_addressFilter, addresses) != addresses)
+                    emit this->q->addressFilterChanged(m_addressFilter);
+            });
+            connect(m_controller, &Controller::deviceCacheEnabledChanged, this->q, [this](bool enabled) {
+                if (std::exchange(m_deviceCacheEnabled, enabled) != enabled)
+                    emit this->q->deviceCacheEnabledChanged(m_deviceCacheEnabled);
+            });
+            connect(m_controller, &Controller::autoReconnectEnabledChanged, this->q, [this](bool enabled) {
+                if (std::exchange(m_autoReconnectEnabled, enabled) != enabled)
+                    emit this->q->autoReconnectEnabledChanged(m_autoReconnectEnabled);
+            });
+            connect(m_controller, &Controller::restoreFrameEnabledChanged, this->q, [this](bool enabled) {
+                if (std::exchange(m_restoreFrameEnabled, enabled) != enabled)
+                    emit this->q->restoreFrameEnabledChanged(m_restoreFrameEnabled);
+            });
+            connect(m_controller, &Controller::connectionProfileChanged, this->q, [this](int profile) {
+                if (std::exchange(m_connectionProfile, profile) != profile)
+                    emit this->q->connectionProfileChanged(m_connectionProfile);
+            });
+            connect(m_controller, &Controller::connectionIntervalChanged, this->q, [this](double connectionInterval) {
+                if (std::exchange(m_connectionInterval, connectionInterval) != connectionInterval)
+                    emit this->q->connectionIntervalChanged(m_connectionInterval);
+            });
+
+            m_error = m_controller->error();
+            m_errorString = m_controller->errorString();
+            m_state = m_controller->state();
+            m_lowEnergyDiscoveryTimeout = m_controller->lowEnergyDiscoveryTimeout();
+            m_discoveryPolicy = m_controller->discoveryPolicy();
+            m_serviceFilterEnabled = m_controller->isServiceFilterEnabled();
+            m_addressFilter = m_controller->addressFilter();
+            m_deviceCacheEnabled = m_controller->isDeviceCacheEnabled();
+            m_autoReconnectEnabled = m_controller->isAutoReconnectEnabled();
+            m_restoreFrameEnabled = m_controller->isRestoreFrameEnabled();
+            m_connectionProfile = m_controller->connectionProfile();
+            m_connectionInterval = m_controller->connectionInterval();
+        }, Qt::BlockingQueuedConnection);
+
+        m_robotService = new RobotServiceProxy{m_controller->robotService(), q};
+
+        qCInfo(lcControllerProxy, "Bluetooth stack is running in a separate thread");
+    }
+
+    ~Private()
+    {
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    // Runs the function in the controller's thread.
+    template<typename Function>
+    void invoke(Function function) const
+    {
+        QMetaObject::invokeMethod(m_controller, [controller = m_controller, function] { function(controller); });
+    }
+
+    ControllerProxy *const q;
+
+    QThread m_thread;
+    Controller *m_controller = {};
+    RobotServiceProxy *m_robotService = {};
+
+    Controller::Error m_error = Controller::NoError;
+    QString m_errorString;
+    Controller::State m_state = Controller::UninitializedState;
+
+    int m_lowEnergyDiscoveryTimeout = 0;
+    int m_discoveryPolicy = Controller::FirstDiscoveredPolicy;
+    bool m_serviceFilterEnabled = false;
+    QStringList m_addressFilter;
+    bool m_deviceCacheEnabled = false;
+    bool m_autoReconnectEnabled = false;
+    bool m_restoreFrameEnabled = false;
+    int m_connectionProfile = Controller::DefaultProfile;
+    double m_connectionInterval = 0;
+};
+
+ControllerProxy::ControllerProxy(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+ControllerProxy::~ControllerProxy()
+{
+    delete d;
+}
+
+int ControllerProxy::error() const
+{
+    return d->m_error;
+}
+
+QString ControllerProxy::errorString() const
+{
+    return d->m_errorString;
+}
+
+int ControllerProxy::state() const
+{
+    return d->m_state;
+}
+
+QByteArray ControllerProxy::stateName(int state)
+{
+    return Controller::stateName(state);
+}
+
+RobotServiceProxy *ControllerProxy::robotService() const
+{
+    return d->m_robotService;
+}
+
+void ControllerProxy::setLowEnergyDiscoveryTimeout(int timeout)
+{
+    d->invoke([timeout](Controller *controller) { controller->setLowEnergyDiscoveryTimeout(timeout); });
+}
+
+int ControllerProxy::lowEnergyDiscoveryTimeout() const
+{
+    return d->m_lowEnergyDiscoveryTimeout;
+}
+
+void ControllerProxy::setDiscoveryPolicy(int policy)
+{
+    d->invoke([policy](Controller *controller) {
+        controller->setDiscoveryPolicy(static_cast<Controller::DiscoveryPolicy>(policy));
+    });
+}
+
+int ControllerProxy::discoveryPolicy() const
+{
+    return d->m_discoveryPolicy;
+}
+
+void ControllerProxy::setServiceFilterEnabled(bool enabled)
+{
+    d->invoke([enabled](Controller *controller) { controller->setServiceFilterEnabled(enabled); });
+}
+
+bool ControllerProxy::isServiceFilterEnabled() const
+{
+    return d->m_serviceFilterEnabled;
+}
+
+void ControllerProxy::setAddressFilter(const QStringList &addresses)
+{
+    d->invoke([addresses](Controller *controller) { controller->setAddressFilter(addresses); });
+}
+
+QStringList ControllerProxy::addressFilter() const
+{
+    return d->m_addressFilter;
+}
+
+void ControllerProxy::setDeviceCacheEnabled(bool enabled)
+{
+    d->invoke([enabled](Controller *controller) { controller->setDeviceCacheEnabled(enabled); });
+}
+
+bool ControllerProxy::isDeviceCacheEnabled() const
+{
+    return d->m_deviceCacheEnabled;
+}
+
+void ControllerProxy::setAutoReconnectEnabled(bool enabled)
+{
+    d->invoke([enabled](Controller *controller) { controller->setAutoReconnectEnabled(enabled); });
+}
+
+bool ControllerProxy::isAutoReconnectEnabled() const
+{
+    return d->m_autoReconnectEnabled;
+}
+
+void ControllerProxy::setRestoreFrameEnabled(bool enabled)
+{
+    d->invoke([enabled](Controller *controller) { controller->setRestoreFrameEnabled(enabled); });
+}
+
+bool ControllerProxy::isRestoreFrameEnabled() const
+{
+    return d->m_restoreFrameEnabled;
+}
+
+void ControllerProxy::setConnectionProfile(int profile)
+{
+    d->invoke([profile](Controller *controller) {
+        controller->setConnectionProfile(static_cast<Controller::ConnectionProfile>(profile));
+    });
+}
+
+int ControllerProxy::connectionProfile() const
+{
+    return d->m_connectionProfile;
+}
+
+double ControllerProxy::connectionInterval() const
+{
+    return d->m_connectionInterval;
+}
+
+Controller *ControllerProxy::controller() const
+{
+    return d->m_controller;
+}
+
+} // namespace EvoBot
@@ -0,0 +1,95 @@
+#ifndef EVOBOT_CONTROLLERPROXY_H
+#define EVOBOT_CONTROLLERPROXY_H
+
+#include <QObject>
+#include <QStringList>
+
+namespace EvoBot {
+
+class Controller;
+class RobotServiceProxy;
+
+// Runs a Controller with its Bluetooth stack in a dedicated thread, so that transmissions
+// and notifications don't wait for the UI. Offers the value properties of Controller, with
+// enumerations passed as int. The deviceRegistry is left out, since it is a QObject living
+// in the worker thread; reach it through controller() with queued calls.
+class ControllerProxy : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int error READ error NOTIFY errorOccured FINAL)
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorOccured FINAL)
+    Q_PROPERTY(int state READ state NOTIFY stateChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotServiceProxy *robotService READ robotService CONSTANT FINAL)
+    Q_PROPERTY(int lowEnergyDiscoveryTimeout READ lowEnergyDiscoveryTimeout
+               WRITE setLowEnergyDiscoveryTimeout NOTIFY lowEnergyDiscoveryTimeoutChanged FINAL)
+    Q_PROPERTY(int discoveryPolicy READ discoveryPolicy WRITE setDiscoveryPolicy NOTIFY discoveryPolicyChanged FINAL)
+    Q_PROPERTY(bool serviceFilterEnabled READ isServiceFilterEnabled WRITE setServiceFilterEnabled NOTIFY serviceFilterEnabledChanged FINAL)
+    Q_PROPERTY(QStringList addressFilter READ addressFilter WRITE setAddressFilter NOTIFY addressFilterChanged FINAL)
+    Q_PROPERTY(bool deviceCacheEnabled READ isDeviceCacheEnabled WRITE setDeviceCacheEnabled NOTIFY deviceCacheEnabledChanged FINAL)
+    Q_PROPERTY(bool autoReconnectEnabled READ isAutoReconnectEnabled WRITE setAutoReconnectEnabled NOTIFY autoReconnectEnabledChanged FINAL)
+    Q_PROPERTY(bool restoreFrameEnabled READ isRestoreFrameEnabled WRITE setRestoreFrameEnabled NOTIFY restoreFrameEnabledChanged FINAL)
+    Q_PROPERTY(int connectionProfile READ connectionProfile WRITE setConnectionProfile NOTIFY connectionProfileChanged FINAL)
+    Q_PROPERTY(double connectionInterval READ connectionInterval NOTIFY connectionIntervalChanged FINAL)
+
+public:
+    explicit ControllerProxy(QObject *parent = {});
+    ~ControllerProxy() override;
+
+    int error() const;
+    QString errorString() const;
+    int state() const;
+
+    Q_INVOKABLE static QByteArray stateName(int state);
+
+    RobotServiceProxy *robotService() const;
+
+    void setLowEnergyDiscoveryTimeout(int timeout);
+    int lowEnergyDiscoveryTimeout() const;
+
+    void setDiscoveryPolicy(int policy);
+    int discoveryPolicy() const;
+
+    void setServiceFilterEnabled(bool enabled);
+    bool isServiceFilterEnabled() const;
+
+    void setAddressFilter(const QStringList &addresses);
+    QStringList addressFilter() const;
+
+    void setDeviceCacheEnabled(bool enabled);
+    bool isDeviceCacheEnabled() const;
+
+    void setAutoReconnectEnabled(bool enabled);
+    bool isAutoReconnectEnabled() const;
+
+    void setRestoreFrameEnabled(bool enabled);
+    bool isRestoreFrameEnabled() const;
+
+    void setConnectionProfile(int profile);
+    int connectionProfile() const;
+
+    double connectionInterval() const;
+
+    // The controller lives in the worker thread, use queued calls to access it.
+    Controller *controller() const;
+
+signals:
+    void errorOccured(int error, const QString &errorString);
+    void stateChanged(int newState, int oldState);
+    void lowEnergyDiscoveryTimeoutChanged(int timeout);
+    void discoveryPolicyChanged(int policy);
+    void serviceFilterEnabledChanged(bool enabled);
+    void addressFilterChanged(const QStringList &addresses);
+    void deviceCacheEnabledChanged(bool enabled);
+    void autoReconnectEnabledChanged(bool enabled);
+    void restoreFrameEnabledChanged(bool enabled);
+    void connectionProfileChanged(int profile);
+    void connectionIntervalChanged(double connectionInterval);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_CONTROLLERPROXY_H
@@ -0,0 +1,130 @@
+#include "devicecache.h"
+
+#include <QLoggingCategory>
+#include <QSettings>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcDeviceCache, "evobot.devicecache")
+
+const auto s_devicesGroup = QStringLiteral("devices");
+const auto s_lastAddressKey = QStringLiteral("lastAddress");
+const auto s_addressKey = QStringLiteral("address");
+const auto s_nameKey = QStringLiteral("name");
+const auto s_firmwareRevisionKey = QStringLiteral("firmwareRevision");
+const auto s_notifyHandleKey = QStringLiteral("notifyHandle");
+const auto s_notifyConfigHandleKey = QStringLiteral("notifyConfigHandle");
+const auto s_writeHandleKey = QStringLiteral("writeHandle");
+
+QString groupName(const QBluetoothAddress &address)
+{
+    return QString::number(address.toUInt64(), 16);
+}
+
+std::unique_ptr<QSettings> createSettings(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        return std::make_unique<QSettings>(QSettings::IniFormat, QSettings::UserScope,
+                                           QStringLiteral("EvoBot"), QStringLiteral("devicecache"));
+    }
+
+    return std::make_unique<QSettings>(fileName, QSettings::IniFormat);
+}
+
+} // namespace
+
+DeviceCache::DeviceCache(const QString &fileName)
+    : m_settings{createSettings(fileName)}
+{
+    qCDebug(lcDeviceCache, "Using device cache at %ls", qUtf16Printable(m_settings->fileName()));
+}
+
+DeviceCache::~DeviceCache() = default;
+
+QList<DeviceCache::Entry> DeviceCache::entries() const
+{
+    QList<Entry> entries;
+
+    m_settings->beginGroup(s_devicesGroup);
+    const auto groups = m_settings->childGroups();
+    m_settings->endGroup();
+
+    for (const auto &group: groups) {
+        const auto entry = read(group);
+
+        if (entry.isValid())
+            entries.append(entry);
+    }
+
+    return entries;
+}
+
+DeviceCache::Entry DeviceCache::entry(const QBluetoothAddress &address) const
+{
+    if (address.isNull())
+        return {};
+
+    return read(groupName(address));
+}
+
+DeviceCache::Entry DeviceCache::lastEntry() const
+{
+    return entry(QBluetoothAddress{m_settings->value(s_lastAddressKey).toString()});
+}
+
+void DeviceCache::store(const Entry &entry)
+{
+    if (!entry.isValid())
+        return;
+
+    m_settings->beginGroup(s_devicesGroup);
+    m_settings->beginGroup(groupName(entry.address));
+    m_settings->setValue(s_addressKey, entry.address.toString());
+    m_settings->setValue(s_nameKey, entry.name);
+    m_settings->setValue(s_firmwareRevisionKey, entry.firmwareRevision);
+    m_settings->setValue(s_notifyHandleKey, entry.layout.notifyHandle);
+    m_settings->setValue(s_notifyConfigHandleKey, entry.layout.notifyConfigHandle);
+    m_settings->setValue(s_writeHandleKey, entry.layout.writeHandle);
+    m_settings->endGroup();
+    m_settings->endGroup();
+
+    m_settings->setValue(s_lastAddressKey, entry.address.toString());
+}
+
+void DeviceCache::remove(const QBluetoothAddress &address)
+{
+    m_settings->beginGroup(s_devicesGroup);
+    m_settings->remove(groupName(address));
+    m_settings->endGroup();
+
+    if (QBluetoothAddress{m_settings->value(s_lastAddressKey).toString()} == address)
+        m_settings->remove(s_lastAddressKey);
+}
+
+void DeviceCache::clear()
+{
+    m_settings->clear();
+}
+
+DeviceCache::Entry DeviceCache::read(const QString &group) const
+{
+    Entry entry;
+
+    m_settings->beginGroup(s_devicesGroup);
+    m_settings->beginGroup(group);
+
+    entry.address = QBluetoothAddress{m_settings->value(s_addressKey).toString()};
+    entry.name = m_settings->value(s_nameKey).toString();
+    entry.firmwareRevision = m_settings->value(s_firmwareRevisionKey, -1).toInt();
+    entry.layout.notifyHandle = static_cast<quint16>(m_settings->value(s_notifyHandleKey).toUInt());
+    entry.layout.notifyConfigHandle = static_cast<quint16>(m_settings->value(s_notifyConfigHandleKey).toUInt());
+    entry.layout.writeHandle = static_cast<quint16>(m_settings->value(s_writeHandleKey).toUInt());
+
+    m_settings->endGroup();
+    m_settings->endGroup();
+
+    return entry;
+}
+
+} // namespace EvoBot
@@ -0,0 +1,49 @@
+#ifndef EVOBOT_DEVICECACHE_H
+#define EVOBOT_DEVICECACHE_H
+
+#include "robotservice.h"
+
+#include <QBluetoothAddress>
+
+#include <memory>
+
+class QSettings;
+
+namespace EvoBot {
+
+class DeviceCache
+{
+public:
+    struct Entry
+    {
+        QBluetoothAddress address;
+        QString name;
+        int firmwareRevision = -1;
+        RobotService::Layout layout;
+
+        bool isValid() const { return !address.isNull(); }
+    };
+
+    // Uses the per-user settings location unless a file name is given.
+    explicit DeviceCache(const QString &fileName = {});
+    ~DeviceCache();
+
+    QList<Entry> entries() const;
+    Entry entry(const QBluetoothAddress &address) const;
+    Entry lastEntry() const;
+
+    void store(const Entry &entry);
+    void remove(const QBluetoothAddress &address);
+    void clear();
+
+private:
+    Q_DISABLE_COPY(DeviceCache)
+
+    Entry read(const QString &group) const;
+
+    const std::unique_ptr<QSettings> m_settings;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_DEVICECACHE_H
@@ -0,0 +1,437 @@
+#include "deviceregistry.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcDeviceRegistry, "evobot.deviceregistry")
+
+const auto s_defaultNameFilter = QStringLiteral("Evolution-Robot");
+const auto s_defaultCapacity = 256;
+const auto s_defaultTimeToLive = 30000;
+const auto s_minimumExpiryInterval = 100;
+
+quint64 hashKey(const QBluetoothAddress &address)
+{
+    return address.toUInt64();
+}
+
+} // namespace
+
+class DeviceRegistry::Private
+{
+public:
+    explicit Private(DeviceRegistry *q)
+        : q{q}
+    {
+        m_clock.start();
+
+        connect(&m_expiryTimer, &QTimer::timeout, q, [this] { expire(); });
+        updateExpiryTimer();
+    }
+
+    bool addDevice(const QBluetoothDeviceInfo &device)
+    {
+        if (!matches(device))
+            return false;
+
+        const auto key = hashKey(device.address());
+        const auto now = m_clock.elapsed();
+        const auto it = m_entries.find(key);
+
+        if (it != m_entries.end()) {
+            const auto rssi = device.rssi();
+
+            it->device = device;
+            it->lastSeen = now;
+
+            if (rssi != 0)
+                it->rssi = rssi;
+
+            reportDiscovered(key, device);
+            return false;
+        }
+
+        if (m_entries.size() >= m_capacity)
+            evictOldest();
+
+        m_entries.insert(key, {device, device.rssi(), now, now});
+
+        qCDebug(lcDeviceRegistry, "Device `%ls' (%ls) added", qUtf16Printable(device.name()),
+                qUtf16Printable(device.address().toString()));
+
+        updateExpiryTimer();
+        emit q->deviceAdded(device);
+        emit q->countChanged(count());
+        reportDiscovered(key, device);
+        return true;
+    }
+
+    void removeDevice(const QBluetoothAddress &address)
+    {
+        if (m_entries.remove(hashKey(address)) > 0) {
+            m_discovered.remove(hashKey(address));
+            updateExpiryTimer();
+            emit q->deviceRemoved(address);
+            emit q->countChanged(count());
+        }
+    }
+
+    void clear()
+    {
+        const auto entries = std::exchange(m_entries, {});
+        m_discovered.clear();
+
+        if (!entries.isEmpty()) {
+            updateExpiryTimer();
+
+            for (const auto &entry: entries)
+                emit q->deviceRemoved(entry.device.address());
+
+            emit q->countChanged(count());
+        }
+    }
+
+    void beginDiscoveryRun()
+    {
+        m_discovered.clear();
+    }
+
+    // the cheapest checks come first, most advertisers are rejected by them
+    bool matches(const QBluetoothDeviceInfo &device) const
+    {
+        if (!m_addressFilter.isEmpty() && !m_addressFilter.contains(hashKey(device.address())))
+            return false;
+        if (!m_serviceUuid.isNull() && !device.serviceUuids().contains(m_serviceUuid))
+            return false;
+        if (!m_nameFilter.isEmpty() && device.name() != m_nameFilter)
+            return false;
+        if (m_manufacturerId >= 0 && !device.manufacturerIds().contains(static_cast<quint16>(m_manufacturerId)))
+            return false;
+
+        return true;
+    }
+
+    bool contains(const QBluetoothAddress &address) const
+    {
+        return m_entries.contains(hashKey(address));
+    }
+
+    Entry entry(const QBluetoothAddress &address) const
+    {
+        return m_entries.value(hashKey(address));
+    }
+
+    QList<Entry> entries() const
+    {
+        return m_entries.values();
+    }
+
+    int count() const { return m_entries.size(); }
+
+    Entry strongestEntry(qint64 seenSince) const
+    {
+        // an RSSI of zero means the signal strength is unknown
+        const auto strength = [](const Entry &entry) {
+            return entry.rssi ? entry.rssi : std::numeric_limits<qint16>::min();
+        };
+
+        auto strongest = m_entries.cend();
+
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            if (it->lastSeen >= seenSince && (strongest == m_entries.cend() || strength(*it) > strength(*strongest)))
+                strongest = it;
+        }
+
+        return strongest != m_entries.cend() ? *strongest : Entry{};
+    }
+
+    qint64 now() const { return m_clock.elapsed(); }
+
+    void setCapacity(int capacity)
+    {
+        capacity = qMax(1, capacity);
+
+        if (std::exchange(m_capacity, capacity) != capacity) {
+            const auto oldCount = count();
+
+            while (m_entries.size() > m_capacity)
+                evictOldest();
+
+            if (count() != oldCount)
+                emit q->countChanged(count());
+
+            emit q->capacityChanged(m_capacity);
+        }
+    }
+
+    int capacity() const { return m_capacity; }
+
+    void setTimeToLive(int timeToLive)
+    {
+        timeToLive = qMax(0, timeToLive);
+
+        if (std::exchange(m_timeToLive, timeToLive) != timeToLive) {
+            updateExpiryTimer();
+            emit q->timeToLiveChanged(m_timeToLive);
+        }
+    }
+
+    int timeToLive() const { return m_timeToLive; }
+
+    void setNameFilter(const QString &nameFilter)
+    {
+        if (std::exchange(m_nameFilter, nameFilter) != nameFilter)
+            emit q->nameFilterChanged(m_nameFilter);
+    }
+
+    QString nameFilter() const { return m_nameFilter; }
+
+    void setManufacturerId(int manufacturerId)
+    {
+        manufacturerId = qMax(-1, manufacturerId);
+
+        if (std::exchange(m_manufacturerId, manufacturerId) != manufacturerId)
+            emit q->manufacturerIdChanged(m_manufacturerId);
+    }
+
+    int manufacturerId() const { return m_manufacturerId; }
+
+    void setServiceUuid(const QBluetoothUuid &serviceUuid) { m_serviceUuid = serviceUuid; }
+    QBluetoothUuid serviceUuid() const { return m_serviceUuid; }
+
+    void setAddressFilter(const QList<QBluetoothAddress> &addresses)
+    {
+        m_addressFilter.clear();
+        m_addressFilter.reserve(addresses.size());
+
+        for (const auto &address: addresses)
+            m_addressFilter.insert(hashKey(address));
+    }
+
+    QList<QBluetoothAddress> addressFilter() const
+    {
+        QList<QBluetoothAddress> addresses;
+        addresses.reserve(m_addressFilter.size());
+
+        for (const auto key: m_addressFilter)
+            addresses.append(QBluetoothAddress{key});
+
+        return addresses;
+    }
+
+private:
+    void reportDiscovered(quint64 key, const QBluetoothDeviceInfo &device)
+    {
+        if (!m_discovered.contains(key)) {
+            m_discovered.insert(key);
+            emit q->deviceDiscovered(device);
+        }
+    }
+
+    void updateExpiryTimer()
+    {
+        if (m_timeToLive > 0 && !m_entries.isEmpty()) {
+            const auto interval = qMax(s_minimumExpiryInterval, m_timeToLive / 4);
+
+            if (!m_expiryTimer.isActive() || m_expiryTimer.interval() != interval)
+                m_expiryTimer.start(interval);
+        } else {
+            m_expiryTimer.stop();
+        }
+    }
+
+    void expire()
+    {
+        const auto deadline = m_clock.elapsed() - m_timeToLive;
+        auto expired = 0;
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+            if (it->lastSeen < deadline) {
+                const auto address = it->device.address();
+
+                qCDebug(lcDeviceRegistry, "Device %ls expired", qUtf16Printable(address.toString()));
+
+                m_discovered.remove(it.key());
+                it = m_entries.erase(it);
+                ++expired;
+
+                emit q->deviceRemoved(address);
+            } else {
+                ++it;
+            }
+        }
+
+        if (expired > 0) {
+            updateExpiryTimer();
+            emit q->countChanged(count());
+        }
+    }
+
+    // Only called when the registry is full, so the linear scan doesn't hurt the common case.
+    void evictOldest()
+    {
+        const auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.lastSeen < rhs.lastSeen;
+        });
+
+        if (oldest != m_entries.end()) {
+            const auto address = oldest->device.address();
+
+            qCDebug(lcDeviceRegistry, "Registry is full, evicting %ls", qUtf16Printable(address.toString()));
+
+            m_discovered.remove(oldest.key());
+            m_entries.erase(oldest);
+            emit q->deviceRemoved(address);
+        }
+    }
+
+    DeviceRegistry *const q;
+
+    QHash<quint64, Entry> m_entries;
+    QSet<quint64> m_discovered;
+    QElapsedTimer m_clock;
+    QTimer m_expiryTimer;
+
+    int m_capacity = s_defaultCapacity;
+    int m_timeToLive = s_defaultTimeToLive;
+    QString m_nameFilter = s_defaultNameFilter;
+    int m_manufacturerId = -1;
+    QBluetoothUuid m_serviceUuid;
+    QSet<quint64> m_addressFilter;
+};
+
+DeviceRegistry::DeviceRegistry(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+DeviceRegistry::~DeviceRegistry()
+{
+    delete d;
+}
+
+bool DeviceRegistry::addDevice(const QBluetoothDeviceInfo &device)
+{
+    return d->addDevice(device);
+}
+
+void DeviceRegistry::removeDevice(const QBluetoothAddress &address)
+{
+    d->removeDevice(address);
+}
+
+void DeviceRegistry::clear()
+{
+    d->clear();
+}
+
+void DeviceRegistry::beginDiscoveryRun()
+{
+    d->beginDiscoveryRun();
+}
+
+bool DeviceRegistry::matches(const QBluetoothDeviceInfo &device) const
+{
+    return d->matches(device);
+}
+
+bool DeviceRegistry::contains(const QBluetoothAddress &address) const
+{
+    return d->contains(address);
+}
+
+DeviceRegistry::Entry DeviceRegistry::entry(const QBluetoothAddress &address) const
+{
+    return d->entry(address);
+}
+
+QList<DeviceRegistry::Entry> DeviceRegistry::entries() const
+{
+    return d->entries();
+}
+
+int DeviceRegistry::count() const
+{
+    return d->count();
+}
+
+DeviceRegistry::Entry DeviceRegistry::strongestEntry(qint64 seenSince) const
+{
+    return d->strongestEntry(seenSince);
+}
+
+qint64 DeviceRegistry::now() const
+{
+    return d->now();
+}
+
+void DeviceRegistry::setCapacity(int capacity)
+{
+    d->setCapacity(capacity);
+}
+
+int DeviceRegistry::capacity() const
+{
+    return d->capacity();
+}
+
+void DeviceRegistry::setTimeToLive(int timeToLive)
+{
+    d->setTimeToLive(timeToLive);
+}
+
+int DeviceRegistry::timeToLive() const
+{
+    return d->timeToLive();
+}
+
+void DeviceRegistry::setNameFilter(const QString &nameFilter)
+{
+    d->setNameFilter(nameFilter);
+}
+
+QString DeviceRegistry::nameFilter() const
+{
+    return d->nameFilter();
+}
+
+void DeviceRegistry::setManufacturerId(int manufacturerId)
+{
+    d->setManufacturerId(manufacturerId);
+}
+
+int DeviceRegistry::manufacturerId() const
+{
+    return d->manufacturerId();
+}
+
+void DeviceRegistry::setServiceUuid(const QBluetoothUuid &serviceUuid)
+{
+    d->setServiceUuid(serviceUuid);
+}
+
+QBluetoothUuid DeviceRegistry::serviceUuid() const
+{
+    return d->serviceUuid();
+}
+
+void DeviceRegistry::setAddressFilter(const QList<QBluetoothAddress> &addresses)
+{
+    d->setAddressFilter(addresses);
+}
+
+QList<QBluetoothAddress> DeviceRegistry::addressFilter() const
+{
+    return d->addressFilter();
+}
+
+} // namespace EvoBot
@@ -0,0 +1,95 @@
+#ifndef EVOBOT_DEVICEREGISTRY_H
+#define EVOBOT_DEVICEREGISTRY_H
+
+#include <QBluetoothDeviceInfo>
+#include <QObject>
+
+namespace EvoBot {
+
+// The Bluetooth devices seen recently, keyed by address. Only devices passing the address,
+// service, name and manufacturer filters are recorded; entries expire when they stop advertising.
+class DeviceRegistry : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged FINAL)
+    Q_PROPERTY(int timeToLive READ timeToLive WRITE setTimeToLive NOTIFY timeToLiveChanged FINAL)
+    Q_PROPERTY(QString nameFilter READ nameFilter WRITE setNameFilter NOTIFY nameFilterChanged FINAL)
+    Q_PROPERTY(int manufacturerId READ manufacturerId WRITE setManufacturerId NOTIFY manufacturerIdChanged FINAL)
+
+public:
+    struct Entry
+    {
+        QBluetoothDeviceInfo device;
+        qint16 rssi = 0;
+        qint64 firstSeen = 0;
+        qint64 lastSeen = 0;
+
+        bool isValid() const { return device.isValid(); }
+    };
+
+    explicit DeviceRegistry(QObject *parent = {});
+    ~DeviceRegistry() override;
+
+    // Records an advertisement, returns true if the device was not known before.
+    bool addDevice(const QBluetoothDeviceInfo &device);
+    void removeDevice(const QBluetoothAddress &address);
+    void clear();
+
+    // Starts a new discovery run: every device gets reported by deviceDiscovered() again
+    // with its next advertisement, also when it still is known from an earlier run.
+    void beginDiscoveryRun();
+
+    bool matches(const QBluetoothDeviceInfo &device) const;
+    bool contains(const QBluetoothAddress &address) const;
+    Entry entry(const QBluetoothAddress &address) const;
+    QList<Entry> entries() const;
+    int count() const;
+
+    // The device with the strongest signal among those seen since the given time. Devices
+    // with unknown signal strength are only chosen if there is no other. Invalid if none.
+    Entry strongestEntry(qint64 seenSince = 0) const;
+
+    // Milliseconds on the registry's clock, as used by Entry::firstSeen and Entry::lastSeen.
+    qint64 now() const;
+
+    void setCapacity(int capacity);
+    int capacity() const;
+
+    // The time in milliseconds after which silent devices are forgotten; zero keeps them.
+    void setTimeToLive(int timeToLive);
+    int timeToLive() const;
+
+    // An empty name filter accepts any name, a negative manufacturer id any manufacturer.
+    void setNameFilter(const QString &nameFilter);
+    QString nameFilter() const;
+
+    void setManufacturerId(int manufacturerId);
+    int manufacturerId() const;
+
+    // A null service UUID accepts any device, otherwise it must be advertised.
+    void setServiceUuid(const QBluetoothUuid &serviceUuid);
+    QBluetoothUuid serviceUuid() const;
+
+    // An empty address filter accepts any device.
+    void setAddressFilter(const QList<QBluetoothAddress> &addresses);
+    QList<QBluetoothAddress> addressFilter() const;
+
+signals:
+    void deviceAdded(const QBluetoothDeviceInfo &device);
+    void deviceDiscovered(const QBluetoothDeviceInfo &device);
+    void deviceRemoved(const QBluetoothAddress &address);
+    void countChanged(int count);
+    void capacityChanged(int capacity);
+    void timeToLiveChanged(int timeToLive);
+    void nameFilterChanged(const QString &nameFilter);
+    void manufacturerIdChanged(int manufacturerId);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_DEVICEREGISTRY_H
@@ -0,0 +1,364 @@
+#include "eventsink.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QTimer>
+#include <QtEndian>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcEventSink, "evobot.eventsink")
+
+const auto s_defaultCapacity = 8192;
+const auto s_defaultDrainInterval = 250;
+const auto s_magicSize = 8;
+const auto s_drainBatchSize = 64;
+
+std::atomic<EventSink *> s_installedSink{nullptr};
+
+struct Slot
+{
+    std::atomic<quint64> sequence;
+    EventRecord record;
+};
+
+int roundUpToPowerOfTwo(int value)
+{
+    auto result = 2;
+
+    while (result < value)
+        result <<= 1;
+
+    return result;
+}
+
+qint64 monotonicNanoseconds()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void writeRecord(const EventRecord &record, uchar *data)
+{
+    qToLittleEndian<qint64>(record.timestamp, data);
+    qToLittleEndian<quint16>(record.event, data + 8);
+    qToLittleEndian<quint16>(record.robot, data + 10);
+    qToLittleEndian<qint32>(record.argument, data + 12);
+    qToLittleEndian<quint64>(record.value, data + 16);
+}
+
+EventRecord readRecord(const uchar *data)
+{
+    EventRecord record;
+
+    record.timestamp = qFromLittleEndian<qint64>(data);
+    record.event = qFromLittleEndian<quint16>(data + 8);
+    record.robot = qFromLittleEndian<quint16>(data + 10);
+    record.argument = qFromLittleEndian<qint32>(data + 12);
+    record.value = qFromLittleEndian<quint64>(data + 16);
+
+    return record;
+}
+
+} // namespace
+
+constexpr quint16 EventSink::NoRobot;
+constexpr char EventSink::Magic[];
+constexpr int EventSink::HeaderSize;
+constexpr int EventSink::RecordSize;
+
+class EventSink::Private
+{
+public:
+    Private(EventSink *q, int capacity)
+        : q{q}
+        , m_capacity{roundUpToPowerOfTwo(capacity)}
+        , m_mask{static_cast<quint64>(m_capacity - 1)}
+        , m_slots{new Slot[static_cast<size_t>(m_capacity)]}
+        , m_startTime{monotonicNanoseconds()}
+        , m_startTimeSinceEpoch{QDateTime::currentMSecsSinceEpoch()}
+    {
+        for (auto i = 0; i < m_capacity; ++i)
+            m_slots[i].sequence.store(static_cast<quint64>(i), std::memory_order_relaxed);
+
+        m_drainTimer.setInterval(s_defaultDrainInterval);
+        connect(&m_drainTimer, &QTimer::timeout, q, [this] { drain(); });
+        m_drainTimer.start();
+    }
+
+    // A bounded multi-producer queue after Dmitry Vyukov: the sequence of a slot tells whether
+    // it is free for the producer at that position, or holds a record for the consumer.
+    void post(Event event, quint16 robot, qint32 argument, quint64 value)
+    {
+        const auto timestamp = monotonicNanoseconds() - m_startTime;
+        auto position = m_head.load(std::memory_order_relaxed);
+        Slot *slot;
+
+        for (;;) {
+            slot = &m_slots[position & m_mask];
+
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<qint64>(sequence - position);
+
+            if (difference == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->record = {timestamp, event, robot, argument, value};
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // the only consumer, running in the sink's thread
+    void drain()
+    {
+        std::array<uchar, s_drainBatchSize * RecordSize> batch;
+        auto batchSize = 0;
+        auto written = false;
+
+        for (;;) {
+            auto &slot = m_slots[m_tail & m_mask];
+
+            if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1)
+                break;
+
+            if (m_device)
+                writeRecord(slot.record, batch.data() + RecordSize * batchSize++);
+
+            slot.sequence.store(m_tail + static_cast<quint64>(m_capacity), std::memory_order_release);
+            ++m_tail;
+
+            if (batchSize == s_drainBatchSize) {
+                m_device->write(reinterpret_cast<const char *>(batch.data()), RecordSize * batchSize);
+                batchSize = 0;
+                written = true;
+            }
+        }
+
+        if (batchSize > 0) {
+            m_device->write(reinterpret_cast<const char *>(batch.data()), RecordSize * batchSize);
+            written = true;
+        }
+
+        // files buffer their writes, which would delay the events for no benefit
+        if (written) {
+            if (const auto file = qobject_cast<QFileDevice *>(m_device.data()))
+                file->flush();
+        }
+    }
+
+    void setDevice(QIODevice *device)
+    {
+        drain();
+
+        if (m_device == &m_file && device != &m_file)
+            m_file.close();
+
+        m_device = device;
+
+        if (m_device) {
+            std::array<uchar, HeaderSize> header;
+
+            std::memcpy(header.data(), Magic, s_magicSize);
+            qToLittleEndian<qint64>(m_startTimeSinceEpoch, header.data() + s_magicSize);
+            m_device->write(reinterpret_cast<const char *>(header.data()), HeaderSize);
+        }
+    }
+
+    QIODevice *device() const { return m_device; }
+
+    bool open(const QString &fileName)
+    {
+        setDevice(nullptr);
+
+        m_file.setFileName(fileName);
+
+        if (!m_file.open(QFile::WriteOnly | QFile::Truncate)) {
+            qCWarning(lcEventSink, "Cannot open %ls: %ls", qUtf16Printable(fileName), qUtf16Printable(m_file.errorString()));
+            return false;
+        }
+
+        setDevice(&m_file);
+        return true;
+    }
+
+    QString errorString() const { return m_device ? m_device->errorString() : m_file.errorString(); }
+
+    int capacity() const { return m_capacity; }
+    quint64 postedEvents() const { return m_head.load(std::memory_order_relaxed) + droppedEvents(); }
+    quint64 droppedEvents() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+    void setDrainInterval(int drainInterval)
+    {
+        if (std::exchange(m_drainInterval, drainInterval) != drainInterval) {
+            if (m_drainInterval > 0)
+                m_drainTimer.start(m_drainInterval);
+            else
+                m_drainTimer.stop();
+
+            emit q->drainIntervalChanged(m_drainInterval);
+        }
+    }
+
+    int drainInterval() const { return m_drainInterval; }
+
+private:
+    EventSink *const q;
+
+    const int m_capacity;
+    const quint64 m_mask;
+    const std::unique_ptr<Slot[]> m_slots;
+    const qint64 m_startTime;
+    const qint64 m_startTimeSinceEpoch;
+
+    std::atomic<quint64> m_head{0};
+    std::atomic<quint64> m_droppedEvents{0};
+    quint64 m_tail = 0;
+
+    QPointer<QIODevice> m_device;
+    QFile m_file;
+    int m_drainInterval = s_defaultDrainInterval;
+    QTimer m_drainTimer;
+};
+
+EventSink::EventSink(QObject *parent)
+    : EventSink{s_defaultCapacity, parent}
+{}
+
+EventSink::EventSink(int capacity, QObject *parent)
+    : QObject{parent}
+    , d{new Private{this, capacity}}
+{}
+
+EventSink::~EventSink()
+{
+    auto sink = this;
+    s_installedSink.compare_exchange_strong(sink, nullptr);
+
+    d->drain();
+    delete d;
+}
+
+void EventSink::install(EventSink *sink)
+{
+    s_installedSink.store(sink, std::memory_order_release);
+}
+
+EventSink *EventSink::installed()
+{
+    return s_installedSink.load(std::memory_order_acquire);
+}
+
+void EventSink::setDevice(QIODevice *device)
+{
+    d->setDevice(device);
+}
+
+QIODevice *EventSink::device() const
+{
+    return d->device();
+}
+
+bool EventSink::open(const QString &fileName)
+{
+    return d->open(fileName);
+}
+
+QString EventSink::errorString() const
+{
+    return d->errorString();
+}
+
+int EventSink::capacity() const
+{
+    return d->capacity();
+}
+
+quint64 EventSink::postedEvents() const
+{
+    return d->postedEvents();
+}
+
+quint64 EventSink::droppedEvents() const
+{
+    return d->droppedEvents();
+}
+
+void EventSink::setDrainInterval(int drainInterval)
+{
+    d->setDrainInterval(qMax(0, drainInterval));
+}
+
+int EventSink::drainInterval() const
+{
+    return d->drainInterval();
+}
+
+void EventSink::post(Event event, quint16 robot, qint32 argument, quint64 value)
+{
+    d->post(event, robot, argument, value);
+}
+
+void EventSink::drain()
+{
+    d->drain();
+}
+
+bool EventSink::read(const QString &fileName, QList<EventRecord> *records, qint64 *startTime, QString *errorString)
+{
+    QFile file{fileName};
+
+    if (!file.open(QFile::ReadOnly)) {
+        if (errorString)
+            *errorString = file.errorString();
+
+        return false;
+    }
+
+    const auto data = file.readAll();
+    const auto bytes = reinterpret_cast<const uchar *>(data.constData());
+
+    if (data.size() < HeaderSize || std::memcmp(bytes, Magic, s_magicSize) != 0) {
+        if (errorString)
+            *errorString = tr("%1 is no event log").arg(fileName);
+
+        return false;
+    }
+
+    if (startTime)
+        *startTime = qFromLittleEndian<qint64>(bytes + s_magicSize);
+
+    if (records) {
+        records->clear();
+        records->reserve((data.size() - HeaderSize) / RecordSize);
+
+        // a trailing partial record is what got cut off by a crash
+        for (auto offset = HeaderSize; offset + RecordSize <= data.size(); offset += RecordSize)
+            records->append(readRecord(bytes + offset));
+    }
+
+    return true;
+}
+
+void postEvent(EventSink::Event event, quint16 robot, qint32 argument, quint64 value)
+{
+    if (const auto sink = s_installedSink.load(std::memory_order_acquire))
+        sink->post(event, robot, argument, value);
+}
+
+} // namespace EvoBot
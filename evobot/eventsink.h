@@ -0,0 +1,108 @@
+#ifndef EVOBOT_EVENTSINK_H
+#define EVOBOT_EVENTSINK_H
+
+#include <QObject>
+
+class QIODevice;
+
+namespace EvoBot {
+
+// One entry of an event log. Timestamps are nanoseconds on a monotonic clock, counted from
+// the creation of the sink. The meaning of argument and value depends on the event.
+struct EventRecord
+{
+    qint64 timestamp = 0;
+    quint16 event = 0;
+    quint16 robot = 0;
+    qint32 argument = 0;
+    quint64 value = 0;
+};
+
+// Collects structured diagnostic events at a cost low enough to keep them enabled in
+// production. Posting an event copies a fixed size record into a lock-free ring buffer,
+// from any thread. The buffer is drained periodically from the sink's thread into a file
+// or socket, formatting happens offline in evobot-eventdump. Events are dropped, and
+// counted, while the buffer is full. Robot ids number the robot services in order of
+// their creation.
+//
+// The log starts with a 16 byte header of the magic and the start time in milliseconds
+// since the epoch, followed by records of 24 bytes: the 64 bit timestamp, the 16 bit event
+// and robot ids, the 32 bit argument and the 64 bit value. All numbers are little endian.
+class EventSink : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int capacity READ capacity CONSTANT FINAL)
+    Q_PROPERTY(int drainInterval READ drainInterval WRITE setDrainInterval NOTIFY drainIntervalChanged FINAL)
+
+public:
+    enum Event : quint16 {
+        InvalidEvent,
+        TransportStateChanged,      // argument: the new RobotService::State
+        FirmwareRevisionChanged,    // argument: the firmware revision
+        FrameIssued,                // argument: 1 if written with response; value: the frame
+        FrameAcknowledged,          // value: the frame
+        FrameLost,                  // a write was not acknowledged in time
+        NotificationReceived,       // argument: the Notification::Type; value: the sound index
+        ControllerStateChanged,     // argument: the new Controller::State
+        DeviceDiscovered,           // argument: the RSSI; value: the Bluetooth address
+    };
+
+    Q_ENUM(Event)
+
+    // the robot id of events that don't belong to a robot
+    static constexpr quint16 NoRobot = 0xffff;
+
+    static constexpr char Magic[] = "EvoBotE1";
+    static constexpr int HeaderSize = 16;
+    static constexpr int RecordSize = 24;
+
+    // The capacity in events is rounded up to a power of two.
+    explicit EventSink(QObject *parent = {});
+    explicit EventSink(int capacity, QObject *parent = {});
+    ~EventSink() override;
+
+    // Installs the sink that receives the events of all EvoBot objects; pass null to stop
+    // collecting. The sink gets uninstalled when it is destroyed, but must outlive all
+    // threads still posting events.
+    static void install(EventSink *sink);
+    static EventSink *installed();
+
+    // Writes the header to the device, then drains the buffer into it. The sink takes
+    // no ownership. A null device discards the events, so that only the counters remain.
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    bool open(const QString &fileName);
+    QString errorString() const;
+
+    int capacity() const;
+    quint64 postedEvents() const;
+    quint64 droppedEvents() const;
+
+    void setDrainInterval(int drainInterval);
+    int drainInterval() const;
+
+    // Thread-safe and lock-free, never blocks or allocates.
+    void post(Event event, quint16 robot, qint32 argument = 0, quint64 value = 0);
+
+    // Reads a complete log. Returns false if the file is no event log.
+    static bool read(const QString &fileName, QList<EventRecord> *records,
+                     qint64 *startTime = nullptr, QString *errorString = nullptr);
+
+public slots:
+    void drain();
+
+signals:
+    void drainIntervalChanged(int drainInterval);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+// Posts the event to the installed sink. Costs a single atomic load while no sink is installed.
+void postEvent(EventSink::Event event, quint16 robot, qint32 argument = 0, quint64 value = 0);
+
+} // namespace EvoBot
+
+#endif // EVOBOT_EVENTSINK_H
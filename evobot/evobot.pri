@@ -0,0 +1,22 @@
+# Links the evobot library, include this from projects using it.
+
+CONFIG += c++14
+
+DEFINES += \
+    QT_DEPRECATED_WARNINGS \
+    QT_DISABLE_DEPRECATED_BEFORE=0x060000
+
+QT += bluetooth
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+EVOBOT_LIBDIR = $$shadowed($$PWD)
+
+win32:CONFIG(debug, debug|release): EVOBOT_LIBDIR = $$EVOBOT_LIBDIR/debug
+else:win32: EVOBOT_LIBDIR = $$EVOBOT_LIBDIR/release
+
+LIBS += -L$$EVOBOT_LIBDIR -levobot
+
+win32-msvc*: PRE_TARGETDEPS += $$EVOBOT_LIBDIR/evobot.lib
+else: PRE_TARGETDEPS += $$EVOBOT_LIBDIR/libevobot.a
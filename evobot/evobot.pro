@@ -0,0 +1,59 @@
+TEMPLATE = lib
+TARGET = evobot
+
+QT = core bluetooth
+
+CONFIG += c++14 staticlib
+
+DEFINES += \
+    QT_DEPRECATED_WARNINGS \
+    QT_DISABLE_DEPRECATED_BEFORE=0x060000
+
+HEADERS += \
+    actionencoding.h \
+    actionmodel.h \
+    actionparser.h \
+    bluetoothtransport.h \
+    controller.h \
+    controllerproxy.h \
+    devicecache.h \
+    deviceregistry.h \
+    eventsink.h \
+    fleetcontroller.h \
+    notificationdecoder.h \
+    robotframe.h \
+    robotgroup.h \
+    robotmetrics.h \
+    robotservice.h \
+    robotserviceproxy.h \
+    robottransport.h \
+    sequencer.h \
+    sessionrecorder.h \
+    sessionreplayer.h \
+    simulatedtransport.h \
+    transmitscheduler.h \
+    utilities.h
+
+SOURCES += \
+    actionencoding.cpp \
+    actionmodel.cpp \
+    actionparser.cpp \
+    bluetoothtransport.cpp \
+    controller.cpp \
+    controllerproxy.cpp \
+    devicecache.cpp \
+    deviceregistry.cpp \
+    eventsink.cpp \
+    fleetcontroller.cpp \
+    notificationdecoder.cpp \
+    robotframe.cpp \
+    robotgroup.cpp \
+    robotmetrics.cpp \
+    robotservice.cpp \
+    robotserviceproxy.cpp \
+    sequencer.cpp \
+    sessionrecorder.cpp \
+    sessionreplayer.cpp \
+    simulatedtransport.cpp \
+    transmitscheduler.cpp \
+    utilities.cpp
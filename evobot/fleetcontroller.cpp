@@ -0,0 +1,587 @@
+#include "fleetcontroller.h"
+
+#include "deviceregistry.h"
+#include "robotservice.h"
+#include "robottransport.h"
+#include "utilities.h"
+
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QBluetoothLocalDevice>
+#include <QLoggingCategory>
+#include <QLowEnergyController>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcFleetController, "evobot.fleetcontroller")
+
+const auto s_defaultMaximumConcurrentConnections = 2;
+const auto s_maximumConnectionAttempts = 3;
+const auto s_minimumRetryDelay = 500ms;
+const auto s_maximumRetryDelay = 8s;
+
+// robots still failing after all attempts get a fresh set of attempts this often
+const auto s_failedRetryInterval = 60s;
+
+const auto s_discoveryRestartDelay = 5s;
+
+} // namespace
+
+class FleetController::Private
+{
+    struct Robot
+    {
+        explicit Robot(const QBluetoothDeviceInfo &device) : device{device} {}
+
+        QBluetoothDeviceInfo device;
+        QLowEnergyController *central = {};
+        RobotService *service = {};
+        QString errorString;
+        int attempts = 0;
+        bool queued = false;
+        QTimer retryTimer;
+    };
+
+public:
+    explicit Private(FleetController *q)
+        : q{q}
+    {
+        // the registry can also be fed without a Bluetooth controller, like for simulations
+        connect(&m_deviceRegistry, &DeviceRegistry::deviceAdded,
+                q, [this](const auto &device) { this->onDeviceDiscovered(device); });
+        connect(&m_deviceRegistry, &DeviceRegistry::deviceRemoved,
+                q, [this](const auto &address) { this->onDeviceRemoved(address); });
+
+        if (!m_localDevice.isValid()) {
+            raiseError(BluetoothMissingError, tr("No Bluetooth controller available"));
+            return;
+        }
+
+        m_discoveryRestartTimer.setSingleShot(true);
+        connect(&m_discoveryRestartTimer, &QTimer::timeout, q, [this] { restartDeviceDiscovery(); });
+
+        connect(&m_localDevice, &QBluetoothLocalDevice::hostModeStateChanged,
+                q, [this](auto state) { this->onHostStateChanged(state); });
+
+        connect(&m_deviceDiscovery, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered,
+                q, [this](const auto &device) { m_deviceRegistry.addDevice(device); });
+        connect(&m_deviceDiscovery, &QBluetoothDeviceDiscoveryAgent::deviceUpdated,
+                q, [this](const auto &device) { m_deviceRegistry.addDevice(device); });
+        connect(&m_deviceDiscovery, QOverload<QBluetoothDeviceDiscoveryAgent::Error>::of(&QBluetoothDeviceDiscoveryAgent::error),
+                q, [this](auto error) { this->onDeviceDiscoveryError(error); });
+        connect(&m_deviceDiscovery,  &QBluetoothDeviceDiscoveryAgent::finished,
+                q, [this] { onDeviceDiscoveryFinished(); });
+
+        onHostStateChanged(m_localDevice.hostMode());
+    }
+
+    Error error() const { return m_error; }
+    QString errorString() const { return m_errorString; }
+
+    int count() const { return static_cast<int>(m_robots.size()); }
+
+    int connectedCount() const
+    {
+        return static_cast<int>(std::count_if(m_robots.begin(), m_robots.end(), [this](const auto &robot) {
+            return state(*robot) == ConnectedState;
+        }));
+    }
+
+    void setMaximumConcurrentConnections(int maximumConcurrentConnections)
+    {
+        maximumConcurrentConnections = qMax(1, maximumConcurrentConnections);
+
+        if (std::exchange(m_maximumConcurrentConnections, maximumConcurrentConnections) != maximumConcurrentConnections) {
+            emit q->maximumConcurrentConnectionsChanged(m_maximumConcurrentConnections);
+            connectPending();
+        }
+    }
+
+    int maximumConcurrentConnections() const { return m_maximumConcurrentConnections; }
+
+    DeviceRegistry *deviceRegistry() { return &m_deviceRegistry; }
+
+    void setTransportFactory(const TransportFactory &transportFactory) { m_transportFactory = transportFactory; }
+
+    RobotService *robotService(int row) const
+    {
+        if (row < 0 || row >= count())
+            return {};
+
+        return m_robots[static_cast<size_t>(row)]->service;
+    }
+
+    QList<RobotService *> robotServices() const
+    {
+        QList<RobotService *> services;
+        services.reserve(count());
+
+        for (const auto &robot: m_robots) {
+            if (robot->service)
+                services.append(robot->service);
+        }
+
+        return services;
+    }
+
+    QVariant data(int row, int role) const
+    {
+        if (row < 0 || row >= count())
+            return {};
+
+        const auto &robot = *m_robots[static_cast<size_t>(row)];
+
+        switch (static_cast<Role>(role)) {
+        case AddressRole:
+            return robot.device.address().toString();
+        case NameRole:
+            return robot.device.name();
+        case StateRole:
+            return state(robot);
+        case ErrorStringRole:
+            return robot.errorString;
+        case RobotServiceRole:
+            return QVariant::fromValue(robot.service);
+        }
+
+        if (role == Qt::DisplayRole)
+            return robot.device.address().toString();
+
+        return {};
+    }
+
+private:
+    RobotState state(const Robot &robot) const
+    {
+        if (robot.service && robot.service->state() == RobotService::ConnectedState)
+            return ConnectedState;
+        if (robot.central || robot.service)
+            return ConnectingState;
+        if (robot.queued)
+            return QueuedState;
+
+        // waiting for the next attempt
+        if (robot.retryTimer.isActive() && robot.attempts < s_maximumConnectionAttempts)
+            return QueuedState;
+
+        return FailedState;
+    }
+
+    int connectingCount() const
+    {
+        return static_cast<int>(std::count_if(m_robots.begin(), m_robots.end(), [this](const auto &robot) {
+            return state(*robot) == ConnectingState;
+        }));
+    }
+
+    int rowOf(const Robot *robot) const
+    {
+        const auto it = std::find_if(m_robots.begin(), m_robots.end(),
+                                     [robot](const auto &entry) { return entry.get() == robot; });
+
+        return it != m_robots.end() ? static_cast<int>(it - m_robots.begin()) : -1;
+    }
+
+    void notifyChanged(const Robot *robot)
+    {
+        const auto modelIndex = q->index(rowOf(robot));
+        emit q->dataChanged(modelIndex, modelIndex);
+    }
+
+    void raiseError(Error error, const QString &errorString)
+    {
+        m_error = error;
+        m_errorString = errorString;
+        qCCritical(lcFleetController, "%ls", qUtf16Printable(errorString));
+        emit q->errorOccured(m_error, m_errorString);
+    }
+
+    void enqueue(Robot *robot)
+    {
+        robot->retryTimer.stop();
+        robot->queued = true;
+        m_pendingConnections.push_back(robot);
+        notifyChanged(robot);
+        connectPending();
+    }
+
+    void connectPending()
+    {
+        while (!m_pendingConnections.empty() && connectingCount() < m_maximumConcurrentConnections) {
+            const auto robot = m_pendingConnections.front();
+            m_pendingConnections.pop_front();
+            connectToRobot(robot);
+        }
+    }
+
+    void connectToRobot(Robot *robot)
+    {
+        robot->queued = false;
+        ++robot->attempts;
+
+        if (m_transportFactory) {
+            connectTransport(robot);
+            return;
+        }
+
+        const auto central = robot->central = QLowEnergyController::createCentral(robot->device, q);
+
+        connect(central, &QLowEnergyController::connected, q, [central] { central->discoverServices(); });
+        connect(central, QOverload<QLowEnergyController::Error>::of(&QLowEnergyController::error),
+                q, [this, robot](auto error) { this->onDeviceError(robot, error); });
+        connect(central, &QLowEnergyController::disconnected,
+                q, [this, robot] { onDeviceDisconnected(robot); });
+        connect(central, &QLowEnergyController::discoveryFinished,
+                q, [this, robot] { onServiceDiscoveryFinished(robot); });
+
+        qCInfo(lcFleetController, "Connecting to `%ls' (%ls), attempt %d",
+               qUtf16Printable(robot->device.name()), qUtf16Printable(robot->device.address().toString()),
+               robot->attempts);
+
+        central->connectToDevice();
+        notifyChanged(robot);
+    }
+
+    void connectTransport(Robot *robot)
+    {
+        robot->service = new RobotService{q};
+
+        connect(robot->service, &RobotService::stateChanged,
+                q, [this, robot](int newState) { this->onRobotServiceStateChanged(robot, newState); });
+
+        qCInfo(lcFleetController, "Connecting to `%ls' (%ls) by transport, attempt %d",
+               qUtf16Printable(robot->device.name()), qUtf16Printable(robot->device.address().toString()),
+               robot->attempts);
+
+        if (robot->service->attach(m_transportFactory(robot->device)))
+            notifyChanged(robot);
+        else
+            failRobot(robot, tr("Could not create transport for %1").arg(robot->device.address().toString()));
+    }
+
+    void failRobot(Robot *robot, const QString &errorString)
+    {
+        const auto wasConnected = (state(*robot) == ConnectedState);
+
+        qCWarning(lcFleetController, "%ls", qUtf16Printable(errorString));
+        robot->errorString = errorString;
+
+        if (auto central = std::exchange(robot->central, {})) {
+            central->disconnect(q);
+            central->deleteLater();
+        }
+
+        if (auto service = std::exchange(robot->service, {})) {
+            service->disconnect(q);
+            service->deleteLater();
+        }
+
+        if (wasConnected)
+            emit q->connectedCountChanged(connectedCount());
+
+        // robots that stopped advertising are given up once all attempts have failed, which
+        // happens later, since this might get called by the robot's own retry timer
+        if (robot->attempts >= s_maximumConnectionAttempts && !m_deviceRegistry.contains(robot->device.address())) {
+            const auto address = robot->device.address();
+            QTimer::singleShot(0, q, [this, address] { onDeviceRemoved(address); });
+        } else {
+            scheduleRetry(robot);
+        }
+
+        notifyChanged(robot);
+        connectPending();
+    }
+
+    void removeRobot(Robot *robot)
+    {
+        const auto row = rowOf(robot);
+
+        if (row < 0)
+            return;
+
+        qCInfo(lcFleetController, "Robot `%ls' (%ls) removed",
+               qUtf16Printable(robot->device.name()), qUtf16Printable(robot->device.address().toString()));
+
+        m_pendingConnections.erase(std::remove(m_pendingConnections.begin(), m_pendingConnections.end(), robot),
+                                   m_pendingConnections.end());
+
+        q->beginRemoveRows({}, row, row);
+        m_robots.erase(m_robots.begin() + row);
+        q->endRemoveRows();
+
+        emit q->countChanged(count());
+    }
+
+    // Retries with exponentially growing delays. Once all attempts have failed, the robot
+    // gets a fresh set of attempts after a while, since a robot that keeps advertising
+    // never expires from the registry to be reported again.
+    void scheduleRetry(Robot *robot)
+    {
+        if (robot->attempts < s_maximumConnectionAttempts) {
+            // robots losing an established connection start over with zero attempts
+            const auto exponent = std::max(0, robot->attempts - 1);
+            const auto delay = backoffDelay(exponent, s_minimumRetryDelay, s_maximumRetryDelay);
+
+            qCDebug(lcFleetController, "Retrying %ls in %d ms", qUtf16Printable(robot->device.address().toString()),
+                    static_cast<int>(delay.count()));
+
+            robot->retryTimer.start(delay);
+        } else {
+            robot->retryTimer.start(s_failedRetryInterval);
+        }
+    }
+
+    void onRetryTimeout(Robot *robot)
+    {
+        if (robot->attempts >= s_maximumConnectionAttempts)
+            robot->attempts = 0;
+
+        enqueue(robot);
+    }
+
+    void restartDeviceDiscovery()
+    {
+        if (std::exchange(m_error, NoError) != NoError) {
+            m_errorString.clear();
+            emit q->errorOccured(m_error, m_errorString);
+        }
+
+        qCInfo(lcFleetController, "Restarting device discovery");
+        m_deviceDiscovery.start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    }
+
+    // QBluetoothLocalDevice
+    void onHostStateChanged(QBluetoothLocalDevice::HostMode state)
+    {
+        if (state == QBluetoothLocalDevice::HostPoweredOff) {
+            qCInfo(lcFleetController, "Activating Bluetooth controller");
+            m_localDevice.powerOn();
+        } else {
+            m_deviceDiscovery.start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+        }
+    }
+
+    // DeviceRegistry
+    void onDeviceDiscovered(const QBluetoothDeviceInfo &device)
+    {
+        const auto address = device.address();
+        const auto known = std::find_if(m_robots.begin(), m_robots.end(),
+                                        [&address](const auto &robot) { return robot->device.address() == address; });
+
+        // the registry reports robots again after they expired, which gives failed ones another chance right away
+        if (known != m_robots.end()) {
+            const auto robot = known->get();
+
+            if (state(*robot) == FailedState) {
+                robot->device = device;
+                robot->attempts = 0;
+                enqueue(robot);
+            }
+
+            return;
+        }
+
+        qCInfo(lcFleetController, "Robot `%ls' (%ls) discovered",
+               qUtf16Printable(device.name()), qUtf16Printable(address.toString()));
+
+        q->beginInsertRows({}, count(), count());
+        m_robots.emplace_back(std::make_unique<Robot>(device));
+        q->endInsertRows();
+
+        const auto robot = m_robots.back().get();
+
+        robot->retryTimer.setSingleShot(true);
+        connect(&robot->retryTimer, &QTimer::timeout, q, [this, robot] { onRetryTimeout(robot); });
+
+        emit q->countChanged(count());
+        enqueue(robot);
+    }
+
+    // Connected robots stop advertising, so only failed ones get removed when they expire.
+    // The others are removed once their remaining attempts failed too.
+    void onDeviceRemoved(const QBluetoothAddress &address)
+    {
+        const auto known = std::find_if(m_robots.begin(), m_robots.end(),
+                                        [&address](const auto &robot) { return robot->device.address() == address; });
+
+        if (known != m_robots.end() && state(**known) == FailedState)
+            removeRobot(known->get());
+    }
+
+    // QBluetoothDeviceDiscoveryAgent
+    void onDeviceDiscoveryError(QBluetoothDeviceDiscoveryAgent::Error error)
+    {
+        raiseError(DeviceDiscoveryError, tr("Device discovery failed: %1 (%2)").
+                   arg(m_deviceDiscovery.errorString()).arg(error));
+
+        // robots might get switched on at any time, also after the adapter was reset
+        m_discoveryRestartTimer.start(s_discoveryRestartDelay);
+    }
+
+    void onDeviceDiscoveryFinished()
+    {
+        // keep discovering, robots might get switched on at any time
+        if (m_error == NoError) {
+            qCDebug(lcFleetController, "Device discovery has finished, restarting");
+            m_deviceDiscovery.start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+        }
+    }
+
+    // QLowEnergyController
+    void onDeviceError(Robot *robot, QLowEnergyController::Error error)
+    {
+        failRobot(robot, tr("Communication with %1 failed (%2 (%3))").
+                  arg(robot->device.address().toString(), robot->central->errorString()).arg(error));
+    }
+
+    void onDeviceDisconnected(Robot *robot)
+    {
+        failRobot(robot, tr("Connection to %1 was lost").arg(robot->device.address().toString()));
+    }
+
+    void onServiceDiscoveryFinished(Robot *robot)
+    {
+        robot->service = new RobotService{q};
+
+        connect(robot->service, &RobotService::stateChanged,
+                q, [this, robot](int newState) { this->onRobotServiceStateChanged(robot, newState); });
+
+        if (!robot->service->attach(robot->central)) {
+            failRobot(robot, tr("Could not find Evolution Robot service at %1").
+                      arg(robot->device.address().toString()));
+        }
+    }
+
+    // RobotService
+    void onRobotServiceStateChanged(Robot *robot, int newState)
+    {
+        // without a controller of its own the transport reports failed and lost connections
+        if (newState == RobotService::DisconnectedState && !robot->central) {
+            failRobot(robot, tr("Connection to %1 was lost").arg(robot->device.address().toString()));
+            return;
+        }
+
+        if (newState == RobotService::ConnectedState) {
+            robot->attempts = 0;
+            robot->retryTimer.stop();
+            robot->errorString.clear();
+        }
+
+        notifyChanged(robot);
+        emit q->connectedCountChanged(connectedCount());
+        connectPending();
+    }
+
+    //
+
+    FleetController *const q;
+
+    Error m_error = NoError;
+    QString m_errorString;
+    int m_maximumConcurrentConnections = s_defaultMaximumConcurrentConnections;
+
+    QBluetoothLocalDevice m_localDevice;
+    QBluetoothDeviceDiscoveryAgent m_deviceDiscovery;
+    DeviceRegistry m_deviceRegistry;
+    QTimer m_discoveryRestartTimer;
+    TransportFactory m_transportFactory;
+    std::vector<std::unique_ptr<Robot>> m_robots;
+    std::deque<Robot *> m_pendingConnections;
+};
+
+FleetController::FleetController(QObject *parent)
+    : QAbstractListModel{parent}
+    , d{new Private{this}}
+{}
+
+FleetController::~FleetController()
+{
+    delete d;
+}
+
+FleetController::Error FleetController::error() const
+{
+    return d->error();
+}
+
+QString FleetController::errorString() const
+{
+    return d->errorString();
+}
+
+int FleetController::count() const
+{
+    return d->count();
+}
+
+int FleetController::connectedCount() const
+{
+    return d->connectedCount();
+}
+
+void FleetController::setMaximumConcurrentConnections(int maximumConcurrentConnections)
+{
+    d->setMaximumConcurrentConnections(maximumConcurrentConnections);
+}
+
+int FleetController::maximumConcurrentConnections() const
+{
+    return d->maximumConcurrentConnections();
+}
+
+DeviceRegistry *FleetController::deviceRegistry() const
+{
+    return d->deviceRegistry();
+}
+
+void FleetController::setTransportFactory(const TransportFactory &transportFactory)
+{
+    d->setTransportFactory(transportFactory);
+}
+
+RobotService *FleetController::robotService(int row) const
+{
+    return d->robotService(row);
+}
+
+QList<RobotService *> FleetController::robotServices() const
+{
+    return d->robotServices();
+}
+
+int FleetController::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return d->count();
+}
+
+QVariant FleetController::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.parent().isValid())
+        return {};
+
+    return d->data(index.row(), role);
+}
+
+QHash<int, QByteArray> FleetController::roleNames() const
+{
+    return {
+        {AddressRole, "address"},
+        {NameRole, "name"},
+        {StateRole, "state"},
+        {ErrorStringRole, "errorString"},
+        {RobotServiceRole, "robotService"},
+    };
+}
+
+} // namespace EvoBot
@@ -0,0 +1,95 @@
+#ifndef EVOBOT_FLEETCONTROLLER_H
+#define EVOBOT_FLEETCONTROLLER_H
+
+#include <QAbstractListModel>
+
+#include <functional>
+
+class QBluetoothDeviceInfo;
+
+namespace EvoBot {
+
+class DeviceRegistry;
+class RobotService;
+class RobotTransport;
+
+class FleetController : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int error READ error NOTIFY errorOccured FINAL)
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorOccured FINAL)
+    Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(int connectedCount READ connectedCount NOTIFY connectedCountChanged FINAL)
+    Q_PROPERTY(EvoBot::DeviceRegistry *deviceRegistry READ deviceRegistry CONSTANT FINAL)
+    Q_PROPERTY(int maximumConcurrentConnections READ maximumConcurrentConnections
+               WRITE setMaximumConcurrentConnections NOTIFY maximumConcurrentConnectionsChanged FINAL)
+
+public:
+    enum Role {
+        AddressRole = Qt::UserRole + 1,
+        NameRole,
+        StateRole,
+        ErrorStringRole,
+        RobotServiceRole,
+    };
+
+    Q_ENUM(Role)
+
+    enum RobotState {
+        QueuedState,
+        ConnectingState,
+        ConnectedState,
+        FailedState,
+    };
+
+    Q_ENUM(RobotState)
+
+    enum Error {
+        NoError,
+        BluetoothMissingError,
+        DeviceDiscoveryError,
+    };
+
+    Q_ENUM(Error)
+
+    // Creates the link to a discovered robot instead of connecting by Bluetooth, like for
+    // simulations. The transport connects on its own, getting disconnected fails the attempt.
+    using TransportFactory = std::function<RobotTransport *(const QBluetoothDeviceInfo &device)>;
+
+    explicit FleetController(QObject *parent = {});
+    ~FleetController() override;
+
+    Error error() const;
+    QString errorString() const;
+
+    int count() const;
+    int connectedCount() const;
+
+    void setMaximumConcurrentConnections(int maximumConcurrentConnections);
+    int maximumConcurrentConnections() const;
+
+    DeviceRegistry *deviceRegistry() const;
+
+    void setTransportFactory(const TransportFactory &transportFactory);
+
+    Q_INVOKABLE EvoBot::RobotService *robotService(int row) const;
+    QList<RobotService *> robotServices() const;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+    void errorOccured(Error error, const QString &errorString);
+    void countChanged(int count);
+    void connectedCountChanged(int connectedCount);
+    void maximumConcurrentConnectionsChanged(int maximumConcurrentConnections);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_FLEETCONTROLLER_H
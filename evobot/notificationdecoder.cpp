@@ -0,0 +1,57 @@
+#include "notificationdecoder.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace EvoBot {
+
+namespace {
+
+const auto s_maximumIndex = 0xffff;
+
+template<std::size_t N>
+bool startsWith(const char *begin, const char *end, const char (&literal)[N]) noexcept
+{
+    constexpr auto length = static_cast<std::ptrdiff_t>(N - 1);
+    return end - begin >= length && std::memcmp(begin, literal, N - 1) == 0;
+}
+
+bool isDigit(char ch) noexcept
+{
+    return ch >= '0' && ch <= '9';
+}
+
+} // namespace
+
+Notification NotificationDecoder::decode(const char *data, int size) noexcept
+{
+    const auto end = data + size;
+
+    for (auto it = data; it != end; ++it) {
+        if (*it != 'V')
+            continue;
+
+        const auto digits = it + 1;
+        auto suffix = digits;
+        auto index = 0;
+
+        for (; suffix != end && isDigit(*suffix); ++suffix) {
+            if (index <= s_maximumIndex)
+                index = 10 * index + (*suffix - '0');
+        }
+
+        if (suffix == digits)
+            continue;
+
+        if (startsWith(suffix, end, "Play"))
+            return {Notification::SoundStarted, index};
+        if (startsWith(suffix, end, "End"))
+            return {Notification::SoundEnded, index};
+
+        it = suffix - 1;
+    }
+
+    return {};
+}
+
+} // namespace EvoBot
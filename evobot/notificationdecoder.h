@@ -0,0 +1,38 @@
+#ifndef EVOBOT_NOTIFICATIONDECODER_H
+#define EVOBOT_NOTIFICATIONDECODER_H
+
+#include <QByteArray>
+
+namespace EvoBot {
+
+struct Notification
+{
+    enum Type {
+        UnknownNotification,
+        SoundStarted,
+        SoundEnded,
+    };
+
+    constexpr Notification() noexcept = default;
+    constexpr Notification(Type type, int index) noexcept
+        : type{type}, index{index}
+    {}
+
+    constexpr explicit operator bool() const noexcept { return type != UnknownNotification; }
+
+    Type type = UnknownNotification;
+    int index = -1;
+};
+
+// Decodes the text notifications of the 0xfff4 characteristic, like `V12Play' and `V12End',
+// directly from the received bytes and without allocating memory.
+class NotificationDecoder
+{
+public:
+    static Notification decode(const char *data, int size) noexcept;
+    static Notification decode(const QByteArray &value) noexcept { return decode(value.constData(), value.size()); }
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_NOTIFICATIONDECODER_H
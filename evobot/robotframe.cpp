@@ -0,0 +1,26 @@
+#include "robotframe.h"
+
+#include <algorithm>
+
+namespace EvoBot {
+
+RobotFrame RobotFrame::fromByteArray(const QByteArray &bytes, bool *ok) noexcept
+{
+    RobotFrame frame;
+
+    const auto valid = (bytes.size() == Size);
+
+    if (valid)
+        std::copy(bytes.begin(), bytes.end(), frame.m_data.begin());
+    if (ok)
+        *ok = valid;
+
+    return frame;
+}
+
+QByteArray RobotFrame::toByteArray() const
+{
+    return {m_data.data(), Size};
+}
+
+} // namespace EvoBot
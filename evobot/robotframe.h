@@ -0,0 +1,81 @@
+#ifndef EVOBOT_ROBOTFRAME_H
+#define EVOBOT_ROBOTFRAME_H
+
+#include <QByteArray>
+#include <QMetaType>
+
+#include <array>
+
+namespace EvoBot {
+
+// The 6-byte message that gets sent to the robot's 0xfff5 characteristic.
+class RobotFrame
+{
+    Q_GADGET
+    Q_PROPERTY(int header READ header WRITE setHeader FINAL)
+    Q_PROPERTY(int drive READ drive WRITE setDrive FINAL)
+    Q_PROPERTY(int claw READ claw WRITE setClaw FINAL)
+    Q_PROPERTY(int arm READ arm WRITE setArm FINAL)
+    Q_PROPERTY(int sound READ sound WRITE setSound FINAL)
+    Q_PROPERTY(int eyes READ eyes WRITE setEyes FINAL)
+
+public:
+    enum Field {
+        HeaderField,
+        DriveField,
+        ClawField,
+        ArmField,
+        SoundField,
+        EyesField,
+    };
+
+    Q_ENUM(Field)
+
+    static constexpr int Size = EyesField + 1;
+
+    constexpr RobotFrame() noexcept = default;
+    constexpr RobotFrame(char header, char drive, char claw, char arm, char sound, char eyes) noexcept
+        : m_data{{header, drive, claw, arm, sound, eyes}}
+    {}
+
+    static constexpr RobotFrame pause() noexcept { return {'X', 0x11, 0x40, 0x40, 0x00, 0x00}; }
+    static RobotFrame fromByteArray(const QByteArray &bytes, bool *ok = nullptr) noexcept;
+    QByteArray toByteArray() const;
+
+    static constexpr bool isValidOffset(int offset) noexcept { return offset >= 0 && offset < Size; }
+
+    constexpr char at(int offset) const noexcept { return m_data[static_cast<std::size_t>(offset)]; }
+    void setAt(int offset, char value) noexcept { m_data[static_cast<std::size_t>(offset)] = value; }
+
+    Q_INVOKABLE int value(int offset) const { return isValidOffset(offset) ? toInt(at(offset)) : 0; }
+
+    int header() const noexcept { return toInt(at(HeaderField)); }
+    int drive() const noexcept { return toInt(at(DriveField)); }
+    int claw() const noexcept { return toInt(at(ClawField)); }
+    int arm() const noexcept { return toInt(at(ArmField)); }
+    int sound() const noexcept { return toInt(at(SoundField)); }
+    int eyes() const noexcept { return toInt(at(EyesField)); }
+
+    void setHeader(int header) noexcept { setAt(HeaderField, static_cast<char>(header)); }
+    void setDrive(int drive) noexcept { setAt(DriveField, static_cast<char>(drive)); }
+    void setClaw(int claw) noexcept { setAt(ClawField, static_cast<char>(claw)); }
+    void setArm(int arm) noexcept { setAt(ArmField, static_cast<char>(arm)); }
+    void setSound(int sound) noexcept { setAt(SoundField, static_cast<char>(sound)); }
+    void setEyes(int eyes) noexcept { setAt(EyesField, static_cast<char>(eyes)); }
+
+    const char *constData() const noexcept { return m_data.data(); }
+
+    bool operator==(const RobotFrame &rhs) const noexcept { return m_data == rhs.m_data; }
+    bool operator!=(const RobotFrame &rhs) const noexcept { return m_data != rhs.m_data; }
+
+private:
+    static constexpr int toInt(char value) noexcept { return static_cast<signed char>(value); }
+
+    std::array<char, Size> m_data = {};
+};
+
+} // namespace EvoBot
+
+Q_DECLARE_METATYPE(EvoBot::RobotFrame)
+
+#endif // EVOBOT_ROBOTFRAME_H
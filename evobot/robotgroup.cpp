@@ -0,0 +1,316 @@
+#include "robotgroup.h"
+
+#include "actionencoding.h"
+#include "actionparser.h"
+#include "robotservice.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcRobotGroup, "evobot.robotgroup")
+
+// acknowledgements arriving later aren't considered for the skew
+const auto s_skewWindow = 1s;
+
+} // namespace
+
+class RobotGroup::Private
+{
+    struct Acknowledgement
+    {
+        RobotService *service;
+        RobotFrame frame;
+        qint64 timestamp;
+    };
+
+public:
+    explicit Private(RobotGroup *q)
+        : q{q}
+    {
+        m_skewTimer.setSingleShot(true);
+        connect(&m_skewTimer, &QTimer::timeout, q, [this] { reportSkew(); });
+    }
+
+    void addService(RobotService *service)
+    {
+        if (!service || std::find(m_services.begin(), m_services.end(), service) != m_services.end())
+            return;
+
+        m_services.push_back(service);
+
+        connect(service, &RobotService::frameWritten, q, [this, service](const auto &frame) {
+            this->onFrameWritten(service, frame);
+        });
+        connect(service, &QObject::destroyed, q, [this, service] { forget(service); });
+
+        emit q->countChanged(count());
+    }
+
+    void removeService(RobotService *service)
+    {
+        if (std::find(m_services.begin(), m_services.end(), service) != m_services.end()) {
+            service->disconnect(q);
+            forget(service);
+        }
+    }
+
+    void clear()
+    {
+        for (const auto service: m_services)
+            service->disconnect(q);
+
+        m_services.clear();
+        m_acknowledgements.clear();
+        m_skewTimer.stop();
+
+        emit q->countChanged(count());
+    }
+
+    QList<RobotService *> services() const
+    {
+        QList<RobotService *> services;
+        services.reserve(count());
+        std::copy(m_services.begin(), m_services.end(), std::back_inserter(services));
+        return services;
+    }
+
+    int count() const { return static_cast<int>(m_services.size()); }
+    int skew() const { return m_skew; }
+
+    bool apply(const ActionCommandList &commands)
+    {
+        // members sharing a firmware revision share the encoding table, which is checked once
+        std::vector<const ActionEncoding *> checkedEncodings;
+
+        for (const auto service: m_services) {
+            const auto encoding = &ActionEncoding::forFirmware(service->firmwareRevision());
+
+            if (std::find(checkedEncodings.begin(), checkedEncodings.end(), encoding) != checkedEncodings.end())
+                continue;
+
+            for (const auto &command: commands) {
+                if (command.action != 'S' && !encoding->encode(command.action, command.index)) {
+                    qCWarning(lcRobotGroup, "Could not apply unknown action %c (index=%d) for firmware revision %d",
+                              command.action, command.index, service->firmwareRevision());
+                    return false;
+                }
+            }
+
+            checkedEncodings.push_back(encoding);
+        }
+
+        reportSkew();
+
+        std::vector<RobotFrame> previousFrames;
+        previousFrames.reserve(m_services.size());
+
+        for (const auto service: m_services) {
+            previousFrames.push_back(service->currentMessage());
+            service->beginUpdate();
+        }
+
+        // members can still reject single commands, like stopping an action they don't perform
+        QList<RobotService *> rejectingServices;
+
+        for (const auto service: m_services) {
+            auto accepted = true;
+
+            for (const auto &command: commands) {
+                if (command.stop)
+                    accepted &= service->stopAction(QChar::fromLatin1(command.action), command.index);
+                else
+                    accepted &= service->startAction(QChar::fromLatin1(command.action), command.index);
+            }
+
+            if (!accepted)
+                rejectingServices.append(service);
+        }
+
+        // Only changed frames written with response get acknowledged, members whose transport
+        // really writes without response are left out of the skew. The expected frames are taken
+        // before committing, since the commits already issue the writes.
+        auto unacknowledged = 0;
+
+        for (size_t i = 0; i < m_services.size(); ++i) {
+            const auto service = m_services[i];
+
+            if (service->state() != RobotService::ConnectedState || service->currentMessage() == previousFrames[i])
+                continue;
+
+            if (service->writesWithoutResponse())
+                ++unacknowledged;
+            else
+                m_acknowledgements.push_back({service, service->currentMessage(), -1});
+        }
+
+        if (unacknowledged > 0)
+            qCDebug(lcRobotGroup, "%d of %d robots write without response and are left out of the skew", unacknowledged, count());
+
+        m_clock.start();
+
+        for (const auto service: m_services)
+            service->commit();
+
+        if (!m_acknowledgements.empty())
+            m_skewTimer.start(s_skewWindow);
+
+        if (!rejectingServices.isEmpty()) {
+            qCWarning(lcRobotGroup, "%d of %d robots rejected some of the commands", rejectingServices.size(), count());
+            emit q->commandsRejected(rejectingServices);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    void forget(RobotService *service)
+    {
+        m_services.erase(std::remove(m_services.begin(), m_services.end(), service), m_services.end());
+        m_acknowledgements.erase(std::remove_if(m_acknowledgements.begin(), m_acknowledgements.end(), [service](const auto &entry) {
+            return entry.service == service;
+        }), m_acknowledgements.end());
+
+        emit q->countChanged(count());
+    }
+
+    void onFrameWritten(RobotService *service, const RobotFrame &frame)
+    {
+        auto complete = true;
+
+        for (auto &entry: m_acknowledgements) {
+            if (entry.service == service && entry.timestamp < 0 && entry.frame == frame)
+                entry.timestamp = m_clock.nsecsElapsed();
+
+            complete = complete && entry.timestamp >= 0;
+        }
+
+        if (complete && !m_acknowledgements.empty())
+            reportSkew();
+    }
+
+    void reportSkew()
+    {
+        m_skewTimer.stop();
+
+        if (m_acknowledgements.empty())
+            return;
+
+        auto first = std::numeric_limits<qint64>::max();
+        auto last = std::numeric_limits<qint64>::min();
+        auto acknowledgements = 0;
+
+        for (const auto &entry: std::exchange(m_acknowledgements, {})) {
+            if (entry.timestamp >= 0) {
+                first = std::min(first, entry.timestamp);
+                last = std::max(last, entry.timestamp);
+                ++acknowledgements;
+            }
+        }
+
+        m_skew = (acknowledgements > 1 ? static_cast<int>((last - first) / 1000000) : -1);
+
+        qCDebug(lcRobotGroup, "%d of %d robots acknowledged, skew is %d ms", acknowledgements, count(), m_skew);
+        emit q->skewMeasured(m_skew, acknowledgements);
+    }
+
+    RobotGroup *const q;
+
+    std::vector<RobotService *> m_services;
+    std::vector<Acknowledgement> m_acknowledgements;
+    QElapsedTimer m_clock;
+    QTimer m_skewTimer;
+    int m_skew = -1;
+};
+
+RobotGroup::RobotGroup(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+RobotGroup::~RobotGroup()
+{
+    delete d;
+}
+
+void RobotGroup::addService(RobotService *service)
+{
+    d->addService(service);
+}
+
+void RobotGroup::removeService(RobotService *service)
+{
+    d->removeService(service);
+}
+
+void RobotGroup::clear()
+{
+    d->clear();
+}
+
+QList<RobotService *> RobotGroup::services() const
+{
+    return d->services();
+}
+
+int RobotGroup::count() const
+{
+    return d->count();
+}
+
+int RobotGroup::skew() const
+{
+    return d->skew();
+}
+
+bool RobotGroup::startAction(QChar action, int index)
+{
+    ActionCommand command;
+    command.action = action.toLatin1();
+    command.index = index;
+
+    return d->apply({command});
+}
+
+bool RobotGroup::stopAction(QChar action, int index)
+{
+    ActionCommand command;
+    command.action = action.toLatin1();
+    command.index = index;
+    command.stop = true;
+
+    return d->apply({command});
+}
+
+bool RobotGroup::playSound(int index)
+{
+    return startAction(QChar::fromLatin1(RobotService::PlaySoundAction), index);
+}
+
+bool RobotGroup::applyActions(const QString &actions)
+{
+    ActionCommandList commands;
+    QString errorString;
+
+    if (!parseActions(actions, &commands, &errorString)) {
+        qCWarning(lcRobotGroup, "%ls", qUtf16Printable(errorString));
+        return false;
+    }
+
+    return d->apply(commands);
+}
+
+} // namespace EvoBot
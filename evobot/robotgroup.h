@@ -0,0 +1,59 @@
+#ifndef EVOBOT_ROBOTGROUP_H
+#define EVOBOT_ROBOTGROUP_H
+
+#include <QObject>
+
+namespace EvoBot {
+
+class RobotService;
+
+// Sends the same actions to several robots. Commands are validated once per firmware revision
+// of the members, applied to every member within one update, and then committed back to back,
+// so that all writes are issued in the same scheduler pass. The spread between the members'
+// acknowledgements of a command is reported as its skew. Members whose transport really writes
+// without response don't acknowledge, and are left out of the skew.
+class RobotGroup : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(int skew READ skew NOTIFY skewMeasured FINAL)
+
+public:
+    explicit RobotGroup(QObject *parent = {});
+    ~RobotGroup() override;
+
+    // The group doesn't take ownership of its members.
+    void addService(RobotService *service);
+    void removeService(RobotService *service);
+    void clear();
+
+    QList<RobotService *> services() const;
+    int count() const;
+
+    // The skew of the last command in milliseconds, or -1 if less than two members acknowledged it.
+    int skew() const;
+
+public slots:
+    // Nothing is applied if some member's firmware cannot encode the commands. Otherwise all
+    // members get them; false is returned, and commandsRejected() emitted, if some members
+    // rejected commands. Firmware dependent actions held back by a member count as accepted.
+    bool startAction(QChar action, int index = 0);
+    bool stopAction(QChar action, int index = 0);
+    bool playSound(int index);
+
+    // Applies a list of actions like "F2 O V5 -F2" to all members, see parseActions().
+    bool applyActions(const QString &actions);
+
+signals:
+    void countChanged(int count);
+    void skewMeasured(int skew, int acknowledgements);
+    void commandsRejected(const QList<EvoBot::RobotService *> &services);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ROBOTGROUP_H
@@ -0,0 +1,327 @@
+#include "robotmetrics.h"
+
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include <QTimer>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <limits>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::array<int, 9> s_latencyBuckets = {{5, 10, 20, 50, 100, 200, 500, 1000, std::numeric_limits<int>::max()}};
+const auto s_defaultUpdateInterval = 1000ms;
+
+} // namespace
+
+class RobotMetrics::Private
+{
+public:
+    explicit Private(RobotMetrics *q)
+        : q{q}
+    {
+        m_updateTimer.setInterval(s_defaultUpdateInterval);
+        connect(&m_updateTimer, &QTimer::timeout, q, [this] { onUpdateTimeout(); });
+    }
+
+    void recordWriteIssued(TransmitScheduler::Reason reason)
+    {
+        ++m_writesIssued;
+
+        if (reason == TransmitScheduler::KeepAlive)
+            ++m_keepAliveWrites;
+        else
+            ++m_changeWrites;
+
+        m_writeTimer.start();
+    }
+
+    void recordWriteAcknowledged()
+    {
+        ++m_writesAcknowledged;
+
+        if (!m_writeTimer.isValid())
+            return;
+
+        const auto latency = static_cast<int>(m_writeTimer.elapsed());
+        m_writeTimer.invalidate();
+
+        m_minimumLatency = std::min(m_minimumLatency, latency);
+        m_maximumLatency = std::max(m_maximumLatency, latency);
+        m_totalLatency += latency;
+        ++m_latencySamples;
+
+        const auto bucket = std::upper_bound(s_latencyBuckets.begin(), s_latencyBuckets.end() - 1, latency);
+        ++m_latencyHistogram[static_cast<size_t>(bucket - s_latencyBuckets.begin())];
+    }
+
+    void recordWriteLost()
+    {
+        ++m_writesLost;
+        m_writeTimer.invalidate();
+    }
+
+    void recordCoalescedFrame() { ++m_coalescedFrames; }
+    void recordNotification() { ++m_notificationsReceived; }
+    void recordConnected() { ++m_connectCount; }
+
+    int writesIssued() const { return m_writesIssued; }
+    int writesAcknowledged() const { return m_writesAcknowledged; }
+    int writesLost() const { return m_writesLost; }
+    int changeWrites() const { return m_changeWrites; }
+    int keepAliveWrites() const { return m_keepAliveWrites; }
+    int coalescedFrames() const { return m_coalescedFrames; }
+    int notificationsReceived() const { return m_notificationsReceived; }
+    int connectCount() const { return m_connectCount; }
+
+    double notificationRate() const { return m_notificationRate; }
+
+    int minimumLatency() const { return m_latencySamples ? m_minimumLatency : 0; }
+    int maximumLatency() const { return m_maximumLatency; }
+    double averageLatency() const { return m_latencySamples ? static_cast<double>(m_totalLatency) / m_latencySamples : 0.0; }
+
+    QList<int> latencyHistogram() const
+    {
+        QList<int> histogram;
+        histogram.reserve(static_cast<int>(m_latencyHistogram.size()));
+        std::copy(m_latencyHistogram.begin(), m_latencyHistogram.end(), std::back_inserter(histogram));
+        return histogram;
+    }
+
+    void setUpdateInterval(std::chrono::milliseconds updateInterval)
+    {
+        if (std::chrono::milliseconds{m_updateTimer.interval()} != updateInterval) {
+            m_updateTimer.setInterval(updateInterval);
+            emit q->updateIntervalChanged(m_updateTimer.interval());
+        }
+    }
+
+    int updateInterval() const { return m_updateTimer.interval(); }
+
+    void reset()
+    {
+        m_writesIssued = 0;
+        m_writesAcknowledged = 0;
+        m_writesLost = 0;
+        m_changeWrites = 0;
+        m_keepAliveWrites = 0;
+        m_coalescedFrames = 0;
+        m_notificationsReceived = 0;
+        m_connectCount = 0;
+
+        m_minimumLatency = std::numeric_limits<int>::max();
+        m_maximumLatency = 0;
+        m_totalLatency = 0;
+        m_latencySamples = 0;
+        m_latencyHistogram.fill(0);
+        m_writeTimer.invalidate();
+
+        m_notificationRate = 0;
+        m_rateNotifications = 0;
+        m_rateTimer.invalidate();
+
+        emit q->updated();
+    }
+
+    void observersChanged()
+    {
+        if (q->isSignalConnected(QMetaMethod::fromSignal(&RobotMetrics::updated))) {
+            if (!m_updateTimer.isActive()) {
+                m_rateNotifications = m_notificationsReceived;
+                m_rateTimer.start();
+                m_updateTimer.start();
+            }
+        } else {
+            m_updateTimer.stop();
+        }
+    }
+
+private:
+    void onUpdateTimeout()
+    {
+        const auto elapsed = m_rateTimer.restart();
+
+        if (elapsed > 0)
+            m_notificationRate = 1000.0 * (m_notificationsReceived - m_rateNotifications) / elapsed;
+
+        m_rateNotifications = m_notificationsReceived;
+        emit q->updated();
+    }
+
+    RobotMetrics *const q;
+
+    int m_writesIssued = 0;
+    int m_writesAcknowledged = 0;
+    int m_writesLost = 0;
+    int m_changeWrites = 0;
+    int m_keepAliveWrites = 0;
+    int m_coalescedFrames = 0;
+    int m_notificationsReceived = 0;
+    int m_connectCount = 0;
+
+    int m_minimumLatency = std::numeric_limits<int>::max();
+    int m_maximumLatency = 0;
+    qint64 m_totalLatency = 0;
+    int m_latencySamples = 0;
+    std::array<int, s_latencyBuckets.size()> m_latencyHistogram = {};
+    QElapsedTimer m_writeTimer;
+
+    double m_notificationRate = 0;
+    int m_rateNotifications = 0;
+    QElapsedTimer m_rateTimer;
+    QTimer m_updateTimer;
+};
+
+RobotMetrics::RobotMetrics(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+RobotMetrics::~RobotMetrics()
+{
+    delete d;
+}
+
+void RobotMetrics::recordWriteIssued(TransmitScheduler::Reason reason)
+{
+    d->recordWriteIssued(reason);
+}
+
+void RobotMetrics::recordWriteAcknowledged()
+{
+    d->recordWriteAcknowledged();
+}
+
+void RobotMetrics::recordWriteLost()
+{
+    d->recordWriteLost();
+}
+
+void RobotMetrics::recordCoalescedFrame()
+{
+    d->recordCoalescedFrame();
+}
+
+void RobotMetrics::recordNotification()
+{
+    d->recordNotification();
+}
+
+void RobotMetrics::recordConnected()
+{
+    d->recordConnected();
+}
+
+int RobotMetrics::writesIssued() const
+{
+    return d->writesIssued();
+}
+
+int RobotMetrics::writesAcknowledged() const
+{
+    return d->writesAcknowledged();
+}
+
+int RobotMetrics::writesLost() const
+{
+    return d->writesLost();
+}
+
+int RobotMetrics::changeWrites() const
+{
+    return d->changeWrites();
+}
+
+int RobotMetrics::keepAliveWrites() const
+{
+    return d->keepAliveWrites();
+}
+
+int RobotMetrics::coalescedFrames() const
+{
+    return d->coalescedFrames();
+}
+
+int RobotMetrics::notificationsReceived() const
+{
+    return d->notificationsReceived();
+}
+
+int RobotMetrics::connectCount() const
+{
+    return d->connectCount();
+}
+
+int RobotMetrics::reconnectCount() const
+{
+    return qMax(0, d->connectCount() - 1);
+}
+
+double RobotMetrics::notificationRate() const
+{
+    return d->notificationRate();
+}
+
+int RobotMetrics::minimumLatency() const
+{
+    return d->minimumLatency();
+}
+
+int RobotMetrics::maximumLatency() const
+{
+    return d->maximumLatency();
+}
+
+double RobotMetrics::averageLatency() const
+{
+    return d->averageLatency();
+}
+
+QList<int> RobotMetrics::latencyHistogram() const
+{
+    return d->latencyHistogram();
+}
+
+QList<int> RobotMetrics::latencyBuckets()
+{
+    QList<int> buckets;
+    buckets.reserve(static_cast<int>(s_latencyBuckets.size()) - 1);
+    std::copy(s_latencyBuckets.begin(), s_latencyBuckets.end() - 1, std::back_inserter(buckets));
+    return buckets;
+}
+
+void RobotMetrics::setUpdateInterval(int updateInterval)
+{
+    d->setUpdateInterval(std::chrono::milliseconds{qMax(1, updateInterval)});
+}
+
+int RobotMetrics::updateInterval() const
+{
+    return d->updateInterval();
+}
+
+void RobotMetrics::reset()
+{
+    d->reset();
+}
+
+void RobotMetrics::connectNotify(const QMetaMethod &signal)
+{
+    QObject::connectNotify(signal);
+    d->observersChanged();
+}
+
+void RobotMetrics::disconnectNotify(const QMetaMethod &signal)
+{
+    QObject::disconnectNotify(signal);
+    d->observersChanged();
+}
+
+} // namespace EvoBot
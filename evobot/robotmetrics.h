@@ -0,0 +1,87 @@
+#ifndef EVOBOT_ROBOTMETRICS_H
+#define EVOBOT_ROBOTMETRICS_H
+
+#include "transmitscheduler.h"
+
+#include <QObject>
+
+namespace EvoBot {
+
+// Counters describing the performance of a robot's control link. Recording is a few
+// integer operations; the updated() signal is only emitted while someone listens to it.
+class RobotMetrics : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int writesIssued READ writesIssued NOTIFY updated FINAL)
+    Q_PROPERTY(int writesAcknowledged READ writesAcknowledged NOTIFY updated FINAL)
+    Q_PROPERTY(int writesLost READ writesLost NOTIFY updated FINAL)
+    Q_PROPERTY(int changeWrites READ changeWrites NOTIFY updated FINAL)
+    Q_PROPERTY(int keepAliveWrites READ keepAliveWrites NOTIFY updated FINAL)
+    Q_PROPERTY(int coalescedFrames READ coalescedFrames NOTIFY updated FINAL)
+    Q_PROPERTY(int notificationsReceived READ notificationsReceived NOTIFY updated FINAL)
+    Q_PROPERTY(double notificationRate READ notificationRate NOTIFY updated FINAL)
+    Q_PROPERTY(int connectCount READ connectCount NOTIFY updated FINAL)
+    Q_PROPERTY(int reconnectCount READ reconnectCount NOTIFY updated FINAL)
+    Q_PROPERTY(int minimumLatency READ minimumLatency NOTIFY updated FINAL)
+    Q_PROPERTY(int maximumLatency READ maximumLatency NOTIFY updated FINAL)
+    Q_PROPERTY(double averageLatency READ averageLatency NOTIFY updated FINAL)
+    Q_PROPERTY(QList<int> latencyHistogram READ latencyHistogram NOTIFY updated FINAL)
+    Q_PROPERTY(QList<int> latencyBuckets READ latencyBuckets CONSTANT FINAL)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged FINAL)
+
+public:
+    explicit RobotMetrics(QObject *parent = {});
+    ~RobotMetrics() override;
+
+    void recordWriteIssued(TransmitScheduler::Reason reason);
+    void recordWriteAcknowledged();
+    void recordWriteLost();
+    void recordCoalescedFrame();
+    void recordNotification();
+    void recordConnected();
+
+    int writesIssued() const;
+    int writesAcknowledged() const;
+    int writesLost() const;
+    int changeWrites() const;
+    int keepAliveWrites() const;
+    int coalescedFrames() const;
+    int notificationsReceived() const;
+    int connectCount() const;
+    int reconnectCount() const;
+
+    // The notification rate in Hz, as measured over the last update interval.
+    double notificationRate() const;
+
+    // Latency between issuing a write and its acknowledgement, in milliseconds.
+    int minimumLatency() const;
+    int maximumLatency() const;
+    double averageLatency() const;
+
+    // Number of acknowledged writes per latency bucket. Each bucket counts the latencies
+    // below the matching upper bound in latencyBuckets(), the last bucket has no bound.
+    QList<int> latencyHistogram() const;
+    static QList<int> latencyBuckets();
+
+    void setUpdateInterval(int updateInterval);
+    int updateInterval() const;
+
+public slots:
+    void reset();
+
+signals:
+    void updated();
+    void updateIntervalChanged(int updateInterval);
+
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ROBOTMETRICS_H
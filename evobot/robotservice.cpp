@@ -0,0 +1,1005 @@
+#include "robotservice.h"
+
+#include "actionencoding.h"
+#include "actionparser.h"
+#include "bluetoothtransport.h"
+#include "eventsink.h"
+#include "notificationdecoder.h"
+#include "robotmetrics.h"
+#include "robottransport.h"
+#include "sessionrecorder.h"
+#include "transmitscheduler.h"
+#include "utilities.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcRobotService, "evobot.robotservice", QtInfoMsg)
+
+constexpr auto s_pauseMessage = RobotFrame::pause();
+
+const auto s_driveLevels = 4;
+const auto s_driveDeadZone = 0.15;
+const auto s_driveLevelHysteresis = 0.15;
+const auto s_driveAxisHysteresis = 0.25;
+
+// the per-field change signals, in the order of RobotFrame::Field
+using FieldSignal = void (RobotService::*)(int);
+
+const FieldSignal s_fieldSignals[RobotFrame::Size] = {
+    &RobotService::headerChanged,
+    &RobotService::driveChanged,
+    &RobotService::clawChanged,
+    &RobotService::armChanged,
+    &RobotService::soundChanged,
+    &RobotService::eyesChanged,
+};
+
+// the transmit priority of changes to each field, in the order of RobotFrame::Field
+const TransmitScheduler::Priority s_fieldPriorities[RobotFrame::Size] = {
+    TransmitScheduler::MotionPriority,
+    TransmitScheduler::MotionPriority,
+    TransmitScheduler::ActuatorPriority,
+    TransmitScheduler::ActuatorPriority,
+    TransmitScheduler::CosmeticPriority,
+    TransmitScheduler::CosmeticPriority,
+};
+
+// Classifies a change by the most urgent field it touches. Motion
+// and actuator fields returning to their pause value are stops.
+TransmitScheduler::Priority changePriority(const RobotFrame &message, const RobotFrame &previousMessage)
+{
+    auto priority = TransmitScheduler::CosmeticPriority;
+
+    for (auto field = 0; field < RobotFrame::Size; ++field) {
+        if (message.at(field) == previousMessage.at(field))
+            continue;
+
+        if (s_fieldPriorities[field] != TransmitScheduler::CosmeticPriority
+                && message.at(field) == s_pauseMessage.at(field))
+            return TransmitScheduler::StopPriority;
+
+        priority = std::min(priority, s_fieldPriorities[field]);
+    }
+
+    return priority;
+}
+
+// the robot ids of events, numbering the services in order of creation
+std::atomic<quint16> s_nextRobotId{0};
+
+// packs the frame into the value of an event, the first byte becoming the lowest
+quint64 eventValue(const RobotFrame &frame)
+{
+    auto value = quint64{0};
+
+    for (auto field = RobotFrame::Size - 1; field >= 0; --field)
+        value = (value << 8) | static_cast<uchar>(frame.at(field));
+
+    return value;
+}
+
+// how long firmware dependent actions wait for the firmware revision
+const auto s_firmwareTimeout = 5000;
+const auto s_maximumHeldBackActions = 64;
+
+struct DriveCommand
+{
+    char action = 0;
+    int level = 0;
+
+    bool operator==(const DriveCommand &rhs) const { return action == rhs.action && level == rhs.level; }
+    bool operator!=(const DriveCommand &rhs) const { return !operator==(rhs); }
+};
+
+// Quantizes the stick position, only leaving the current command when clearly moving away from it.
+DriveCommand driveCommand(qreal x, qreal y, const DriveCommand &current)
+{
+    const auto magnitude = qMin(qreal{1}, std::hypot(x, y));
+    const auto deadZone = s_driveDeadZone + (current.action ? 0 : s_driveLevelHysteresis / s_driveLevels);
+
+    if (magnitude < deadZone)
+        return {};
+
+    const auto currentIsVertical = (current.action == 'F' || current.action == 'B');
+    const auto currentIsHorizontal = (current.action == 'L' || current.action == 'R');
+
+    auto vertical = std::abs(y) >= std::abs(x);
+
+    if (currentIsVertical)
+        vertical = std::abs(x) <= std::abs(y) * (1 + s_driveAxisHysteresis);
+    else if (currentIsHorizontal)
+        vertical = std::abs(y) > std::abs(x) * (1 + s_driveAxisHysteresis);
+
+    const auto action = vertical ? (y >= 0 ? 'F' : 'B') : (x >= 0 ? 'R' : 'L');
+    const auto level = (magnitude - s_driveDeadZone) / (1 - s_driveDeadZone) * s_driveLevels;
+
+    if (action == current.action && std::abs(level - (current.level + qreal{0.5})) < 0.5 + s_driveLevelHysteresis)
+        return current;
+
+    return {action, qBound(0, static_cast<int>(level), s_driveLevels - 1)};
+}
+
+} // namespace
+
+class RobotService::Private
+{
+public:
+    explicit Private(RobotService *q);
+
+    bool attach(QLowEnergyController *central);
+    bool attach(RobotTransport *transport);
+    RobotTransport *transport() const { return m_transport; }
+
+    void setCurrentMessage(int offset, char value);
+    void setCurrentMessage(const RobotFrame &message);
+    void setCurrentMessage(const RobotFrame &message, bool audioLoop);
+    void resetCurrentMessage(const RobotFrame &message);
+    RobotFrame currentMessage() const { return m_message; }
+    int currentSound() const { return m_currentSound; }
+    State state() const;
+
+    void setFirmwareRevision(int firmwareRevision);
+    int firmwareRevision() const { return m_firmwareRevision; }
+    Layout layout() const;
+
+    void setTransmitScheduler(TransmitScheduler *scheduler);
+    TransmitScheduler *transmitScheduler() const { return m_scheduler; }
+
+    void setWriteWithoutResponse(bool writeWithoutResponse);
+    bool writeWithoutResponse() const { return m_writeWithoutResponse; }
+
+    RobotMetrics *metrics() { return &m_metrics; }
+
+    void setRecorder(SessionRecorder *recorder) { m_recorder = recorder; }
+    SessionRecorder *recorder() const { return m_recorder; }
+
+    bool startAction(char action, int index);
+    bool stopAction(char action, int index);
+    bool isActionActive(char action, int index) const;
+
+    void beginUpdate();
+    void commit();
+    bool applyActions(const QString &actions);
+    bool encodeActions(const ActionCommandList &commands, RobotFrame *frame) const;
+
+    void setDriveVector(qreal x, qreal y);
+
+private:
+    bool holdBack(char action, int index, bool stop);
+    void releaseHeldBackActions();
+
+    bool writesWithoutResponse() const;
+    void transmitMessage(TransmitScheduler::Reason reason);
+    void messageChanged(const RobotFrame &previousMessage);
+    void emitChanges(const RobotFrame &previousMessage);
+    void consumeEyesPulse(const RobotFrame &writtenFrame);
+
+    void onTransportStateChanged(State newState, State oldState);
+    void onNotificationReceived(const QByteArray &value);
+    void onFrameWritten(const RobotFrame &frame);
+    void onTransmitRequested(TransmitScheduler::Reason reason);
+    void applyDriveCommand();
+
+    RobotService *const q;
+    const quint16 m_robotId = s_nextRobotId++;
+
+    RobotTransport *m_transport = {};
+    int m_firmwareRevision = -1;
+    const ActionEncoding *m_encoding = &ActionEncoding::forFirmware(-1);
+    int m_currentSound = 0;
+
+    RobotFrame m_message = s_pauseMessage;
+    RobotFrame m_messageBeforeUpdate;
+    int m_updateDepth = 0;
+    bool m_audioLoop = false;
+    TransmitScheduler *m_scheduler = {};
+    bool m_writeWithoutResponse = false;
+    QTimer m_coalescingTimer;
+    TransmitScheduler::Reason m_coalescedReason = TransmitScheduler::KeepAlive;
+    bool m_unsentChange = false;
+
+    RobotMetrics m_metrics;
+    QPointer<SessionRecorder> m_recorder;
+
+    DriveCommand m_driveCommand;
+    DriveCommand m_pendingDriveCommand;
+    QElapsedTimer m_driveClock;
+    QTimer m_driveTimer;
+
+    QTimer m_firmwareTimer;
+    ActionCommandList m_heldBackActions;
+};
+
+RobotService::RobotService(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+RobotService::~RobotService()
+{
+    delete d;
+}
+
+bool RobotService::attach(QLowEnergyController *central)
+{
+    return d->attach(central);
+}
+
+bool RobotService::attach(RobotTransport *transport)
+{
+    return d->attach(transport);
+}
+
+RobotTransport *RobotService::transport() const
+{
+    return d->transport();
+}
+
+void RobotService::setCurrentMessage(const RobotFrame &message)
+{
+    d->setCurrentMessage(message);
+}
+
+void RobotService::setCurrentMessage(const RobotFrame &message, bool audioLoop)
+{
+    d->setCurrentMessage(message, audioLoop);
+}
+
+void RobotService::resetCurrentMessage(const RobotFrame &message)
+{
+    d->resetCurrentMessage(message);
+}
+
+RobotFrame RobotService::currentMessage() const
+{
+    return d->currentMessage();
+}
+
+void RobotService::setHeader(int header)
+{
+    d->setCurrentMessage(RobotFrame::HeaderField, static_cast<char>(header));
+}
+
+int RobotService::header() const
+{
+    return d->currentMessage().header();
+}
+
+void RobotService::setDrive(int drive)
+{
+    d->setCurrentMessage(RobotFrame::DriveField, static_cast<char>(drive));
+}
+
+int RobotService::drive() const
+{
+    return d->currentMessage().drive();
+}
+
+void RobotService::setClaw(int claw)
+{
+    d->setCurrentMessage(RobotFrame::ClawField, static_cast<char>(claw));
+}
+
+int RobotService::claw() const
+{
+    return d->currentMessage().claw();
+}
+
+void RobotService::setArm(int arm)
+{
+    d->setCurrentMessage(RobotFrame::ArmField, static_cast<char>(arm));
+}
+
+int RobotService::arm() const
+{
+    return d->currentMessage().arm();
+}
+
+void RobotService::setSound(int sound)
+{
+    d->setCurrentMessage(RobotFrame::SoundField, static_cast<char>(sound));
+}
+
+int RobotService::sound() const
+{
+    return d->currentMessage().sound();
+}
+
+void RobotService::setEyes(int eyes)
+{
+    d->setCurrentMessage(RobotFrame::EyesField, static_cast<char>(eyes));
+}
+
+int RobotService::eyes() const
+{
+    return d->currentMessage().eyes();
+}
+
+int RobotService::currentSound() const
+{
+    return d->currentSound();
+}
+
+RobotService::State RobotService::state() const
+{
+    return d->state();
+}
+
+void RobotService::setFirmwareRevision(int firmwareRevision)
+{
+    d->setFirmwareRevision(firmwareRevision);
+}
+
+int RobotService::firmwareRevision() const
+{
+    return d->firmwareRevision();
+}
+
+RobotService::Layout RobotService::layout() const
+{
+    return d->layout();
+}
+
+void RobotService::setTransmitScheduler(TransmitScheduler *scheduler)
+{
+    d->setTransmitScheduler(scheduler);
+}
+
+TransmitScheduler *RobotService::transmitScheduler() const
+{
+    return d->transmitScheduler();
+}
+
+int RobotService::transmitInterval() const
+{
+    return d->transmitScheduler()->interval();
+}
+
+void RobotService::setWriteWithoutResponse(bool writeWithoutResponse)
+{
+    d->setWriteWithoutResponse(writeWithoutResponse);
+}
+
+bool RobotService::writeWithoutResponse() const
+{
+    return d->writeWithoutResponse();
+}
+
+bool RobotService::writesWithoutResponse() const
+{
+    return d->writesWithoutResponse();
+}
+
+RobotMetrics *RobotService::metrics() const
+{
+    return d->metrics();
+}
+
+void RobotService::setRecorder(SessionRecorder *recorder)
+{
+    d->setRecorder(recorder);
+}
+
+SessionRecorder *RobotService::recorder() const
+{
+    return d->recorder();
+}
+
+bool RobotService::startAction(QChar action, int index)
+{
+    return d->startAction(action.toLatin1(), index);
+}
+
+bool RobotService::stopAction(QChar action, int index)
+{
+    return d->stopAction(action.toLatin1(), index);
+}
+
+bool RobotService::isActionActive(QChar action, int index) const
+{
+    return d->isActionActive(action.toLatin1(), index);
+}
+
+bool RobotService::isActionActive(Action action, int index) const
+{
+    return d->isActionActive(static_cast<char>(action), index);
+}
+
+bool RobotService::startAction(Action action, int index)
+{
+    return d->startAction(static_cast<char>(action), index);
+}
+
+bool RobotService::stopAction(Action action, int index)
+{
+    return d->stopAction(static_cast<char>(action), index);
+}
+
+bool RobotService::playSound(int index)
+{
+    return startAction(PlaySoundAction, index);
+}
+
+bool RobotService::playLoop(int index)
+{
+    return startAction(PlayLoopAction, index);
+}
+
+void RobotService::beginUpdate()
+{
+    d->beginUpdate();
+}
+
+void RobotService::commit()
+{
+    d->commit();
+}
+
+bool RobotService::applyActions(const QString &actions)
+{
+    return d->applyActions(actions);
+}
+
+bool RobotService::encodeActions(const ActionCommandList &commands, RobotFrame *frame) const
+{
+    return d->encodeActions(commands, frame);
+}
+
+void RobotService::setDriveVector(qreal x, qreal y)
+{
+    d->setDriveVector(x, y);
+}
+
+RobotService::Private::Private(RobotService *q)
+    : q{q}
+{
+    m_coalescingTimer.setSingleShot(true);
+    m_coalescingTimer.setInterval(0);
+    connect(&m_coalescingTimer, &QTimer::timeout, q, [this] {
+        transmitMessage(std::exchange(m_coalescedReason, TransmitScheduler::KeepAlive));
+    });
+
+    m_driveTimer.setSingleShot(true);
+    connect(&m_driveTimer, &QTimer::timeout, q, [this] { applyDriveCommand(); });
+
+    m_firmwareTimer.setSingleShot(true);
+    m_firmwareTimer.setInterval(s_firmwareTimeout);
+    connect(&m_firmwareTimer, &QTimer::timeout, q, [this] {
+        qCWarning(lcRobotService, "Firmware revision still unknown, assuming the current firmware");
+        releaseHeldBackActions();
+    });
+
+    setTransmitScheduler(new TransmitScheduler{q});
+}
+
+bool RobotService::Private::attach(QLowEnergyController *central)
+{
+    if (state() == ConnectedState) {
+        qCWarning(lcRobotService, "Connected already");
+        return false;
+    }
+
+    auto transport = std::make_unique<BluetoothTransport>();
+
+    if (!transport->attach(central))
+        return false;
+
+    return attach(transport.release());
+}
+
+bool RobotService::Private::attach(RobotTransport *transport)
+{
+    if (!transport || transport == m_transport)
+        return false;
+
+    if (state() == ConnectedState) {
+        qCWarning(lcRobotService, "Connected already");
+        return false;
+    }
+
+    const auto oldState = state();
+
+    if (auto oldTransport = std::exchange(m_transport, transport)) {
+        oldTransport->disconnect(q);
+        oldTransport->deleteLater();
+    }
+
+    m_transport->setParent(q);
+
+    connect(m_transport, &RobotTransport::stateChanged, q, [this](int newState, int oldState) {
+        this->onTransportStateChanged(static_cast<State>(newState), static_cast<State>(oldState));
+    });
+
+    connect(m_transport, &RobotTransport::firmwareRevisionChanged,
+            q, [this](auto revision) { this->setFirmwareRevision(revision); });
+    connect(m_transport, &RobotTransport::notificationReceived,
+            q, [this](const auto &value) { this->onNotificationReceived(value); });
+    connect(m_transport, &RobotTransport::frameWritten, q, [this](const auto &frame) { this->onFrameWritten(frame); });
+
+    if (m_transport->firmwareRevision() > 0)
+        setFirmwareRevision(m_transport->firmwareRevision());
+
+    // transmission starts before the device information is read, only
+    // actions depending on the firmware revision have to wait for it
+    if (m_firmwareRevision <= 0)
+        m_firmwareTimer.start();
+
+    // the transport might have been connected already
+    onTransportStateChanged(state(), oldState);
+
+    return true;
+}
+
+void RobotService::Private::setFirmwareRevision(int firmwareRevision)
+{
+    if (std::exchange(m_firmwareRevision, firmwareRevision) != firmwareRevision) {
+        m_encoding = &ActionEncoding::forFirmware(m_firmwareRevision);
+        postEvent(EventSink::FirmwareRevisionChanged, m_robotId, m_firmwareRevision);
+        emit q->firmwareRevisionChanged(m_firmwareRevision);
+    }
+
+    if (m_firmwareRevision > 0 && m_firmwareTimer.isActive())
+        releaseHeldBackActions();
+}
+
+// Encoding such actions with a guessed revision could show wrong eye colors.
+bool RobotService::Private::holdBack(char action, int index, bool stop)
+{
+    if (!m_firmwareTimer.isActive() || !ActionEncoding::dependsOnFirmware(action, index))
+        return false;
+
+    if (m_heldBackActions.size() >= s_maximumHeldBackActions)
+        m_heldBackActions.erase(m_heldBackActions.begin());
+
+    qCInfo(lcRobotService, "Holding back %c action (index=%d) until the firmware revision is known", action, index);
+
+    ActionCommand command;
+    command.action = action;
+    command.index = index;
+    command.stop = stop;
+
+    m_heldBackActions.push_back(command);
+    return true;
+}
+
+void RobotService::Private::releaseHeldBackActions()
+{
+    m_firmwareTimer.stop();
+
+    const auto commands = std::exchange(m_heldBackActions, {});
+
+    if (commands.empty())
+        return;
+
+    beginUpdate();
+
+    for (const auto &command: commands) {
+        if (command.stop)
+            stopAction(command.action, command.index);
+        else
+            startAction(command.action, command.index);
+    }
+
+    commit();
+}
+
+RobotService::Layout RobotService::Private::layout() const
+{
+    return m_transport ? m_transport->layout() : Layout{};
+}
+
+void RobotService::Private::setCurrentMessage(int offset, char value)
+{
+    if (RobotFrame::isValidOffset(offset) && m_message.at(offset) != value) {
+        const auto previousMessage = m_message;
+        m_message.setAt(offset, value);
+        messageChanged(previousMessage);
+    }
+}
+
+void RobotService::Private::setCurrentMessage(const RobotFrame &message)
+{
+    if (message != m_message) {
+        messageChanged(std::exchange(m_message, message));
+    }
+}
+
+void RobotService::Private::setCurrentMessage(const RobotFrame &message, bool audioLoop)
+{
+    m_audioLoop = audioLoop;
+    setCurrentMessage(message);
+}
+
+void RobotService::Private::resetCurrentMessage(const RobotFrame &message)
+{
+    if (message != m_message) {
+        const auto previousMessage = std::exchange(m_message, message);
+        m_scheduler->setPaused(m_message == s_pauseMessage);
+        emitChanges(previousMessage);
+    }
+}
+
+void RobotService::Private::messageChanged(const RobotFrame &previousMessage)
+{
+    if (m_updateDepth == 0) {
+        emitChanges(previousMessage);
+
+        if (m_scheduler->isActive() && std::exchange(m_unsentChange, true))
+            m_metrics.recordCoalescedFrame();
+
+        m_scheduler->setPaused(m_message == s_pauseMessage);
+        m_scheduler->messageChanged(changePriority(m_message, previousMessage));
+    }
+}
+
+void RobotService::Private::beginUpdate()
+{
+    if (m_updateDepth++ == 0)
+        m_messageBeforeUpdate = m_message;
+}
+
+void RobotService::Private::commit()
+{
+    if (m_updateDepth == 0) {
+        qCWarning(lcRobotService, "Commit without matching beginUpdate()");
+        return;
+    }
+
+    if (--m_updateDepth == 0 && m_message != m_messageBeforeUpdate)
+        messageChanged(m_messageBeforeUpdate);
+}
+
+bool RobotService::Private::applyActions(const QString &actions)
+{
+    ActionCommandList commands;
+    QString errorString;
+
+    if (!parseActions(actions, &commands, &errorString)) {
+        qCWarning(lcRobotService, "%ls", qUtf16Printable(errorString));
+        return false;
+    }
+
+    for (const auto &command: commands) {
+        if (command.action != 'S' && !m_encoding->encode(command.action, command.index)) {
+            qCWarning(lcRobotService, "Could not apply unknown action %c in `%ls'",
+                      command.action, qUtf16Printable(actions));
+            return false;
+        }
+    }
+
+    beginUpdate();
+
+    for (const auto &command: commands) {
+        if (command.stop)
+            stopAction(command.action, command.index);
+        else
+            startAction(command.action, command.index);
+    }
+
+    commit();
+    return true;
+}
+
+bool RobotService::Private::encodeActions(const ActionCommandList &commands, RobotFrame *frame) const
+{
+    for (const auto &command: commands) {
+        if (command.action == 'S') {
+            if (!command.stop)
+                *frame = s_pauseMessage;
+
+            continue;
+        }
+
+        const auto fragment = m_encoding->encode(command.action, command.index);
+
+        if (!fragment) {
+            qCWarning(lcRobotService, "Could not encode unknown action %c (index=%d)", command.action, command.index);
+            return false;
+        }
+
+        if (!command.stop)
+            frame->setAt(fragment.offset, fragment.value);
+        else if (frame->at(fragment.offset) == fragment.value)
+            frame->setAt(fragment.offset, s_pauseMessage.at(fragment.offset));
+    }
+
+    return true;
+}
+
+void RobotService::Private::setDriveVector(qreal x, qreal y)
+{
+    m_pendingDriveCommand = driveCommand(x, y, m_pendingDriveCommand);
+
+    if (m_pendingDriveCommand == m_driveCommand) {
+        m_driveTimer.stop();
+        return;
+    }
+
+    if (m_driveTimer.isActive())
+        return;
+
+    // don't produce changes faster than the link can confirm them
+    const auto interval = m_scheduler->effectiveMinimumInterval();
+    const auto elapsed = m_driveClock.isValid() ? m_driveClock.elapsed() : interval;
+
+    if (elapsed >= interval)
+        applyDriveCommand();
+    else
+        m_driveTimer.start(static_cast<int>(interval - elapsed));
+}
+
+void RobotService::Private::applyDriveCommand()
+{
+    m_driveCommand = m_pendingDriveCommand;
+    m_driveClock.start();
+
+    if (m_driveCommand.action) {
+        const auto fragment = m_encoding->encode(m_driveCommand.action, m_driveCommand.level);
+        setCurrentMessage(fragment.offset, fragment.value);
+    } else {
+        setCurrentMessage(RobotFrame::DriveField, s_pauseMessage.at(RobotFrame::DriveField));
+    }
+}
+
+void RobotService::Private::emitChanges(const RobotFrame &previousMessage)
+{
+    auto changed = false;
+
+    for (auto field = 0; field < RobotFrame::Size; ++field) {
+        if (m_message.at(field) != previousMessage.at(field)) {
+            emit (q->*s_fieldSignals[field])(m_message.value(field));
+            changed = true;
+        }
+    }
+
+    if (changed)
+        emit q->currentMessageChanged(m_message);
+}
+
+// The eyes field triggers a one-shot animation. Once a frame carrying it has been written
+// it gets cleared, so that keep-alives don't repeat the animation. Clearing the field is
+// no change that needs transmitting, and a newer eyes value still waiting for its write
+// is kept. Inside an update the pulse is left for the next write.
+void RobotService::Private::consumeEyesPulse(const RobotFrame &writtenFrame)
+{
+    if (m_updateDepth > 0 || m_message.eyes() == 0 || writtenFrame.eyes() != m_message.eyes())
+        return;
+
+    const auto previousMessage = m_message;
+    m_message.setEyes(0);
+    m_scheduler->setPaused(m_message == s_pauseMessage);
+    emitChanges(previousMessage);
+}
+
+void RobotService::Private::setTransmitScheduler(TransmitScheduler *scheduler)
+{
+    if (!scheduler || scheduler == m_scheduler)
+        return;
+
+    if (auto oldScheduler = std::exchange(m_scheduler, scheduler)) {
+        oldScheduler->stop();
+        oldScheduler->disconnect(q);
+        delete oldScheduler;
+    }
+
+    m_scheduler->setParent(q);
+
+    connect(m_scheduler, &TransmitScheduler::transmitRequested,
+            q, [this](auto reason) { this->onTransmitRequested(reason); });
+    connect(m_scheduler, &TransmitScheduler::writeLost, q, [this] {
+        m_metrics.recordWriteLost();
+        postEvent(EventSink::FrameLost, m_robotId);
+    });
+    connect(m_scheduler, &TransmitScheduler::intervalChanged, q, &RobotService::transmitIntervalChanged);
+
+    m_scheduler->setPaused(m_message == s_pauseMessage);
+
+    if (state() == ConnectedState)
+        m_scheduler->start();
+
+    emit q->transmitSchedulerChanged(m_scheduler);
+    emit q->transmitIntervalChanged(m_scheduler->interval());
+}
+
+void RobotService::Private::setWriteWithoutResponse(bool writeWithoutResponse)
+{
+    if (std::exchange(m_writeWithoutResponse, writeWithoutResponse) != writeWithoutResponse)
+        emit q->writeWithoutResponseChanged(m_writeWithoutResponse);
+}
+
+RobotService::State RobotService::Private::state() const
+{
+    return m_transport ? m_transport->state() : DisconnectedState;
+}
+
+bool RobotService::Private::writesWithoutResponse() const
+{
+    return m_writeWithoutResponse && m_transport && m_transport->canWriteWithoutResponse();
+}
+
+void RobotService::Private::transmitMessage(TransmitScheduler::Reason reason)
+{
+    m_coalescingTimer.stop();
+
+    if (state() == ConnectedState) {
+        m_unsentChange = false;
+        m_metrics.recordWriteIssued(reason);
+
+        const auto withResponse = !writesWithoutResponse();
+
+        if (m_recorder)
+            m_recorder->recordFrame(m_message, withResponse);
+
+        postEvent(EventSink::FrameIssued, m_robotId, withResponse, eventValue(m_message));
+
+        if (withResponse) {
+            m_transport->writeFrame(m_message, RobotTransport::WriteWithResponse);
+            m_scheduler->writeIssued();
+        } else {
+            m_transport->writeFrame(m_message, RobotTransport::WriteWithoutResponse);
+            m_scheduler->writeCompleted();
+
+            // there will be no characteristicWritten() signal to reset the eyes
+            consumeEyesPulse(m_message);
+        }
+    }
+}
+
+void RobotService::Private::onTransportStateChanged(State newState, State oldState)
+{
+    if (newState == oldState)
+        return;
+
+    qCInfo(lcRobotService, "state changed: %s => %s", key(oldState), key(newState));
+
+    if (m_recorder)
+        m_recorder->recordStateChange(newState);
+
+    postEvent(EventSink::TransportStateChanged, m_robotId, newState);
+
+    if (newState == ConnectedState) {
+        m_metrics.recordConnected();
+        m_scheduler->start();
+    } else {
+        m_scheduler->stop();
+    }
+
+    emit q->stateChanged(newState, oldState);
+}
+
+bool RobotService::Private::startAction(char action, int index)
+{
+    if (action == 'S') {
+        qCInfo(lcRobotService, "Pausing the robot");
+        setCurrentMessage(s_pauseMessage);
+        return true;
+    }
+
+    if (holdBack(action, index, false))
+        return true;
+
+    if (const auto fragment = m_encoding->encode(action, index)) {
+        qCInfo(lcRobotService, "Starting %c action (index=%d)", action, index);
+
+        if (fragment.offset == 4)
+            m_audioLoop = (action == 'M');
+
+        setCurrentMessage(fragment.offset, fragment.value);
+        return true;
+    }
+
+    qCWarning(lcRobotService, "Could not start unknown action %c (index=%d)", action, index);
+    return false;
+}
+
+bool RobotService::Private::isActionActive(char action, int index) const
+{
+    if (action == 'S')
+        return m_message == s_pauseMessage;
+
+    const auto fragment = m_encoding->encode(action, index);
+    return fragment && m_message.at(fragment.offset) == fragment.value;
+}
+
+bool RobotService::Private::stopAction(char action, int index)
+{
+    if (holdBack(action, index, true))
+        return true;
+
+    if (const auto fragment = m_encoding->encode(action, index)) {
+        if (fragment.value == m_message.at(fragment.offset)) {
+            qCInfo(lcRobotService, "Stopping %c action (index=%d)", action, index);
+            setCurrentMessage(fragment.offset, s_pauseMessage.at(fragment.offset));
+            return true;
+        }
+
+        qCWarning(lcRobotService, "Could not stop inactive action %c (index=%d)", action, index);
+        return false;
+    }
+
+    qCWarning(lcRobotService, "Could not stop unknown action %c (index=%d)", action, index);
+    return false;
+}
+
+void RobotService::Private::onNotificationReceived(const QByteArray &value)
+{
+    m_metrics.recordNotification();
+
+    if (m_recorder)
+        m_recorder->recordNotification(value);
+
+    const auto notification = NotificationDecoder::decode(value);
+    postEvent(EventSink::NotificationReceived, m_robotId, notification.type, static_cast<quint64>(notification.index));
+
+    switch (notification.type) {
+    case Notification::SoundStarted:
+        m_currentSound = notification.index;
+
+        if (!m_audioLoop)
+            stopAction('V', m_currentSound);
+
+        emit q->currentSoundChanged(m_currentSound);
+        return;
+
+    case Notification::SoundEnded:
+        m_currentSound = notification.index;
+
+        if (m_audioLoop) {
+            startAction('M', m_currentSound);
+        } else {
+            m_currentSound = -m_currentSound;
+            stopAction('V', -m_currentSound);
+        }
+
+        emit q->currentSoundChanged(m_currentSound);
+        return;
+
+    case Notification::UnknownNotification:
+        break;
+    }
+
+    qCDebug(lcRobotService, "Ignoring unknown notification: %s", value.constData());
+}
+
+void RobotService::Private::onTransmitRequested(TransmitScheduler::Reason reason)
+{
+    // Without acknowledgements nothing throttles the writes. Therefore merge all changes
+    // of the current event loop iteration into a single write of the newest message.
+    // Stops skip this and go out immediately.
+    if (writesWithoutResponse() && reason != TransmitScheduler::UrgentChange) {
+        if (reason == TransmitScheduler::MessageChanged)
+            m_coalescedReason = reason;
+        if (!m_coalescingTimer.isActive())
+            m_coalescingTimer.start();
+    } else {
+        transmitMessage(reason);
+    }
+}
+
+void RobotService::Private::onFrameWritten(const RobotFrame &frame)
+{
+    m_metrics.recordWriteAcknowledged();
+
+    if (m_recorder)
+        m_recorder->recordAcknowledgement();
+
+    postEvent(EventSink::FrameAcknowledged, m_robotId, 0, eventValue(frame));
+
+    m_scheduler->writeAcknowledged();
+    emit q->frameWritten(frame);
+    consumeEyesPulse(frame);
+}
+
+} // namespace EvoBot
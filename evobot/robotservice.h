@@ -0,0 +1,196 @@
+#ifndef ROBOTSERVICE_H
+#define ROBOTSERVICE_H
+
+#include "actionparser.h"
+#include "robotframe.h"
+
+#include <QObject>
+
+class QLowEnergyController;
+
+namespace EvoBot {
+
+class RobotMetrics;
+class RobotTransport;
+class SessionRecorder;
+class TransmitScheduler;
+
+class RobotService : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int state READ state NOTIFY stateChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotFrame currentMessage READ currentMessage WRITE setCurrentMessage NOTIFY currentMessageChanged FINAL)
+    Q_PROPERTY(int header READ header WRITE setHeader NOTIFY headerChanged FINAL)
+    Q_PROPERTY(int drive READ drive WRITE setDrive NOTIFY driveChanged FINAL)
+    Q_PROPERTY(int claw READ claw WRITE setClaw NOTIFY clawChanged FINAL)
+    Q_PROPERTY(int arm READ arm WRITE setArm NOTIFY armChanged FINAL)
+    Q_PROPERTY(int sound READ sound WRITE setSound NOTIFY soundChanged FINAL)
+    Q_PROPERTY(int eyes READ eyes WRITE setEyes NOTIFY eyesChanged FINAL)
+    Q_PROPERTY(int currentSound READ currentSound NOTIFY currentSoundChanged FINAL)
+    Q_PROPERTY(int firmwareRevision READ firmwareRevision NOTIFY firmwareRevisionChanged FINAL)
+    Q_PROPERTY(int transmitInterval READ transmitInterval NOTIFY transmitIntervalChanged FINAL)
+    Q_PROPERTY(EvoBot::TransmitScheduler *transmitScheduler READ transmitScheduler NOTIFY transmitSchedulerChanged FINAL)
+    Q_PROPERTY(bool writeWithoutResponse READ writeWithoutResponse WRITE setWriteWithoutResponse NOTIFY writeWithoutResponseChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotMetrics *metrics READ metrics CONSTANT FINAL)
+
+public:
+    enum State {
+        DisconnectedState,
+        ConnectingState,
+        ConnectedState,
+    };
+
+    Q_ENUM(State)
+
+    // The actions understood by startAction() and stopAction(), with their letter as value.
+    enum Action {
+        PauseAction = 'S',
+        ForwardAction = 'F',
+        BackwardAction = 'B',
+        TurnLeftAction = 'L',
+        TurnRightAction = 'R',
+        OpenClawAction = 'O',
+        CloseClawAction = 'C',
+        RaiseArmAction = 'U',
+        LowerArmAction = 'D',
+        PlaySoundAction = 'V',
+        PlayLoopAction = 'M',
+        EyesAction = 'E',
+    };
+
+    Q_ENUM(Action)
+
+    // Attribute handles of the robot control service, as needed to validate cached device information.
+    struct Layout
+    {
+        quint16 notifyHandle = 0;
+        quint16 notifyConfigHandle = 0;
+        quint16 writeHandle = 0;
+
+        bool isValid() const { return notifyHandle && notifyConfigHandle && writeHandle; }
+
+        bool operator==(const Layout &rhs) const
+        {
+            return notifyHandle == rhs.notifyHandle
+                    && notifyConfigHandle == rhs.notifyConfigHandle
+                    && writeHandle == rhs.writeHandle;
+        }
+
+        bool operator!=(const Layout &rhs) const { return !operator==(rhs); }
+    };
+
+    explicit RobotService(QObject *parent = {});
+    ~RobotService();
+
+    bool attach(QLowEnergyController *central);
+
+    // Takes ownership of the transport, replacing the previous one.
+    bool attach(RobotTransport *transport);
+    RobotTransport *transport() const;
+
+    void setCurrentMessage(const RobotFrame &message);
+    RobotFrame currentMessage() const;
+
+    // Also tells whether the sound field loops like PlayLoopAction, or plays once like
+    // PlaySoundAction. Both encode the same value, but only the latter gets cleared
+    // once the robot reports the sound started.
+    void setCurrentMessage(const RobotFrame &message, bool audioLoop);
+
+    // Replaces the current message without requesting a transmission, for instance while
+    // the connection is lost. The robot receives the new message with the next write.
+    void resetCurrentMessage(const RobotFrame &message);
+
+    void setHeader(int header);
+    int header() const;
+    void setDrive(int drive);
+    int drive() const;
+    void setClaw(int claw);
+    int claw() const;
+    void setArm(int arm);
+    int arm() const;
+    void setSound(int sound);
+    int sound() const;
+    void setEyes(int eyes);
+    int eyes() const;
+    int currentSound() const;
+    State state() const;
+
+    // The firmware revision is read from the device information service. A previously
+    // known revision can be passed before attaching, so that actions depending on it
+    // work before that service got discovered.
+    void setFirmwareRevision(int firmwareRevision);
+    int firmwareRevision() const;
+
+    Layout layout() const;
+
+    // Applies actions to the given frame, using this robot's encoding, but without transmitting it.
+    bool encodeActions(const ActionCommandList &commands, RobotFrame *frame) const;
+
+    void setTransmitScheduler(TransmitScheduler *scheduler);
+    TransmitScheduler *transmitScheduler() const;
+    int transmitInterval() const;
+
+    void setWriteWithoutResponse(bool writeWithoutResponse);
+    bool writeWithoutResponse() const;
+
+    // Whether frames really get written without response, which also needs a transport
+    // supporting it. Only frames written with response get acknowledged by frameWritten().
+    bool writesWithoutResponse() const;
+
+    RobotMetrics *metrics() const;
+
+    // Records the written frames, acknowledgements and notifications, without taking ownership.
+    void setRecorder(SessionRecorder *recorder);
+    SessionRecorder *recorder() const;
+
+    bool startAction(Action action, int index = 0);
+    bool stopAction(Action action, int index = 0);
+
+    // Tells whether the current message contains the action, the pause action matches the pause message only.
+    Q_INVOKABLE bool isActionActive(QChar action, int index = 0) const;
+    bool isActionActive(Action action, int index = 0) const;
+
+public slots:
+    bool startAction(QChar action, int index = 0);
+    bool stopAction(QChar action, int index = 0);
+    bool playSound(int index);
+    bool playLoop(int index);
+
+    // Changes made between beginUpdate() and commit() are notified and transmitted once.
+    void beginUpdate();
+    void commit();
+
+    // Applies a list of actions like "F2 O V5 -F2" as a single update, see parseActions().
+    bool applyActions(const QString &actions);
+
+    // Drives like an analog stick: y points forward, x to the right, both range from -1 to 1.
+    // The vector is mapped to the closest drive action with hysteresis, and the resulting
+    // changes are applied at most once per transmit interval.
+    void setDriveVector(qreal x, qreal y);
+
+signals:
+    void currentMessageChanged(const EvoBot::RobotFrame &message);
+    void headerChanged(int header);
+    void driveChanged(int drive);
+    void clawChanged(int claw);
+    void armChanged(int arm);
+    void soundChanged(int sound);
+    void eyesChanged(int eyes);
+    void currentSoundChanged(int currentSound);
+    void stateChanged(int newState, int oldState);
+    void firmwareRevisionChanged(int firmwareRevision);
+    void transmitIntervalChanged(int transmitInterval);
+    void transmitSchedulerChanged(EvoBot::TransmitScheduler *transmitScheduler);
+    void writeWithoutResponseChanged(bool writeWithoutResponse);
+
+    // The robot acknowledged a frame written with response.
+    void frameWritten(const EvoBot::RobotFrame &frame);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // ROBOTSERVICE_H
@@ -0,0 +1,274 @@
+#include "robotserviceproxy.h"
+
+#include "actionencoding.h"
+#include "robotservice.h"
+
+#include <QThread>
+
+namespace EvoBot {
+
+class RobotServiceProxy::Private
+{
+public:
+    Private(RobotServiceProxy *q, RobotService *service)
+        : q{q}
+        , m_service{service}
+    {
+        qRegisterMetaType<RobotFrame>();
+
+        // connect before taking the snapshot, so that no change gets lost in between
+        connect(service, &RobotService::currentMessageChanged,
+                q, [this](const auto &message) { this->onCurrentMessageChanged(message); });
+        connect(service, &RobotService::currentSoundChanged, q, [this](int currentSound) {
+            if (std::exchange(m_currentSound, currentSound) != currentSound)
+                emit this->q->currentSoundChanged(m_currentSound);
+        });
+        connect(service, &RobotService::stateChanged, q, [this](int newState) {
+            const auto oldState = std::exchange(m_state, newState);
+
+            if (oldState != newState)
+                emit this->q->stateChanged(m_state, oldState);
+        });
+        connect(service, &RobotService::firmwareRevisionChanged, q, [this](int firmwareRevision) {
+            if (std::exchange(m_firmwareRevision, firmwareRevision) != firmwareRevision)
+                emit this->q->firmwareRevisionChanged(m_firmwareRevision);
+        });
+        connect(service, &RobotService::transmitIntervalChanged, q, [this](int transmitInterval) {
+            if (std::exchange(m_transmitInterval, transmitInterval) != transmitInterval)
+                emit this->q->transmitIntervalChanged(m_transmitInterval);
+        });
+        connect(service, &RobotService::writeWithoutResponseChanged, q, [this](bool writeWithoutResponse) {
+            if (std::exchange(m_writeWithoutResponse, writeWithoutResponse) != writeWithoutResponse)
+                emit this->q->writeWithoutResponseChanged(m_writeWithoutResponse);
+        });
+
+        const auto connectionType = (service->thread() == QThread::currentThread()
+                                     ? Qt::DirectConnection : Qt::BlockingQueuedConnection);
+
+        QMetaObject::invokeMethod(service, [this, service] {
+            m_state = service->state();
+            m_message = service->currentMessage();
+            m_currentSound = service->currentSound();
+            m_firmwareRevision = service->firmwareRevision();
+            m_transmitInterval = service->transmitInterval();
+            m_writeWithoutResponse = service->writeWithoutResponse();
+        }, connectionType);
+    }
+
+    // Runs the function in the service's thread.
+    template<typename Function>
+    void invoke(Function function) const
+    {
+        QMetaObject::invokeMethod(m_service, [service = m_service, function] { function(service); });
+    }
+
+    void setField(RobotFrame::Field field, int value)
+    {
+        invoke([field, value](RobotService *service) {
+            auto message = service->currentMessage();
+            message.setAt(field, static_cast<char>(value));
+            service->setCurrentMessage(message);
+        });
+    }
+
+    void onCurrentMessageChanged(const RobotFrame &message)
+    {
+        const auto previousMessage = std::exchange(m_message, message);
+
+        if (m_message == previousMessage)
+            return;
+
+        if (m_message.header() != previousMessage.header())
+            emit q->headerChanged(m_message.header());
+        if (m_message.drive() != previousMessage.drive())
+            emit q->driveChanged(m_message.drive());
+        if (m_message.claw() != previousMessage.claw())
+            emit q->clawChanged(m_message.claw());
+        if (m_message.arm() != previousMessage.arm())
+            emit q->armChanged(m_message.arm());
+        if (m_message.sound() != previousMessage.sound())
+            emit q->soundChanged(m_message.sound());
+        if (m_message.eyes() != previousMessage.eyes())
+            emit q->eyesChanged(m_message.eyes());
+
+        emit q->currentMessageChanged(m_message);
+    }
+
+    RobotServiceProxy *const q;
+    RobotService *const m_service;
+
+    int m_state = RobotService::DisconnectedState;
+    RobotFrame m_message;
+    int m_currentSound = 0;
+    int m_firmwareRevision = -1;
+    int m_transmitInterval = 0;
+    bool m_writeWithoutResponse = false;
+};
+
+RobotServiceProxy::RobotServiceProxy(RobotService *service, QObject *parent)
+    : QObject{parent}
+    , d{new Private{this, service}}
+{}
+
+RobotServiceProxy::~RobotServiceProxy()
+{
+    delete d;
+}
+
+RobotService *RobotServiceProxy::service() const
+{
+    return d->m_service;
+}
+
+int RobotServiceProxy::state() const
+{
+    return d->m_state;
+}
+
+void RobotServiceProxy::setCurrentMessage(const RobotFrame &message)
+{
+    d->invoke([message](RobotService *service) { service->setCurrentMessage(message); });
+}
+
+RobotFrame RobotServiceProxy::currentMessage() const
+{
+    return d->m_message;
+}
+
+void RobotServiceProxy::setHeader(int header)
+{
+    d->setField(RobotFrame::HeaderField, header);
+}
+
+int RobotServiceProxy::header() const
+{
+    return d->m_message.header();
+}
+
+void RobotServiceProxy::setDrive(int drive)
+{
+    d->setField(RobotFrame::DriveField, drive);
+}
+
+int RobotServiceProxy::drive() const
+{
+    return d->m_message.drive();
+}
+
+void RobotServiceProxy::setClaw(int claw)
+{
+    d->setField(RobotFrame::ClawField, claw);
+}
+
+int RobotServiceProxy::claw() const
+{
+    return d->m_message.claw();
+}
+
+void RobotServiceProxy::setArm(int arm)
+{
+    d->setField(RobotFrame::ArmField, arm);
+}
+
+int RobotServiceProxy::arm() const
+{
+    return d->m_message.arm();
+}
+
+void RobotServiceProxy::setSound(int sound)
+{
+    d->setField(RobotFrame::SoundField, sound);
+}
+
+int RobotServiceProxy::sound() const
+{
+    return d->m_message.sound();
+}
+
+void RobotServiceProxy::setEyes(int eyes)
+{
+    d->setField(RobotFrame::EyesField, eyes);
+}
+
+int RobotServiceProxy::eyes() const
+{
+    return d->m_message.eyes();
+}
+
+int RobotServiceProxy::currentSound() const
+{
+    return d->m_currentSound;
+}
+
+int RobotServiceProxy::firmwareRevision() const
+{
+    return d->m_firmwareRevision;
+}
+
+int RobotServiceProxy::transmitInterval() const
+{
+    return d->m_transmitInterval;
+}
+
+void RobotServiceProxy::setWriteWithoutResponse(bool writeWithoutResponse)
+{
+    d->invoke([writeWithoutResponse](RobotService *service) { service->setWriteWithoutResponse(writeWithoutResponse); });
+}
+
+bool RobotServiceProxy::writeWithoutResponse() const
+{
+    return d->m_writeWithoutResponse;
+}
+
+bool RobotServiceProxy::isActionActive(QChar action, int index) const
+{
+    const auto code = action.toLatin1();
+
+    if (code == 'S')
+        return d->m_message == RobotFrame::pause();
+
+    const auto fragment = ActionEncoding::forFirmware(d->m_firmwareRevision).encode(code, index);
+    return fragment && d->m_message.at(fragment.offset) == fragment.value;
+}
+
+void RobotServiceProxy::startAction(QChar action, int index)
+{
+    d->invoke([action, index](RobotService *service) { service->startAction(action, index); });
+}
+
+void RobotServiceProxy::stopAction(QChar action, int index)
+{
+    d->invoke([action, index](RobotService *service) { service->stopAction(action, index); });
+}
+
+void RobotServiceProxy::playSound(int index)
+{
+    d->invoke([index](RobotService *service) { service->playSound(index); });
+}
+
+void RobotServiceProxy::playLoop(int index)
+{
+    d->invoke([index](RobotService *service) { service->playLoop(index); });
+}
+
+void RobotServiceProxy::beginUpdate()
+{
+    d->invoke([](RobotService *service) { service->beginUpdate(); });
+}
+
+void RobotServiceProxy::commit()
+{
+    d->invoke([](RobotService *service) { service->commit(); });
+}
+
+void RobotServiceProxy::applyActions(const QString &actions)
+{
+    d->invoke([actions](RobotService *service) { service->applyActions(actions); });
+}
+
+void RobotServiceProxy::setDriveVector(qreal x, qreal y)
+{
+    d->invoke([x, y](RobotService *service) { service->setDriveVector(x, y); });
+}
+
+} // namespace EvoBot
@@ -0,0 +1,98 @@
+#ifndef EVOBOT_ROBOTSERVICEPROXY_H
+#define EVOBOT_ROBOTSERVICEPROXY_H
+
+#include "robotframe.h"
+
+#include <QObject>
+
+namespace EvoBot {
+
+class RobotService;
+
+// Mirrors a RobotService living in another thread. Property values are cached and updated
+// through queued signals, while changes and actions are forwarded as queued calls. The
+// metrics and transmitScheduler objects are left out, since they live in the service's
+// thread; reach them through service() with queued calls.
+class RobotServiceProxy : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int state READ state NOTIFY stateChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotFrame currentMessage READ currentMessage WRITE setCurrentMessage NOTIFY currentMessageChanged FINAL)
+    Q_PROPERTY(int header READ header WRITE setHeader NOTIFY headerChanged FINAL)
+    Q_PROPERTY(int drive READ drive WRITE setDrive NOTIFY driveChanged FINAL)
+    Q_PROPERTY(int claw READ claw WRITE setClaw NOTIFY clawChanged FINAL)
+    Q_PROPERTY(int arm READ arm WRITE setArm NOTIFY armChanged FINAL)
+    Q_PROPERTY(int sound READ sound WRITE setSound NOTIFY soundChanged FINAL)
+    Q_PROPERTY(int eyes READ eyes WRITE setEyes NOTIFY eyesChanged FINAL)
+    Q_PROPERTY(int currentSound READ currentSound NOTIFY currentSoundChanged FINAL)
+    Q_PROPERTY(int firmwareRevision READ firmwareRevision NOTIFY firmwareRevisionChanged FINAL)
+    Q_PROPERTY(int transmitInterval READ transmitInterval NOTIFY transmitIntervalChanged FINAL)
+    Q_PROPERTY(bool writeWithoutResponse READ writeWithoutResponse WRITE setWriteWithoutResponse NOTIFY writeWithoutResponseChanged FINAL)
+
+public:
+    explicit RobotServiceProxy(RobotService *service, QObject *parent = {});
+    ~RobotServiceProxy() override;
+
+    RobotService *service() const;
+
+    int state() const;
+
+    void setCurrentMessage(const RobotFrame &message);
+    RobotFrame currentMessage() const;
+
+    void setHeader(int header);
+    int header() const;
+    void setDrive(int drive);
+    int drive() const;
+    void setClaw(int claw);
+    int claw() const;
+    void setArm(int arm);
+    int arm() const;
+    void setSound(int sound);
+    int sound() const;
+    void setEyes(int eyes);
+    int eyes() const;
+
+    int currentSound() const;
+    int firmwareRevision() const;
+    int transmitInterval() const;
+
+    void setWriteWithoutResponse(bool writeWithoutResponse);
+    bool writeWithoutResponse() const;
+
+    // Checks the cached message, using the encoding of the cached firmware revision.
+    Q_INVOKABLE bool isActionActive(QChar action, int index = 0) const;
+
+public slots:
+    void startAction(QChar action, int index = 0);
+    void stopAction(QChar action, int index = 0);
+    void playSound(int index);
+    void playLoop(int index);
+
+    void beginUpdate();
+    void commit();
+    void applyActions(const QString &actions);
+    void setDriveVector(qreal x, qreal y);
+
+signals:
+    void currentMessageChanged(const EvoBot::RobotFrame &message);
+    void headerChanged(int header);
+    void driveChanged(int drive);
+    void clawChanged(int claw);
+    void armChanged(int arm);
+    void soundChanged(int sound);
+    void eyesChanged(int eyes);
+    void currentSoundChanged(int currentSound);
+    void stateChanged(int newState, int oldState);
+    void firmwareRevisionChanged(int firmwareRevision);
+    void transmitIntervalChanged(int transmitInterval);
+    void writeWithoutResponseChanged(bool writeWithoutResponse);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ROBOTSERVICEPROXY_H
@@ -0,0 +1,40 @@
+#ifndef EVOBOT_ROBOTTRANSPORT_H
+#define EVOBOT_ROBOTTRANSPORT_H
+
+#include "robotservice.h"
+
+namespace EvoBot {
+
+// The link below RobotService, which delivers frames to a robot and reports its notifications.
+class RobotTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum WriteMode {
+        WriteWithResponse,
+        WriteWithoutResponse,
+    };
+
+    Q_ENUM(WriteMode)
+
+    explicit RobotTransport(QObject *parent = {}) : QObject{parent} {}
+
+    virtual RobotService::State state() const = 0;
+    virtual int firmwareRevision() const { return -1; }
+    virtual bool canWriteWithoutResponse() const { return false; }
+    virtual RobotService::Layout layout() const { return {}; }
+
+    // Writes with response are confirmed by the frameWritten() signal.
+    virtual void writeFrame(const RobotFrame &frame, WriteMode mode) = 0;
+
+signals:
+    void stateChanged(int newState, int oldState);
+    void firmwareRevisionChanged(int firmwareRevision);
+    void frameWritten(const EvoBot::RobotFrame &frame);
+    void notificationReceived(const QByteArray &value);
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_ROBOTTRANSPORT_H
@@ -0,0 +1,566 @@
+#include "sequencer.h"
+
+#include "robotservice.h"
+#include "transmitscheduler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcSequencer, "evobot.sequencer")
+
+// Parses the time at the start of the text, in milliseconds unless followed by "ms" or "s".
+// Returns the length of the time, or -1 if the text doesn't start with a valid time.
+int parseTime(const QString &text, std::chrono::milliseconds *time)
+{
+    auto length = 0;
+
+    while (length < text.size() && (text[length].isDigit() || text[length] == '.'))
+        ++length;
+
+    auto ok = false;
+    auto value = text.left(length).toDouble(&ok);
+
+    if (ok && text.mid(length, 2) == QLatin1String("ms")) {
+        length += 2;
+    } else if (ok && text.mid(length, 1) == QLatin1String("s")) {
+        value *= 1000;
+        length += 1;
+    }
+
+    if (!ok || value < 0 || (length < text.size() && !text[length].isSpace()))
+        return -1;
+
+    *time = std::chrono::milliseconds{qRound64(value)};
+    return length;
+}
+
+QString invalidTime(const QString &text)
+{
+    return QCoreApplication::translate("EvoBot::Sequencer", "Invalid time in `%1'").arg(text);
+}
+
+bool parseStep(const QString &line, RoutineStep *step, QString *errorString)
+{
+    const auto length = parseTime(line, &step->time);
+
+    if (length < 0) {
+        if (errorString)
+            *errorString = invalidTime(line);
+
+        return false;
+    }
+
+    return parseActions(line.mid(length), &step->commands, errorString);
+}
+
+bool parseSegment(const QString &segment, ActionCommandList *commands,
+                  std::chrono::milliseconds *duration, QString *errorString)
+{
+    // the duration is the last token, and it is the only token starting with a digit
+    const auto start = std::max(segment.lastIndexOf(' '), segment.lastIndexOf(',')) + 1;
+    auto actions = segment;
+
+    if (start < segment.size() && segment[start].isDigit()) {
+        if (parseTime(segment.mid(start), duration) != segment.size() - start) {
+            if (errorString)
+                *errorString = invalidTime(segment);
+
+            return false;
+        }
+
+        actions.truncate(start);
+    }
+
+    return parseActions(actions, commands, errorString);
+}
+
+} // namespace
+
+bool parseRoutine(const QStringList &lines, Routine *routine, QString *errorString)
+{
+    Routine parsedRoutine;
+    parsedRoutine.reserve(static_cast<size_t>(lines.size()));
+
+    for (const auto &line: lines) {
+        const auto trimmed = line.trimmed();
+
+        if (trimmed.isEmpty() || trimmed.startsWith('#'))
+            continue;
+
+        RoutineStep step;
+
+        if (!parseStep(trimmed, &step, errorString))
+            return false;
+
+        parsedRoutine.emplace_back(std::move(step));
+    }
+
+    std::stable_sort(parsedRoutine.begin(), parsedRoutine.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.time < rhs.time; });
+
+    if (routine)
+        *routine = std::move(parsedRoutine);
+
+    return true;
+}
+
+bool parseMacro(const QString &text, Routine *routine, QString *errorString)
+{
+    Routine parsedRoutine;
+    auto time = std::chrono::milliseconds{0};
+
+    for (const auto &segment: text.split(';')) {
+        const auto simplified = segment.simplified();
+
+        if (simplified.isEmpty())
+            continue;
+
+        ActionCommandList commands;
+        auto duration = std::chrono::milliseconds{0};
+
+        if (!parseSegment(simplified, &commands, &duration, errorString))
+            return false;
+
+        RoutineStep stops{time + duration, {}};
+
+        for (const auto &command: commands) {
+            if (!command.stop && command.action != 'S')
+                stops.commands.push_back({command.action, command.index, true});
+        }
+
+        if (!commands.empty())
+            parsedRoutine.push_back({time, std::move(commands)});
+
+        // without stops the step still marks the end of a trailing pause
+        if (duration.count() > 0) {
+            time += duration;
+            parsedRoutine.emplace_back(std::move(stops));
+        }
+    }
+
+    if (routine)
+        *routine = std::move(parsedRoutine);
+
+    return true;
+}
+
+class Sequencer::Private
+{
+    struct Cue
+    {
+        qint32 deadline;
+        RobotFrame frame;
+        bool audioLoop;
+    };
+
+    struct Robot
+    {
+        RobotService *service;
+        std::vector<Cue> cues;
+        size_t next = 0;
+        QHash<QString, std::vector<Cue>> compiledMacros;
+    };
+
+public:
+    explicit Private(Sequencer *q)
+        : q{q}
+    {
+        m_timer.setSingleShot(true);
+        m_timer.setTimerType(Qt::PreciseTimer);
+        connect(&m_timer, &QTimer::timeout, q, [this] { onTimeout(); });
+    }
+
+    void addRobotService(RobotService *service)
+    {
+        if (!service || findRobot(service) != m_robots.end())
+            return;
+
+        connect(service, &QObject::destroyed, q, [this, service] { removeRobotService(service); });
+        connect(service, &RobotService::firmwareRevisionChanged, q, [this, service] {
+            const auto robot = findRobot(service);
+
+            if (robot != m_robots.end()) {
+                robot->compiledMacros.clear();
+                compile(&*robot);
+            }
+        });
+
+        m_robots.push_back({service, {}});
+        compile(&m_robots.back());
+    }
+
+    void removeRobotService(RobotService *service)
+    {
+        const auto robot = findRobot(service);
+
+        if (robot != m_robots.end()) {
+            service->disconnect(q);
+            m_robots.erase(robot);
+        }
+    }
+
+    QList<RobotService *> robotServices() const
+    {
+        QList<RobotService *> services;
+        services.reserve(static_cast<int>(m_robots.size()));
+
+        for (const auto &robot: m_robots)
+            services.append(robot.service);
+
+        return services;
+    }
+
+    bool load(const Routine &routine)
+    {
+        stop();
+
+        m_routine = routine;
+
+        for (auto &robot: m_robots) {
+            if (!compile(&robot))
+                return false;
+        }
+
+        setErrorString({});
+        emit q->durationChanged(duration());
+        return true;
+    }
+
+    bool load(const QStringList &lines)
+    {
+        Routine routine;
+        QString errorString;
+
+        if (!parseRoutine(lines, &routine, &errorString)) {
+            qCWarning(lcSequencer, "%ls", qUtf16Printable(errorString));
+            setErrorString(errorString);
+            return false;
+        }
+
+        return load(routine);
+    }
+
+    void start()
+    {
+        if (m_playing)
+            return;
+
+        m_playing = true;
+        emit q->playingChanged(m_playing);
+
+        m_loopOffset = 0;
+        rewind();
+        m_clock.start();
+        onTimeout();
+    }
+
+    void stop()
+    {
+        m_timer.stop();
+
+        if (std::exchange(m_playing, false))
+            emit q->playingChanged(m_playing);
+    }
+
+    bool isPlaying() const { return m_playing; }
+
+    void setLooping(bool looping)
+    {
+        if (std::exchange(m_looping, looping) != looping)
+            emit q->loopingChanged(m_looping);
+    }
+
+    bool isLooping() const { return m_looping; }
+
+    int duration() const
+    {
+        return m_routine.empty() ? 0 : static_cast<int>(m_routine.back().time.count());
+    }
+
+    QString errorString() const { return m_errorString; }
+
+    bool defineMacro(const QString &name, const QString &text)
+    {
+        Routine routine;
+        QString errorString;
+
+        if (!parseMacro(text, &routine, &errorString)) {
+            qCWarning(lcSequencer, "Could not define macro %ls: %ls", qUtf16Printable(name), qUtf16Printable(errorString));
+            setErrorString(errorString);
+            return false;
+        }
+
+        removeMacro(name);
+        m_macros.insert(name, std::move(routine));
+        return true;
+    }
+
+    void removeMacro(const QString &name)
+    {
+        m_macros.remove(name);
+
+        for (auto &robot: m_robots)
+            robot.compiledMacros.remove(name);
+    }
+
+    QStringList macros() const { return m_macros.keys(); }
+
+    bool playMacro(const QString &name)
+    {
+        const auto macro = m_macros.constFind(name);
+
+        if (macro == m_macros.cend()) {
+            setErrorString(tr("Unknown macro `%1'").arg(name));
+            return false;
+        }
+
+        stop();
+
+        m_routine = *macro;
+
+        for (auto &robot: m_robots) {
+            const auto compiled = robot.compiledMacros.constFind(name);
+
+            if (compiled != robot.compiledMacros.cend()) {
+                robot.cues = *compiled;
+            } else if (compile(&robot)) {
+                robot.compiledMacros.insert(name, robot.cues);
+            } else {
+                return false;
+            }
+        }
+
+        setErrorString({});
+        emit q->durationChanged(duration());
+        start();
+        return true;
+    }
+
+private:
+    std::vector<Robot>::iterator findRobot(RobotService *service)
+    {
+        return std::find_if(m_robots.begin(), m_robots.end(),
+                            [service](const auto &robot) { return robot.service == service; });
+    }
+
+    void setErrorString(const QString &errorString)
+    {
+        if (std::exchange(m_errorString, errorString) != errorString)
+            emit q->errorStringChanged(m_errorString);
+    }
+
+    // Turns the routine into the sequence of frames to send, which only depends on the
+    // robot's firmware revision. Steps scheduled for the same time are merged. Sounds
+    // played with V and eye animations only trigger once, so they are dropped from the
+    // frames of later cues, which otherwise would trigger them again. Sounds played with
+    // M encode the same value, so each cue also tells the service whether they loop.
+    bool compile(Robot *robot)
+    {
+        const auto pause = RobotFrame::pause();
+        auto frame = pause;
+        auto soundPulse = false;
+        auto eyesPulse = false;
+        auto audioLoop = false;
+
+        robot->cues.clear();
+        robot->cues.reserve(m_routine.size());
+
+        for (const auto &step: m_routine) {
+            const auto deadline = static_cast<qint32>(step.time.count());
+            const auto merging = (!robot->cues.empty() && robot->cues.back().deadline == deadline);
+
+            if (!merging) {
+                if (std::exchange(soundPulse, false))
+                    frame.setAt(RobotFrame::SoundField, pause.at(RobotFrame::SoundField));
+                if (std::exchange(eyesPulse, false))
+                    frame.setAt(RobotFrame::EyesField, pause.at(RobotFrame::EyesField));
+            }
+
+            if (!robot->service->encodeActions(step.commands, &frame)) {
+                setErrorString(tr("Could not encode routine for %1").arg(robot->service->objectName()));
+                robot->cues.clear();
+                return false;
+            }
+
+            for (const auto &command: step.commands) {
+                if (command.stop)
+                    continue;
+
+                if (command.action == 'S') {
+                    soundPulse = false;
+                    eyesPulse = false;
+                } else if (command.action == 'V' || command.action == 'M') {
+                    soundPulse = (command.action == 'V');
+                    audioLoop = (command.action == 'M');
+                } else if (command.action == 'E') {
+                    eyesPulse = true;
+                }
+            }
+
+            if (frame.at(RobotFrame::SoundField) == pause.at(RobotFrame::SoundField))
+                audioLoop = false;
+
+            if (merging)
+                robot->cues.back() = {deadline, frame, audioLoop};
+            else
+                robot->cues.push_back({deadline, frame, audioLoop});
+        }
+
+        robot->next = std::min(robot->next, robot->cues.size());
+        return true;
+    }
+
+    void rewind()
+    {
+        for (auto &robot: m_robots)
+            robot.next = 0;
+    }
+
+    void onTimeout()
+    {
+        const auto now = m_clock.elapsed() - m_loopOffset;
+        auto nextWakeUp = std::numeric_limits<qint64>::max();
+
+        for (auto &robot: m_robots) {
+            const auto latency = robot.service->transmitScheduler()->roundTripTime() / 2;
+
+            for (; robot.next < robot.cues.size(); ++robot.next) {
+                const auto &cue = robot.cues[robot.next];
+                const auto due = qint64{cue.deadline} - latency;
+
+                if (due > now) {
+                    nextWakeUp = std::min(nextWakeUp, due);
+                    break;
+                }
+
+                robot.service->setCurrentMessage(cue.frame, cue.audioLoop);
+            }
+        }
+
+        if (nextWakeUp != std::numeric_limits<qint64>::max()) {
+            m_timer.start(static_cast<int>(nextWakeUp - now));
+        } else if (m_looping && duration() > 0) {
+            m_loopOffset += duration();
+            rewind();
+            m_timer.start(0);
+        } else {
+            qCDebug(lcSequencer, "Routine has finished");
+            stop();
+            emit q->finished();
+        }
+    }
+
+    Sequencer *const q;
+
+    Routine m_routine;
+    QHash<QString, Routine> m_macros;
+    std::vector<Robot> m_robots;
+    QString m_errorString;
+
+    bool m_playing = false;
+    bool m_looping = false;
+    qint64 m_loopOffset = 0;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
+
+Sequencer::Sequencer(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+Sequencer::~Sequencer()
+{
+    delete d;
+}
+
+void Sequencer::addRobotService(RobotService *service)
+{
+    d->addRobotService(service);
+}
+
+void Sequencer::removeRobotService(RobotService *service)
+{
+    d->removeRobotService(service);
+}
+
+QList<RobotService *> Sequencer::robotServices() const
+{
+    return d->robotServices();
+}
+
+bool Sequencer::load(const QStringList &routine)
+{
+    return d->load(routine);
+}
+
+bool Sequencer::load(const Routine &routine)
+{
+    return d->load(routine);
+}
+
+bool Sequencer::isPlaying() const
+{
+    return d->isPlaying();
+}
+
+void Sequencer::setLooping(bool looping)
+{
+    d->setLooping(looping);
+}
+
+bool Sequencer::isLooping() const
+{
+    return d->isLooping();
+}
+
+int Sequencer::duration() const
+{
+    return d->duration();
+}
+
+QString Sequencer::errorString() const
+{
+    return d->errorString();
+}
+
+bool Sequencer::defineMacro(const QString &name, const QString &macro)
+{
+    return d->defineMacro(name, macro);
+}
+
+void Sequencer::removeMacro(const QString &name)
+{
+    d->removeMacro(name);
+}
+
+QStringList Sequencer::macros() const
+{
+    return d->macros();
+}
+
+bool Sequencer::playMacro(const QString &name)
+{
+    return d->playMacro(name);
+}
+
+void Sequencer::start()
+{
+    d->start();
+}
+
+void Sequencer::stop()
+{
+    d->stop();
+}
+
+} // namespace EvoBot
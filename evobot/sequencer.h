@@ -0,0 +1,89 @@
+#ifndef EVOBOT_SEQUENCER_H
+#define EVOBOT_SEQUENCER_H
+
+#include "actionparser.h"
+
+#include <QObject>
+
+#include <chrono>
+
+namespace EvoBot {
+
+class RobotService;
+
+struct RoutineStep
+{
+    std::chrono::milliseconds time;
+    ActionCommandList commands;
+};
+
+using Routine = std::vector<RoutineStep>;
+
+// Parses routines like {"0 F2 O", "500ms -F2 V3", "1.5s S"}, where each line starts with the
+// time since start of the routine, followed by the actions to perform at that time.
+// Empty lines and lines starting with `#' are ignored.
+bool parseRoutine(const QStringList &lines, Routine *routine, QString *errorString = nullptr);
+
+// Parses macros like "F3 500ms; L1 200ms; V5" into a routine. The segments separated by
+// semicolons are performed one after another. When a segment ends with a duration, its
+// actions are stopped once that duration has passed; otherwise they remain active and
+// the next segment follows immediately.
+bool parseMacro(const QString &text, Routine *routine, QString *errorString = nullptr);
+
+class Sequencer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged FINAL)
+    Q_PROPERTY(bool looping READ isLooping WRITE setLooping NOTIFY loopingChanged FINAL)
+    Q_PROPERTY(int duration READ duration NOTIFY durationChanged FINAL)
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged FINAL)
+
+public:
+    explicit Sequencer(QObject *parent = {});
+    ~Sequencer() override;
+
+    // All robots play the same routine. Each robot gets its frames early by half of its
+    // measured write round trip time, so that robots with different latency stay in sync.
+    Q_INVOKABLE void addRobotService(EvoBot::RobotService *service);
+    Q_INVOKABLE void removeRobotService(EvoBot::RobotService *service);
+    QList<RobotService *> robotServices() const;
+
+    Q_INVOKABLE bool load(const QStringList &routine);
+    bool load(const Routine &routine);
+
+    bool isPlaying() const;
+
+    void setLooping(bool looping);
+    bool isLooping() const;
+
+    int duration() const;
+    QString errorString() const;
+
+    // Macros are parsed when being defined, and compiled once per robot and firmware
+    // revision when first played. Playing them again only costs a lookup.
+    Q_INVOKABLE bool defineMacro(const QString &name, const QString &macro);
+    Q_INVOKABLE void removeMacro(const QString &name);
+    QStringList macros() const;
+
+    // Loads the named macro like load() does for routines, and starts playing it.
+    Q_INVOKABLE bool playMacro(const QString &name);
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void playingChanged(bool playing);
+    void loopingChanged(bool looping);
+    void durationChanged(int duration);
+    void errorStringChanged(const QString &errorString);
+    void finished();
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_SEQUENCER_H
@@ -0,0 +1,237 @@
+#include "sessionrecorder.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcSessionRecorder, "evobot.sessionrecorder")
+
+const auto s_chunkSize = qint64{1} << 20;
+const auto s_magicSize = 8;
+
+} // namespace
+
+constexpr char SessionRecorder::Magic[];
+constexpr int SessionRecorder::HeaderSize;
+constexpr int SessionRecorder::RecordHeaderSize;
+
+class SessionRecorder::Private
+{
+public:
+    explicit Private(SessionRecorder *q)
+        : q{q}
+    {}
+
+    ~Private() { close(); }
+
+    bool open(const QString &fileName)
+    {
+        close();
+
+        m_file.setFileName(fileName);
+
+        if (!m_file.open(QFile::ReadWrite | QFile::Truncate)) {
+            qCWarning(lcSessionRecorder, "Cannot open %ls: %ls", qUtf16Printable(fileName), qUtf16Printable(m_file.errorString()));
+            return false;
+        }
+
+        m_size = 0;
+
+        if (!reserve(HeaderSize)) {
+            m_file.close();
+            return false;
+        }
+
+        std::memcpy(m_data, Magic, s_magicSize);
+        qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), m_data + s_magicSize);
+        m_size = HeaderSize;
+        m_clock.start();
+
+        emit q->recordingChanged(true);
+        return true;
+    }
+
+    void close()
+    {
+        if (!m_file.isOpen())
+            return;
+
+        m_file.unmap(m_data);
+        m_data = nullptr;
+        m_capacity = 0;
+
+        // drop the unused rest of the last chunk
+        m_file.resize(m_size);
+        m_file.close();
+
+        emit q->recordingChanged(false);
+    }
+
+    bool isRecording() const { return m_data != nullptr; }
+    QString errorString() const { return m_file.errorString(); }
+    qint64 size() const { return m_size; }
+
+    void record(SessionRecord::Type type, const char *payload, int size)
+    {
+        if (!isRecording())
+            return;
+
+        const auto recordSize = RecordHeaderSize + size;
+
+        if (!reserve(m_size + recordSize))
+            return;
+
+        const auto record = m_data + m_size;
+
+        qToLittleEndian<qint64>(m_clock.nsecsElapsed(), record);
+        record[8] = type;
+        record[9] = static_cast<uchar>(size);
+        std::memcpy(record + RecordHeaderSize, payload, static_cast<size_t>(size));
+
+        m_size += recordSize;
+    }
+
+private:
+    // grows the file chunk by chunk, the new part of the mapping reads as zeros
+    bool reserve(qint64 size)
+    {
+        if (size <= m_capacity)
+            return true;
+
+        const auto capacity = (size + s_chunkSize - 1) / s_chunkSize * s_chunkSize;
+
+        if (m_data)
+            m_file.unmap(m_data);
+
+        m_data = nullptr;
+
+        if (!m_file.resize(capacity) || !(m_data = m_file.map(0, capacity))) {
+            qCWarning(lcSessionRecorder, "Cannot grow %ls: %ls", qUtf16Printable(m_file.fileName()),
+                      qUtf16Printable(m_file.errorString()));
+
+            m_capacity = 0;
+            m_file.resize(m_size);
+            m_file.close();
+
+            if (m_size > 0)
+                emit q->recordingChanged(false);
+
+            return false;
+        }
+
+        m_capacity = capacity;
+        return true;
+    }
+
+    SessionRecorder *const q;
+
+    QFile m_file;
+    QElapsedTimer m_clock;
+    uchar *m_data = nullptr;
+    qint64 m_capacity = 0;
+    qint64 m_size = 0;
+};
+
+SessionRecorder::SessionRecorder(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+SessionRecorder::~SessionRecorder()
+{
+    delete d;
+}
+
+bool SessionRecorder::open(const QString &fileName)
+{
+    return d->open(fileName);
+}
+
+void SessionRecorder::close()
+{
+    d->close();
+}
+
+bool SessionRecorder::isRecording() const
+{
+    return d->isRecording();
+}
+
+QString SessionRecorder::errorString() const
+{
+    return d->errorString();
+}
+
+qint64 SessionRecorder::size() const
+{
+    return d->size();
+}
+
+void SessionRecorder::recordFrame(const RobotFrame &frame, bool withResponse)
+{
+    const auto type = withResponse ? SessionRecord::FrameRecord : SessionRecord::UnacknowledgedFrameRecord;
+    d->record(type, frame.constData(), RobotFrame::Size);
+}
+
+void SessionRecorder::recordAcknowledgement()
+{
+    d->record(SessionRecord::AcknowledgementRecord, nullptr, 0);
+}
+
+void SessionRecorder::recordNotification(const QByteArray &value)
+{
+    d->record(SessionRecord::NotificationRecord, value.constData(), qMin(value.size(), 255));
+}
+
+void SessionRecorder::recordStateChange(int state)
+{
+    const auto value = static_cast<char>(state);
+    d->record(SessionRecord::StateRecord, &value, 1);
+}
+
+bool SessionRecorder::read(const QString &fileName, QList<SessionRecord> *records, QString *errorString)
+{
+    QFile file{fileName};
+
+    const auto fail = [errorString](const QString &message) {
+        if (errorString)
+            *errorString = message;
+
+        return false;
+    };
+
+    if (!file.open(QFile::ReadOnly))
+        return fail(file.errorString());
+
+    const auto size = file.size();
+    const auto data = size > 0 ? file.map(0, size) : nullptr;
+
+    if (!data || size < HeaderSize || std::memcmp(data, Magic, s_magicSize) != 0)
+        return fail(tr("%1 is no session log").arg(fileName));
+
+    records->clear();
+
+    for (auto offset = qint64{HeaderSize}; offset + RecordHeaderSize <= size; ) {
+        const auto record = data + offset;
+        const auto type = static_cast<SessionRecord::Type>(record[8]);
+        const auto payloadSize = int{record[9]};
+
+        if (type == SessionRecord::InvalidRecord || offset + RecordHeaderSize + payloadSize > size)
+            break;
+
+        const auto payload = reinterpret_cast<const char *>(record + RecordHeaderSize);
+        records->append({qFromLittleEndian<qint64>(record), type, QByteArray{payload, payloadSize}});
+        offset += RecordHeaderSize + payloadSize;
+    }
+
+    return true;
+}
+
+} // namespace EvoBot
@@ -0,0 +1,74 @@
+#ifndef EVOBOT_SESSIONRECORDER_H
+#define EVOBOT_SESSIONRECORDER_H
+
+#include "robotframe.h"
+
+#include <QObject>
+
+namespace EvoBot {
+
+// One entry of a session log. Timestamps are nanoseconds on a monotonic clock,
+// counted from the start of the recording.
+struct SessionRecord
+{
+    enum Type : quint8 {
+        InvalidRecord,
+        FrameRecord,                // a frame written with response
+        UnacknowledgedFrameRecord,  // a frame written without response
+        AcknowledgementRecord,      // the robot confirmed a write
+        NotificationRecord,         // a raw 0xfff4 notification
+        StateRecord,                // a single byte holding the new RobotService::State
+    };
+
+    qint64 timestamp = 0;
+    Type type = InvalidRecord;
+    QByteArray payload;
+
+    bool isFrame() const { return type == FrameRecord || type == UnacknowledgedFrameRecord; }
+    RobotFrame frame() const { return RobotFrame::fromByteArray(payload); }
+};
+
+// Appends the traffic of a robot service to a binary log, which is memory-mapped and grows in
+// chunks, so that recording is a copy into mapped memory. The file starts with a 16 byte header
+// of the magic and the start time in milliseconds since the epoch. Each record has a 64 bit
+// timestamp, the type and payload size as one byte each, and the payload. All numbers are
+// little endian; a zero type marks the end of a log that wasn't closed properly.
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged FINAL)
+
+public:
+    static constexpr char Magic[] = "EvoBotS1";
+    static constexpr int HeaderSize = 16;
+    static constexpr int RecordHeaderSize = 10;
+
+    explicit SessionRecorder(QObject *parent = {});
+    ~SessionRecorder() override;
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool isRecording() const;
+    QString errorString() const;
+    qint64 size() const;
+
+    void recordFrame(const RobotFrame &frame, bool withResponse);
+    void recordAcknowledgement();
+    void recordNotification(const QByteArray &value);
+    void recordStateChange(int state);
+
+    // Reads a complete log, stopping at its end marker. Returns false if the file is no session log.
+    static bool read(const QString &fileName, QList<SessionRecord> *records, QString *errorString = nullptr);
+
+signals:
+    void recordingChanged(bool recording);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_SESSIONRECORDER_H
@@ -0,0 +1,336 @@
+#include "sessionreplayer.h"
+
+#include "robottransport.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QTimer>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcSessionReplayer, "evobot.sessionreplayer")
+
+// lost acknowledgements must not stall the end of a replay
+constexpr auto s_acknowledgementTimeout = 1s;
+
+struct LatencyAverage
+{
+    void add(qint64 nanoseconds) { sum += nanoseconds; ++count; }
+    double milliseconds() const { return count > 0 ? sum / 1e6 / count : 0.0; }
+
+    qint64 sum = 0;
+    int count = 0;
+};
+
+} // namespace
+
+class SessionReplayer::Private
+{
+    struct Frame
+    {
+        qint64 timestamp;
+        RobotFrame frame;
+        bool withResponse;
+    };
+
+public:
+    explicit Private(SessionReplayer *q)
+        : q{q}
+    {
+        m_timer.setSingleShot(true);
+        m_timer.setTimerType(Qt::PreciseTimer);
+        connect(&m_timer, &QTimer::timeout, q, [this] { writeNext(); });
+
+        m_acknowledgementTimer.setSingleShot(true);
+        connect(&m_acknowledgementTimer, &QTimer::timeout, q, [this] { onAcknowledgementTimeout(); });
+    }
+
+    bool load(const QString &fileName)
+    {
+        QList<SessionRecord> records;
+
+        if (!SessionRecorder::read(fileName, &records, &m_errorString)) {
+            qCWarning(lcSessionReplayer, "%ls", qUtf16Printable(m_errorString));
+            return false;
+        }
+
+        setRecords(records);
+        return true;
+    }
+
+    void setRecords(const QList<SessionRecord> &records)
+    {
+        stop();
+
+        m_records = records;
+        m_frames.clear();
+        m_recordedLatency = {};
+
+        std::deque<qint64> pending;
+
+        for (const auto &record: m_records) {
+            if (record.isFrame()) {
+                const auto withResponse = (record.type == SessionRecord::FrameRecord);
+
+                m_frames.push_back({record.timestamp, record.frame(), withResponse});
+
+                if (withResponse)
+                    pending.push_back(record.timestamp);
+            } else if (record.type == SessionRecord::AcknowledgementRecord && !pending.empty()) {
+                m_recordedLatency.add(record.timestamp - pending.front());
+                pending.pop_front();
+            }
+        }
+
+        emit q->recordsChanged();
+    }
+
+    QList<SessionRecord> records() const { return m_records; }
+    QString errorString() const { return m_errorString; }
+
+    void setTransport(RobotTransport *transport)
+    {
+        stop();
+        m_transport = transport;
+    }
+
+    RobotTransport *transport() const { return m_transport; }
+
+    void setTiming(Timing timing)
+    {
+        if (std::exchange(m_timing, timing) != timing)
+            emit q->timingChanged(m_timing);
+    }
+
+    Timing timing() const { return m_timing; }
+
+    bool isRunning() const { return m_running; }
+    int frameCount() const { return static_cast<int>(m_frames.size()); }
+    int framesReplayed() const { return m_next; }
+    double recordedLatency() const { return m_recordedLatency.milliseconds(); }
+    double replayedLatency() const { return m_replayedLatency.milliseconds(); }
+
+    bool start()
+    {
+        stop();
+
+        if (!m_transport || m_transport->state() != RobotService::ConnectedState) {
+            m_errorString = tr("The transport is not connected");
+            qCWarning(lcSessionReplayer, "%ls", qUtf16Printable(m_errorString));
+            return false;
+        }
+
+        m_next = 0;
+        m_pending.clear();
+        m_replayedLatency = {};
+        m_running = true;
+        m_clock.start();
+
+        m_connection = connect(m_transport, &RobotTransport::frameWritten, q, [this] { onFrameWritten(); });
+        emit q->runningChanged(m_running);
+        emit q->framesReplayedChanged(m_next);
+
+        scheduleNext();
+        return true;
+    }
+
+    void stop()
+    {
+        if (!m_running)
+            return;
+
+        m_timer.stop();
+        m_acknowledgementTimer.stop();
+        QObject::disconnect(m_connection);
+        m_running = false;
+
+        emit q->runningChanged(m_running);
+    }
+
+private:
+    void scheduleNext()
+    {
+        if (m_next >= frameCount()) {
+            if (m_pending.empty())
+                finish();
+            else
+                m_acknowledgementTimer.start(s_acknowledgementTimeout);
+
+            return;
+        }
+
+        if (m_timing == OriginalTiming) {
+            const auto offset = m_frames[static_cast<size_t>(m_next)].timestamp - m_frames.front().timestamp;
+            m_timer.start(static_cast<int>(qMax<qint64>(0, offset / 1000000 - m_clock.elapsed())));
+        } else if (m_pending.empty()) {
+            m_timer.start(0);
+        } else {
+            // writes with response are replayed one at a time
+            m_acknowledgementTimer.start(s_acknowledgementTimeout);
+        }
+    }
+
+    void writeNext()
+    {
+        if (!m_transport) {
+            stop();
+            return;
+        }
+
+        const auto &frame = m_frames[static_cast<size_t>(m_next++)];
+
+        if (frame.withResponse)
+            m_pending.push_back(m_clock.nsecsElapsed());
+
+        m_transport->writeFrame(frame.frame, frame.withResponse ? RobotTransport::WriteWithResponse
+                                                                : RobotTransport::WriteWithoutResponse);
+
+        emit q->framesReplayedChanged(m_next);
+        scheduleNext();
+    }
+
+    void onFrameWritten()
+    {
+        if (m_pending.empty())
+            return;
+
+        m_replayedLatency.add(m_clock.nsecsElapsed() - m_pending.front());
+        m_pending.pop_front();
+
+        if (m_timing == FastestTiming || m_next >= frameCount()) {
+            m_acknowledgementTimer.stop();
+            scheduleNext();
+        }
+    }
+
+    // a lost acknowledgement only delays the next write
+    void onAcknowledgementTimeout()
+    {
+        qCInfo(lcSessionReplayer, "%d acknowledgements missing", static_cast<int>(m_pending.size()));
+
+        m_pending.clear();
+        scheduleNext();
+    }
+
+    void finish()
+    {
+        qCInfo(lcSessionReplayer, "Replayed %d frames, latency %.1f ms recorded, %.1f ms replayed",
+               m_next, recordedLatency(), replayedLatency());
+
+        stop();
+        emit q->finished();
+    }
+
+    SessionReplayer *const q;
+
+    QList<SessionRecord> m_records;
+    std::vector<Frame> m_frames;
+    QString m_errorString;
+    QPointer<RobotTransport> m_transport;
+    QMetaObject::Connection m_connection;
+    Timing m_timing = OriginalTiming;
+
+    QTimer m_timer;
+    QTimer m_acknowledgementTimer;
+    QElapsedTimer m_clock;
+    std::deque<qint64> m_pending;
+    LatencyAverage m_recordedLatency;
+    LatencyAverage m_replayedLatency;
+    int m_next = 0;
+    bool m_running = false;
+};
+
+SessionReplayer::SessionReplayer(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+SessionReplayer::~SessionReplayer()
+{
+    delete d;
+}
+
+bool SessionReplayer::load(const QString &fileName)
+{
+    return d->load(fileName);
+}
+
+void SessionReplayer::setRecords(const QList<SessionRecord> &records)
+{
+    d->setRecords(records);
+}
+
+QList<SessionRecord> SessionReplayer::records() const
+{
+    return d->records();
+}
+
+QString SessionReplayer::errorString() const
+{
+    return d->errorString();
+}
+
+void SessionReplayer::setTransport(RobotTransport *transport)
+{
+    d->setTransport(transport);
+}
+
+RobotTransport *SessionReplayer::transport() const
+{
+    return d->transport();
+}
+
+void SessionReplayer::setTiming(Timing timing)
+{
+    d->setTiming(timing);
+}
+
+SessionReplayer::Timing SessionReplayer::timing() const
+{
+    return d->timing();
+}
+
+bool SessionReplayer::isRunning() const
+{
+    return d->isRunning();
+}
+
+int SessionReplayer::frameCount() const
+{
+    return d->frameCount();
+}
+
+int SessionReplayer::framesReplayed() const
+{
+    return d->framesReplayed();
+}
+
+double SessionReplayer::recordedLatency() const
+{
+    return d->recordedLatency();
+}
+
+double SessionReplayer::replayedLatency() const
+{
+    return d->replayedLatency();
+}
+
+bool SessionReplayer::start()
+{
+    return d->start();
+}
+
+void SessionReplayer::stop()
+{
+    d->stop();
+}
+
+} // namespace EvoBot
@@ -0,0 +1,72 @@
+#ifndef EVOBOT_SESSIONREPLAYER_H
+#define EVOBOT_SESSIONREPLAYER_H
+
+#include "sessionrecorder.h"
+
+namespace EvoBot {
+
+class RobotTransport;
+
+// Writes the frames of a session log to a transport, like the simulator or a connected robot,
+// either with their original timing or as fast as the writes get acknowledged. The write
+// latency measured during the replay can be compared with the one of the recorded session.
+class SessionReplayer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(Timing timing READ timing WRITE setTiming NOTIFY timingChanged FINAL)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged FINAL)
+    Q_PROPERTY(int frameCount READ frameCount NOTIFY recordsChanged FINAL)
+    Q_PROPERTY(double recordedLatency READ recordedLatency NOTIFY recordsChanged FINAL)
+    Q_PROPERTY(int framesReplayed READ framesReplayed NOTIFY framesReplayedChanged FINAL)
+    Q_PROPERTY(double replayedLatency READ replayedLatency NOTIFY framesReplayedChanged FINAL)
+
+public:
+    enum Timing {
+        OriginalTiming,
+        FastestTiming,
+    };
+
+    Q_ENUM(Timing)
+
+    explicit SessionReplayer(QObject *parent = {});
+    ~SessionReplayer() override;
+
+    bool load(const QString &fileName);
+    void setRecords(const QList<SessionRecord> &records);
+    QList<SessionRecord> records() const;
+    QString errorString() const;
+
+    // The replayer doesn't take ownership of the transport.
+    void setTransport(RobotTransport *transport);
+    RobotTransport *transport() const;
+
+    void setTiming(Timing timing);
+    Timing timing() const;
+
+    bool isRunning() const;
+    int frameCount() const;
+    int framesReplayed() const;
+
+    // Average milliseconds between a write with response and its acknowledgement.
+    double recordedLatency() const;
+    double replayedLatency() const;
+
+public slots:
+    bool start();
+    void stop();
+
+signals:
+    void timingChanged(EvoBot::SessionReplayer::Timing timing);
+    void runningChanged(bool running);
+    void recordsChanged();
+    void framesReplayedChanged(int framesReplayed);
+    void finished();
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_SESSIONREPLAYER_H
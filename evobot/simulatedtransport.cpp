@@ -0,0 +1,305 @@
+#include "simulatedtransport.h"
+
+#include "utilities.h"
+
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QTimer>
+
+namespace EvoBot {
+
+namespace {
+Q_LOGGING_CATEGORY(lcSimulatedTransport, "evobot.simulatedtransport", QtInfoMsg)
+
+const auto s_defaultWriteLatency = 15;
+const auto s_defaultSoundStartDelay = 20;
+const auto s_defaultSoundDuration = 1500;
+const auto s_firstSound = 21;
+
+} // namespace
+
+class SimulatedTransport::Private
+{
+public:
+    explicit Private(SimulatedTransport *q)
+        : q{q}
+    {}
+
+    void beginConnecting()
+    {
+        if (m_state == RobotService::DisconnectedState)
+            setState(RobotService::ConnectingState);
+    }
+
+    void connectToRobot(int firmwareRevision)
+    {
+        if (m_state == RobotService::ConnectedState)
+            return;
+
+        setState(RobotService::ConnectingState);
+
+        if (std::exchange(m_firmwareRevision, firmwareRevision) != firmwareRevision)
+            emit q->firmwareRevisionChanged(m_firmwareRevision);
+
+        setState(RobotService::ConnectedState);
+    }
+
+    void disconnectFromRobot()
+    {
+        ++m_generation;
+        ++m_soundGeneration;
+        setState(RobotService::DisconnectedState);
+    }
+
+    RobotService::State state() const { return m_state; }
+    int firmwareRevision() const { return m_firmwareRevision; }
+
+    void writeFrame(const RobotFrame &frame, WriteMode mode)
+    {
+        if (m_state != RobotService::ConnectedState)
+            return;
+
+        auto random = QRandomGenerator::global();
+
+        if (m_packetLoss > 0 && random->generateDouble() < m_packetLoss) {
+            qCDebug(lcSimulatedTransport, "Dropping frame");
+            return;
+        }
+
+        const auto latency = m_writeLatency + (m_writeJitter > 0 ? random->bounded(m_writeJitter + 1) : 0);
+        const auto generation = m_generation;
+
+        QTimer::singleShot(latency, Qt::PreciseTimer, q, [this, frame, mode, generation] {
+            if (generation == m_generation)
+                deliverFrame(frame, mode);
+        });
+    }
+
+    void setWriteLatency(int writeLatency)
+    {
+        if (std::exchange(m_writeLatency, writeLatency) != writeLatency)
+            emit q->writeLatencyChanged(m_writeLatency);
+    }
+
+    int writeLatency() const { return m_writeLatency; }
+
+    void setWriteJitter(int writeJitter)
+    {
+        if (std::exchange(m_writeJitter, writeJitter) != writeJitter)
+            emit q->writeJitterChanged(m_writeJitter);
+    }
+
+    int writeJitter() const { return m_writeJitter; }
+
+    void setPacketLoss(double packetLoss)
+    {
+        if (!qFuzzyCompare(std::exchange(m_packetLoss, packetLoss) + 1, packetLoss + 1))
+            emit q->packetLossChanged(m_packetLoss);
+    }
+
+    double packetLoss() const { return m_packetLoss; }
+
+    void setSoundStartDelay(int soundStartDelay)
+    {
+        if (std::exchange(m_soundStartDelay, soundStartDelay) != soundStartDelay)
+            emit q->soundStartDelayChanged(m_soundStartDelay);
+    }
+
+    int soundStartDelay() const { return m_soundStartDelay; }
+
+    void setSoundDuration(int soundDuration)
+    {
+        if (std::exchange(m_soundDuration, soundDuration) != soundDuration)
+            emit q->soundDurationChanged(m_soundDuration);
+    }
+
+    int soundDuration() const { return m_soundDuration; }
+
+    void setWriteWithoutResponseSupported(bool supported)
+    {
+        if (std::exchange(m_writeWithoutResponseSupported, supported) != supported)
+            emit q->writeWithoutResponseSupportedChanged(m_writeWithoutResponseSupported);
+    }
+
+    bool isWriteWithoutResponseSupported() const { return m_writeWithoutResponseSupported; }
+
+    RobotFrame currentFrame() const { return m_currentFrame; }
+    int framesReceived() const { return m_framesReceived; }
+
+private:
+    void setState(RobotService::State state)
+    {
+        const auto oldState = std::exchange(m_state, state);
+
+        if (oldState != state) {
+            qCInfo(lcSimulatedTransport, "state changed: %s => %s", key(oldState), key(state));
+            emit q->stateChanged(state, oldState);
+        }
+    }
+
+    void deliverFrame(const RobotFrame &frame, WriteMode mode)
+    {
+        const auto previousFrame = std::exchange(m_currentFrame, frame);
+
+        ++m_framesReceived;
+        emit q->currentFrameChanged(m_currentFrame);
+
+        if (mode == WriteWithResponse)
+            emit q->frameWritten(frame);
+
+        if (frame.sound() >= s_firstSound && frame.sound() != previousFrame.sound())
+            playSound(frame.sound() - s_firstSound);
+    }
+
+    void playSound(int index)
+    {
+        // a new sound interrupts the one currently playing, like on the real robot
+        const auto generation = ++m_soundGeneration;
+
+        QTimer::singleShot(m_soundStartDelay, q, [this, index, generation] {
+            if (generation != m_soundGeneration)
+                return;
+
+            emit q->notificationReceived("V" + QByteArray::number(index) + "Play");
+
+            QTimer::singleShot(m_soundDuration, q, [this, index, generation] {
+                if (generation == m_soundGeneration)
+                    emit q->notificationReceived("V" + QByteArray::number(index) + "End");
+            });
+        });
+    }
+
+    SimulatedTransport *const q;
+
+    RobotService::State m_state = RobotService::DisconnectedState;
+    int m_firmwareRevision = -1;
+    int m_generation = 0;
+    int m_soundGeneration = 0;
+
+    int m_writeLatency = s_defaultWriteLatency;
+    int m_writeJitter = 0;
+    double m_packetLoss = 0;
+    int m_soundStartDelay = s_defaultSoundStartDelay;
+    int m_soundDuration = s_defaultSoundDuration;
+    bool m_writeWithoutResponseSupported = true;
+
+    RobotFrame m_currentFrame = RobotFrame::pause();
+    int m_framesReceived = 0;
+};
+
+SimulatedTransport::SimulatedTransport(QObject *parent)
+    : RobotTransport{parent}
+    , d{new Private{this}}
+{}
+
+SimulatedTransport::~SimulatedTransport()
+{
+    delete d;
+}
+
+void SimulatedTransport::beginConnecting()
+{
+    d->beginConnecting();
+}
+
+void SimulatedTransport::connectToRobot(int firmwareRevision)
+{
+    d->connectToRobot(firmwareRevision);
+}
+
+void SimulatedTransport::disconnectFromRobot()
+{
+    d->disconnectFromRobot();
+}
+
+RobotService::State SimulatedTransport::state() const
+{
+    return d->state();
+}
+
+int SimulatedTransport::firmwareRevision() const
+{
+    return d->firmwareRevision();
+}
+
+bool SimulatedTransport::canWriteWithoutResponse() const
+{
+    return d->isWriteWithoutResponseSupported();
+}
+
+void SimulatedTransport::writeFrame(const RobotFrame &frame, WriteMode mode)
+{
+    d->writeFrame(frame, mode);
+}
+
+void SimulatedTransport::setWriteLatency(int writeLatency)
+{
+    d->setWriteLatency(qMax(0, writeLatency));
+}
+
+int SimulatedTransport::writeLatency() const
+{
+    return d->writeLatency();
+}
+
+void SimulatedTransport::setWriteJitter(int writeJitter)
+{
+    d->setWriteJitter(qMax(0, writeJitter));
+}
+
+int SimulatedTransport::writeJitter() const
+{
+    return d->writeJitter();
+}
+
+void SimulatedTransport::setPacketLoss(double packetLoss)
+{
+    d->setPacketLoss(qBound(0.0, packetLoss, 1.0));
+}
+
+double SimulatedTransport::packetLoss() const
+{
+    return d->packetLoss();
+}
+
+void SimulatedTransport::setSoundStartDelay(int soundStartDelay)
+{
+    d->setSoundStartDelay(qMax(0, soundStartDelay));
+}
+
+int SimulatedTransport::soundStartDelay() const
+{
+    return d->soundStartDelay();
+}
+
+void SimulatedTransport::setSoundDuration(int soundDuration)
+{
+    d->setSoundDuration(qMax(0, soundDuration));
+}
+
+int SimulatedTransport::soundDuration() const
+{
+    return d->soundDuration();
+}
+
+void SimulatedTransport::setWriteWithoutResponseSupported(bool supported)
+{
+    d->setWriteWithoutResponseSupported(supported);
+}
+
+bool SimulatedTransport::isWriteWithoutResponseSupported() const
+{
+    return d->isWriteWithoutResponseSupported();
+}
+
+RobotFrame SimulatedTransport::currentFrame() const
+{
+    return d->currentFrame();
+}
+
+int SimulatedTransport::framesReceived() const
+{
+    return d->framesReceived();
+}
+
+} // namespace EvoBot
@@ -0,0 +1,76 @@
+#ifndef EVOBOT_SIMULATEDTRANSPORT_H
+#define EVOBOT_SIMULATEDTRANSPORT_H
+
+#include "robottransport.h"
+
+namespace EvoBot {
+
+// An offline robot, which acknowledges writes after a configurable latency, loses
+// some of them, and sends V<n>Play and V<n>End notifications for the played sounds.
+class SimulatedTransport : public RobotTransport
+{
+    Q_OBJECT
+    Q_PROPERTY(int writeLatency READ writeLatency WRITE setWriteLatency NOTIFY writeLatencyChanged FINAL)
+    Q_PROPERTY(int writeJitter READ writeJitter WRITE setWriteJitter NOTIFY writeJitterChanged FINAL)
+    Q_PROPERTY(double packetLoss READ packetLoss WRITE setPacketLoss NOTIFY packetLossChanged FINAL)
+    Q_PROPERTY(int soundStartDelay READ soundStartDelay WRITE setSoundStartDelay NOTIFY soundStartDelayChanged FINAL)
+    Q_PROPERTY(int soundDuration READ soundDuration WRITE setSoundDuration NOTIFY soundDurationChanged FINAL)
+    Q_PROPERTY(bool writeWithoutResponseSupported READ isWriteWithoutResponseSupported
+               WRITE setWriteWithoutResponseSupported NOTIFY writeWithoutResponseSupportedChanged FINAL)
+    Q_PROPERTY(EvoBot::RobotFrame currentFrame READ currentFrame NOTIFY currentFrameChanged FINAL)
+    Q_PROPERTY(int framesReceived READ framesReceived NOTIFY currentFrameChanged FINAL)
+
+public:
+    explicit SimulatedTransport(QObject *parent = {});
+    ~SimulatedTransport() override;
+
+    // Starts a connection attempt, which connectToRobot() completes and disconnectFromRobot() fails.
+    void beginConnecting();
+    void connectToRobot(int firmwareRevision = 2);
+    void disconnectFromRobot();
+
+    RobotService::State state() const override;
+    int firmwareRevision() const override;
+    bool canWriteWithoutResponse() const override;
+
+    void writeFrame(const RobotFrame &frame, WriteMode mode) override;
+
+    void setWriteLatency(int writeLatency);
+    int writeLatency() const;
+
+    void setWriteJitter(int writeJitter);
+    int writeJitter() const;
+
+    void setPacketLoss(double packetLoss);
+    double packetLoss() const;
+
+    void setSoundStartDelay(int soundStartDelay);
+    int soundStartDelay() const;
+
+    void setSoundDuration(int soundDuration);
+    int soundDuration() const;
+
+    // Like robots whose write characteristic lacks WriteNoResponse, when disabled.
+    void setWriteWithoutResponseSupported(bool supported);
+    bool isWriteWithoutResponseSupported() const;
+
+    RobotFrame currentFrame() const;
+    int framesReceived() const;
+
+signals:
+    void writeLatencyChanged(int writeLatency);
+    void writeJitterChanged(int writeJitter);
+    void packetLossChanged(double packetLoss);
+    void soundStartDelayChanged(int soundStartDelay);
+    void soundDurationChanged(int soundDuration);
+    void writeWithoutResponseSupportedChanged(bool supported);
+    void currentFrameChanged(const EvoBot::RobotFrame &currentFrame);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_SIMULATEDTRANSPORT_H
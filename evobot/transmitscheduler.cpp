@@ -0,0 +1,503 @@
+#include "transmitscheduler.h"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcTransmitScheduler, "evobot.transmitscheduler", QtInfoMsg)
+
+const auto s_defaultMinimumInterval = 100ms;
+const auto s_defaultKeepAliveInterval = 400ms;
+const auto s_acknowledgeTimeout = 1000ms;
+const auto s_defaultIdleKeepAliveInterval = 2000ms;
+const auto s_defaultCosmeticInterval = 0ms;
+
+} // namespace
+
+class TransmitScheduler::Private
+{
+public:
+    explicit Private(TransmitScheduler *q)
+        : q{q}
+    {
+        m_timer.setSingleShot(true);
+        m_timer.setTimerType(Qt::PreciseTimer);
+        connect(&m_timer, &QTimer::timeout, q, [this] { onTimeout(); });
+
+        m_idleTimer.setSingleShot(true);
+        connect(&m_idleTimer, &QTimer::timeout, q, [this] { onIdleTimeout(); });
+
+        m_cosmeticTimer.setSingleShot(true);
+        m_cosmeticTimer.setTimerType(Qt::PreciseTimer);
+        connect(&m_cosmeticTimer, &QTimer::timeout, q, [this] { onCosmeticTimeout(); });
+    }
+
+    void start()
+    {
+        if (std::exchange(m_active, true))
+            return;
+
+        m_writePending = false;
+        m_dirty = false;
+        m_urgent = false;
+        setInterval(q->nextInterval(MessageChanged, m_interval));
+        restartIdleTimer();
+        emit q->activeChanged(m_active);
+        emit q->transmitRequested(MessageChanged);
+    }
+
+    void stop()
+    {
+        if (!std::exchange(m_active, false))
+            return;
+
+        m_timer.stop();
+        m_idleTimer.stop();
+        m_cosmeticTimer.stop();
+        m_cosmeticClock.invalidate();
+        m_writePending = false;
+        m_dirty = false;
+        m_urgent = false;
+        setIdle(false);
+        emit q->activeChanged(m_active);
+    }
+
+    bool isActive() const { return m_active; }
+    bool isWritePending() const { return m_writePending; }
+
+    void messageChanged(Priority priority)
+    {
+        if (!m_active)
+            return;
+
+        setIdle(false);
+        restartIdleTimer();
+        setInterval(q->nextInterval(MessageChanged, m_interval));
+
+        // Only one write is in flight at a time, so that every acknowledgement belongs to the
+        // latest write. A stop therefore waits for the pending write, but then goes out right
+        // away, and since the frame always carries the complete state it also delivers every
+        // change that still was waiting.
+        if (priority == StopPriority) {
+            m_cosmeticTimer.stop();
+
+            if (m_writePending) {
+                m_dirty = true;
+                m_urgent = true;
+            } else {
+                emit q->transmitRequested(UrgentChange);
+            }
+
+            return;
+        }
+
+        if (m_writePending) {
+            m_dirty = true;
+            return;
+        }
+
+        // Measured from the last cosmetic change only: keep-alives and other changes get
+        // written at times unrelated to this one, and would delay it by a random amount.
+        if (priority == CosmeticPriority && m_cosmeticInterval.count() > 0) {
+            const auto elapsed = std::chrono::milliseconds{m_cosmeticClock.isValid() ? m_cosmeticClock.elapsed() : -1};
+
+            if (elapsed.count() >= 0 && elapsed < m_cosmeticInterval) {
+                if (!m_cosmeticTimer.isActive())
+                    m_cosmeticTimer.start(m_cosmeticInterval - elapsed);
+
+                return;
+            }
+
+            m_cosmeticClock.start();
+        }
+
+        m_cosmeticTimer.stop();
+        emit q->transmitRequested(MessageChanged);
+    }
+
+    void writeIssued()
+    {
+        m_writePending = true;
+        m_dirty = false;
+        m_urgent = false;
+        m_writeTimer.start();
+        m_cosmeticTimer.stop();
+
+        if (m_active)
+            m_timer.start(s_acknowledgeTimeout);
+    }
+
+    void writeAcknowledged()
+    {
+        if (!std::exchange(m_writePending, false))
+            return;
+
+        updateRoundTripTime(std::chrono::milliseconds{m_writeTimer.elapsed()});
+
+        if (!m_active)
+            return;
+
+        if (m_dirty)
+            emit q->transmitRequested(std::exchange(m_urgent, false) ? UrgentChange : MessageChanged);
+        else
+            scheduleKeepAlive();
+    }
+
+    void writeCompleted()
+    {
+        m_writePending = false;
+        m_dirty = false;
+        m_urgent = false;
+        m_cosmeticTimer.stop();
+
+        if (m_active)
+            scheduleKeepAlive();
+    }
+
+    void setPaused(bool paused)
+    {
+        if (std::exchange(m_paused, paused) != paused) {
+            if (!m_paused)
+                setIdle(false);
+
+            restartIdleTimer();
+        }
+    }
+
+    bool isPaused() const { return m_paused; }
+    bool isIdle() const { return m_idle; }
+
+    void setIdleTimeout(std::chrono::milliseconds idleTimeout)
+    {
+        if (std::exchange(m_idleTimeout, idleTimeout) != idleTimeout) {
+            if (m_idleTimeout.count() == 0)
+                setIdle(false);
+
+            restartIdleTimer();
+            emit q->idleTimeoutChanged(static_cast<int>(m_idleTimeout.count()));
+        }
+    }
+
+    std::chrono::milliseconds idleTimeout() const { return m_idleTimeout; }
+
+    void setIdleKeepAliveInterval(std::chrono::milliseconds idleKeepAliveInterval)
+    {
+        if (std::exchange(m_idleKeepAliveInterval, idleKeepAliveInterval) != idleKeepAliveInterval)
+            emit q->idleKeepAliveIntervalChanged(static_cast<int>(m_idleKeepAliveInterval.count()));
+    }
+
+    std::chrono::milliseconds idleKeepAliveInterval() const { return m_idleKeepAliveInterval; }
+
+    void setCosmeticInterval(std::chrono::milliseconds cosmeticInterval)
+    {
+        if (std::exchange(m_cosmeticInterval, cosmeticInterval) != cosmeticInterval)
+            emit q->cosmeticIntervalChanged(static_cast<int>(m_cosmeticInterval.count()));
+    }
+
+    std::chrono::milliseconds cosmeticInterval() const { return m_cosmeticInterval; }
+
+    std::chrono::milliseconds interval() const { return m_interval; }
+    std::chrono::milliseconds roundTripTime() const { return m_roundTripTime; }
+
+    void setMinimumInterval(std::chrono::milliseconds minimumInterval)
+    {
+        if (std::exchange(m_minimumInterval, minimumInterval) != minimumInterval)
+            emit q->minimumIntervalChanged(static_cast<int>(m_minimumInterval.count()));
+    }
+
+    std::chrono::milliseconds minimumInterval() const { return m_minimumInterval; }
+
+    void setKeepAliveInterval(std::chrono::milliseconds keepAliveInterval)
+    {
+        if (std::exchange(m_keepAliveInterval, keepAliveInterval) != keepAliveInterval)
+            emit q->keepAliveIntervalChanged(static_cast<int>(m_keepAliveInterval.count()));
+    }
+
+    std::chrono::milliseconds keepAliveInterval() const { return m_keepAliveInterval; }
+
+    void setConnectionInterval(std::chrono::milliseconds connectionInterval)
+    {
+        if (std::exchange(m_connectionInterval, connectionInterval) != connectionInterval)
+            emit q->connectionIntervalChanged(static_cast<int>(m_connectionInterval.count()));
+    }
+
+    std::chrono::milliseconds connectionInterval() const { return m_connectionInterval; }
+
+    std::chrono::milliseconds effectiveMinimumInterval() const
+    {
+        return std::max({m_minimumInterval, m_roundTripTime, m_connectionInterval});
+    }
+
+private:
+    void scheduleKeepAlive()
+    {
+        if (!m_idle)
+            m_timer.start(m_interval);
+        else if (m_idleKeepAliveInterval.count() > 0)
+            m_timer.start(std::max(m_interval, m_idleKeepAliveInterval));
+        else
+            m_timer.stop();
+    }
+
+    void restartIdleTimer()
+    {
+        if (m_active && m_paused && !m_idle && m_idleTimeout.count() > 0)
+            m_idleTimer.start(m_idleTimeout);
+        else
+            m_idleTimer.stop();
+    }
+
+    void setIdle(bool idle)
+    {
+        if (std::exchange(m_idle, idle) == idle)
+            return;
+
+        qCDebug(lcTransmitScheduler, m_idle ? "Robot is idle, reducing keep-alives" : "Robot is active again");
+
+        // a pending write reschedules the keep-alive once it completes
+        if (m_active && !m_writePending && !m_idle)
+            m_timer.start(m_interval);
+
+        emit q->idleChanged(m_idle);
+    }
+
+    void onIdleTimeout()
+    {
+        setIdle(true);
+
+        if (!m_writePending)
+            scheduleKeepAlive();
+    }
+
+    void onCosmeticTimeout()
+    {
+        m_cosmeticClock.start();
+
+        if (m_writePending)
+            m_dirty = true;
+        else
+            emit q->transmitRequested(MessageChanged);
+    }
+
+    void setInterval(std::chrono::milliseconds interval)
+    {
+        if (std::exchange(m_interval, interval) != interval)
+            emit q->intervalChanged(static_cast<int>(m_interval.count()));
+    }
+
+    void updateRoundTripTime(std::chrono::milliseconds sample)
+    {
+        // exponentially weighted moving average, like TCP's SRTT with alpha=1/8
+        const auto roundTripTime = m_roundTripTime.count() > 0 ? (7 * m_roundTripTime + sample) / 8 : sample;
+
+        if (std::exchange(m_roundTripTime, roundTripTime) != roundTripTime)
+            emit q->roundTripTimeChanged(static_cast<int>(m_roundTripTime.count()));
+    }
+
+    void onTimeout()
+    {
+        if (m_writePending) {
+            qCWarning(lcTransmitScheduler, "Write was not acknowledged within %d ms, retrying",
+                      static_cast<int>(s_acknowledgeTimeout.count()));
+
+            m_writePending = false;
+            emit q->writeLost();
+
+            if (std::exchange(m_dirty, false))
+                emit q->transmitRequested(std::exchange(m_urgent, false) ? UrgentChange : MessageChanged);
+            else
+                emit q->transmitRequested(KeepAlive);
+
+            return;
+        }
+
+        if (!m_idle)
+            setInterval(q->nextInterval(KeepAlive, m_interval));
+
+        emit q->transmitRequested(KeepAlive);
+    }
+
+    TransmitScheduler *const q;
+
+    bool m_active = false;
+    bool m_writePending = false;
+    bool m_dirty = false;
+    bool m_urgent = false;
+    bool m_paused = false;
+    bool m_idle = false;
+
+    std::chrono::milliseconds m_interval = s_defaultMinimumInterval;
+    std::chrono::milliseconds m_roundTripTime = 0ms;
+    std::chrono::milliseconds m_minimumInterval = s_defaultMinimumInterval;
+    std::chrono::milliseconds m_keepAliveInterval = s_defaultKeepAliveInterval;
+    std::chrono::milliseconds m_connectionInterval = 0ms;
+    std::chrono::milliseconds m_idleTimeout = 0ms;
+    std::chrono::milliseconds m_idleKeepAliveInterval = s_defaultIdleKeepAliveInterval;
+    std::chrono::milliseconds m_cosmeticInterval = s_defaultCosmeticInterval;
+
+    QElapsedTimer m_writeTimer;
+    QElapsedTimer m_cosmeticClock;
+    QTimer m_timer;
+    QTimer m_idleTimer;
+    QTimer m_cosmeticTimer;
+};
+
+TransmitScheduler::TransmitScheduler(QObject *parent)
+    : QObject{parent}
+    , d{new Private{this}}
+{}
+
+TransmitScheduler::~TransmitScheduler()
+{
+    delete d;
+}
+
+void TransmitScheduler::start()
+{
+    d->start();
+}
+
+void TransmitScheduler::stop()
+{
+    d->stop();
+}
+
+bool TransmitScheduler::isActive() const
+{
+    return d->isActive();
+}
+
+void TransmitScheduler::messageChanged(Priority priority)
+{
+    d->messageChanged(priority);
+}
+
+void TransmitScheduler::writeIssued()
+{
+    d->writeIssued();
+}
+
+void TransmitScheduler::writeAcknowledged()
+{
+    d->writeAcknowledged();
+}
+
+void TransmitScheduler::writeCompleted()
+{
+    d->writeCompleted();
+}
+
+bool TransmitScheduler::isWritePending() const
+{
+    return d->isWritePending();
+}
+
+int TransmitScheduler::interval() const
+{
+    return static_cast<int>(d->interval().count());
+}
+
+int TransmitScheduler::roundTripTime() const
+{
+    return static_cast<int>(d->roundTripTime().count());
+}
+
+void TransmitScheduler::setMinimumInterval(int minimumInterval)
+{
+    d->setMinimumInterval(std::chrono::milliseconds{qMax(0, minimumInterval)});
+}
+
+int TransmitScheduler::minimumInterval() const
+{
+    return static_cast<int>(d->minimumInterval().count());
+}
+
+void TransmitScheduler::setKeepAliveInterval(int keepAliveInterval)
+{
+    d->setKeepAliveInterval(std::chrono::milliseconds{qMax(0, keepAliveInterval)});
+}
+
+int TransmitScheduler::keepAliveInterval() const
+{
+    return static_cast<int>(d->keepAliveInterval().count());
+}
+
+void TransmitScheduler::setConnectionInterval(int connectionInterval)
+{
+    d->setConnectionInterval(std::chrono::milliseconds{qMax(0, connectionInterval)});
+}
+
+int TransmitScheduler::connectionInterval() const
+{
+    return static_cast<int>(d->connectionInterval().count());
+}
+
+int TransmitScheduler::effectiveMinimumInterval() const
+{
+    return static_cast<int>(d->effectiveMinimumInterval().count());
+}
+
+void TransmitScheduler::setPaused(bool paused)
+{
+    d->setPaused(paused);
+}
+
+bool TransmitScheduler::isPaused() const
+{
+    return d->isPaused();
+}
+
+bool TransmitScheduler::isIdle() const
+{
+    return d->isIdle();
+}
+
+void TransmitScheduler::setIdleTimeout(int idleTimeout)
+{
+    d->setIdleTimeout(std::chrono::milliseconds{qMax(0, idleTimeout)});
+}
+
+int TransmitScheduler::idleTimeout() const
+{
+    return static_cast<int>(d->idleTimeout().count());
+}
+
+void TransmitScheduler::setIdleKeepAliveInterval(int idleKeepAliveInterval)
+{
+    d->setIdleKeepAliveInterval(std::chrono::milliseconds{qMax(0, idleKeepAliveInterval)});
+}
+
+int TransmitScheduler::idleKeepAliveInterval() const
+{
+    return static_cast<int>(d->idleKeepAliveInterval().count());
+}
+
+void TransmitScheduler::setCosmeticInterval(int cosmeticInterval)
+{
+    d->setCosmeticInterval(std::chrono::milliseconds{qMax(0, cosmeticInterval)});
+}
+
+int TransmitScheduler::cosmeticInterval() const
+{
+    return static_cast<int>(d->cosmeticInterval().count());
+}
+
+std::chrono::milliseconds TransmitScheduler::nextInterval(Reason reason, std::chrono::milliseconds current) const
+{
+    const auto minimumInterval = d->effectiveMinimumInterval();
+    const auto keepAliveInterval = std::max(minimumInterval, d->keepAliveInterval());
+
+    if (reason != KeepAlive)
+        return minimumInterval;
+
+    return qBound(minimumInterval, 2 * current, keepAliveInterval);
+}
+
+} // namespace EvoBot
@@ -0,0 +1,129 @@
+#ifndef EVOBOT_TRANSMITSCHEDULER_H
+#define EVOBOT_TRANSMITSCHEDULER_H
+
+#include <QObject>
+
+#include <chrono>
+
+namespace EvoBot {
+
+class TransmitScheduler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged FINAL)
+    Q_PROPERTY(int interval READ interval NOTIFY intervalChanged FINAL)
+    Q_PROPERTY(int roundTripTime READ roundTripTime NOTIFY roundTripTimeChanged FINAL)
+    Q_PROPERTY(int minimumInterval READ minimumInterval WRITE setMinimumInterval NOTIFY minimumIntervalChanged FINAL)
+    Q_PROPERTY(int keepAliveInterval READ keepAliveInterval WRITE setKeepAliveInterval NOTIFY keepAliveIntervalChanged FINAL)
+    Q_PROPERTY(int connectionInterval READ connectionInterval WRITE setConnectionInterval NOTIFY connectionIntervalChanged FINAL)
+    Q_PROPERTY(bool idle READ isIdle NOTIFY idleChanged FINAL)
+    Q_PROPERTY(int idleTimeout READ idleTimeout WRITE setIdleTimeout NOTIFY idleTimeoutChanged FINAL)
+    Q_PROPERTY(int idleKeepAliveInterval READ idleKeepAliveInterval WRITE setIdleKeepAliveInterval NOTIFY idleKeepAliveIntervalChanged FINAL)
+    Q_PROPERTY(int cosmeticInterval READ cosmeticInterval WRITE setCosmeticInterval NOTIFY cosmeticIntervalChanged FINAL)
+
+public:
+    // UrgentChange requests the transmission of a stop, which shouldn't be delayed any further.
+    enum Reason {
+        MessageChanged,
+        KeepAlive,
+        UrgentChange,
+    };
+
+    Q_ENUM(Reason)
+
+    // The priority of a change, from the most to the least urgent. Stops are transmitted right
+    // away, or as soon as the pending write got acknowledged, and take any change still waiting
+    // along. Changes that only touch cosmetic fields are rate-limited by the cosmetic interval.
+    enum Priority {
+        StopPriority,
+        MotionPriority,
+        ActuatorPriority,
+        CosmeticPriority,
+    };
+
+    Q_ENUM(Priority)
+
+    explicit TransmitScheduler(QObject *parent = {});
+    ~TransmitScheduler() override;
+
+    void start();
+    void stop();
+    bool isActive() const;
+
+    // Called by the RobotService whenever the current message changes,
+    // after a write was issued, and once that write got acknowledged.
+    // Writes that never get acknowledged are reported by writeCompleted().
+    void messageChanged(Priority priority = MotionPriority);
+    void writeIssued();
+    void writeAcknowledged();
+    void writeCompleted();
+
+    // Called by the RobotService when the current message becomes, or stops being, the pause message.
+    void setPaused(bool paused);
+    bool isPaused() const;
+
+    bool isWritePending() const;
+
+    int interval() const;
+    int roundTripTime() const;
+
+    void setMinimumInterval(int minimumInterval);
+    int minimumInterval() const;
+
+    void setKeepAliveInterval(int keepAliveInterval);
+    int keepAliveInterval() const;
+
+    // The link layer's connection interval, as negotiated with the robot. Frames cannot
+    // reach the robot more often than this, zero means the interval is unknown.
+    void setConnectionInterval(int connectionInterval);
+    int connectionInterval() const;
+
+    // The shortest interval between two transmissions, considering the minimum
+    // interval, the round trip time and the connection interval.
+    int effectiveMinimumInterval() const;
+
+    // After the message stayed paused for the idle timeout, keep-alives are only sent with the
+    // idle keep-alive interval, or not at all if that is zero. The next change resumes the full
+    // rate. An idle timeout of zero disables the idle policy.
+    bool isIdle() const;
+
+    void setIdleTimeout(int idleTimeout);
+    int idleTimeout() const;
+
+    void setIdleKeepAliveInterval(int idleKeepAliveInterval);
+    int idleKeepAliveInterval() const;
+
+    // The shortest interval between two cosmetic-only changes, the default of zero
+    // treats cosmetic changes like any other change.
+    void setCosmeticInterval(int cosmeticInterval);
+    int cosmeticInterval() const;
+
+signals:
+    void transmitRequested(EvoBot::TransmitScheduler::Reason reason);
+    void writeLost();
+
+    void activeChanged(bool active);
+    void intervalChanged(int interval);
+    void roundTripTimeChanged(int roundTripTime);
+    void minimumIntervalChanged(int minimumInterval);
+    void keepAliveIntervalChanged(int keepAliveInterval);
+    void connectionIntervalChanged(int connectionInterval);
+    void idleChanged(bool idle);
+    void idleTimeoutChanged(int idleTimeout);
+    void idleKeepAliveIntervalChanged(int idleKeepAliveInterval);
+    void cosmeticIntervalChanged(int cosmeticInterval);
+
+protected:
+    // Computes the delay until the next keep-alive transmission. The default
+    // policy resends soon after a change, and then exponentially backs off
+    // until reaching the keep-alive interval. Override for other policies.
+    virtual std::chrono::milliseconds nextInterval(Reason reason, std::chrono::milliseconds current) const;
+
+private:
+    class Private;
+    Private *const d;
+};
+
+} // namespace EvoBot
+
+#endif // EVOBOT_TRANSMITSCHEDULER_H
@@ -0,0 +1,84 @@
+#include "utilities.h"
+
+#include <algorithm>
+
+namespace EvoBot {
+
+namespace {
+
+// larger ranges of values are looked up by hash instead of by index
+const auto s_maximumDenseRange = 256;
+
+} // namespace
+
+EnumKeys::EnumKeys(const QMetaObject *metaObject, const char *enumName)
+    : m_metaEnum{metaObject->enumerator(metaObject->indexOfEnumerator(enumName))}
+{
+    const auto count = m_metaEnum.keyCount();
+
+    if (count == 0)
+        return;
+
+    auto minimum = m_metaEnum.value(0);
+    auto maximum = minimum;
+
+    for (auto i = 0; i < count; ++i) {
+        const auto value = m_metaEnum.value(i);
+
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        m_values.insert(m_metaEnum.key(i), value);
+    }
+
+    if (static_cast<qint64>(maximum) - minimum < s_maximumDenseRange) {
+        m_minimum = minimum;
+        m_denseKeys.resize(static_cast<size_t>(maximum - minimum + 1));
+    }
+
+    // iterate backwards so that aliases resolve to the first key, like QMetaEnum::valueToKey()
+    for (auto i = count - 1; i >= 0; --i) {
+        const auto value = m_metaEnum.value(i);
+
+        if (!m_denseKeys.empty())
+            m_denseKeys[static_cast<size_t>(value - m_minimum)] = m_metaEnum.key(i);
+        else
+            m_sparseKeys.insert(value, m_metaEnum.key(i));
+    }
+}
+
+const char *EnumKeys::key(int value) const
+{
+    if (m_denseKeys.empty())
+        return m_sparseKeys.value(value);
+
+    const auto index = static_cast<qint64>(value) - m_minimum;
+
+    if (index < 0 || index >= static_cast<qint64>(m_denseKeys.size()))
+        return nullptr;
+
+    return m_denseKeys[static_cast<size_t>(index)];
+}
+
+int EnumKeys::value(const QByteArray &key, bool *ok) const
+{
+    const auto it = m_values.constFind(key);
+    const auto found = (it != m_values.constEnd());
+
+    if (ok)
+        *ok = found;
+
+    return found ? *it : -1;
+}
+
+std::chrono::milliseconds backoffDelay(int failedAttempts, std::chrono::milliseconds minimum,
+                                       std::chrono::milliseconds maximum)
+{
+    auto delay = minimum;
+
+    for (; failedAttempts > 0 && delay < maximum; --failedAttempts)
+        delay *= 2;
+
+    return std::min(delay, maximum);
+}
+
+} // namespace EvoBot
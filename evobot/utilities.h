@@ -0,0 +1,58 @@
+#ifndef UTILITIES_H
+#define UTILITIES_H
+
+#include <QHash>
+#include <QMetaEnum>
+
+#include <chrono>
+#include <vector>
+
+namespace EvoBot {
+
+// The keys of an enumeration, indexed once so that lookups in either direction
+// don't need to search the meta object. Use enumKeys<T>() to get the shared table.
+class EnumKeys
+{
+public:
+    EnumKeys(const QMetaObject *metaObject, const char *enumName);
+
+    const char *key(int value) const;
+    int value(const QByteArray &key, bool *ok = nullptr) const;
+
+    QMetaEnum metaEnum() const { return m_metaEnum; }
+
+private:
+    QMetaEnum m_metaEnum;
+    int m_minimum = 0;
+    std::vector<const char *> m_denseKeys;
+    QHash<int, const char *> m_sparseKeys;
+    QHash<QByteArray, int> m_values;
+};
+
+template<typename T>
+const EnumKeys &enumKeys(typename std::enable_if<std::is_enum<T>::value>::type * = {})
+{
+    static const EnumKeys keys{qt_getEnumMetaObject(T{}), qt_getEnumName(T{})};
+    return keys;
+}
+
+template<typename T>
+const char *key(T value, typename std::enable_if<std::is_enum<T>::value>::type * = {})
+{
+    return enumKeys<T>().key(static_cast<int>(value));
+}
+
+template<typename T>
+T keyToValue(const QByteArray &key, bool *ok = nullptr, typename std::enable_if<std::is_enum<T>::value>::type * = {})
+{
+    return static_cast<T>(enumKeys<T>().value(key, ok));
+}
+
+// The delay before the next attempt after the given number of failed attempts. Starts with
+// the minimum delay and doubles with each failed attempt, until reaching the maximum delay.
+std::chrono::milliseconds backoffDelay(int failedAttempts, std::chrono::milliseconds minimum,
+                                       std::chrono::milliseconds maximum);
+
+} // namespace EvoBot
+
+#endif // UTILITIES_H
@@ -0,0 +1,6 @@
+TARGET = tst_actionmodel
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_actionmodel.cpp
@@ -0,0 +1,159 @@
+#include "actionencoding.h"
+#include "actionmodel.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+// the drive actions come first, followed by the arm, claw, pause, eyes and sounds
+const auto s_forward2Row = 10;
+const auto s_pauseRow = 20;
+const auto s_eyes3Row = 24;
+
+QVariant data(const ActionModel &model, int row, int role)
+{
+    return model.data(model.index(row), role);
+}
+
+RobotFrame withAction(RobotFrame frame, const ActionEncoding::Fragment &fragment)
+{
+    frame.setAt(fragment.offset, fragment.value);
+    return frame;
+}
+
+QList<int> activeRows(const ActionModel &model)
+{
+    QList<int> rows;
+
+    for (auto row = 0; row < model.rowCount(); ++row) {
+        if (data(model, row, ActionModel::ActiveRole).toBool())
+            rows.append(row);
+    }
+
+    return rows;
+}
+
+} // namespace
+
+class ActionModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rowCount();
+    void roles();
+    void activeState();
+    void firmwareRevision();
+};
+
+void ActionModelTest::rowCount()
+{
+    const ActionModel model;
+
+    QCOMPARE(model.count(), 59);
+    QCOMPARE(model.rowCount(), model.count());
+    QCOMPARE(model.rowCount(model.index(0)), 0);
+    QVERIFY(!model.index(model.count()).isValid());
+    QVERIFY(!data(model, model.count(), ActionModel::LabelRole).isValid());
+}
+
+void ActionModelTest::roles()
+{
+    const ActionModel model;
+
+    const auto roleNames = model.roleNames();
+    QCOMPARE(roleNames.value(ActionModel::ActionRole), QByteArrayLiteral("action"));
+    QCOMPARE(roleNames.value(ActionModel::ForceRole), QByteArrayLiteral("force"));
+    QCOMPARE(roleNames.value(ActionModel::RowRole), QByteArrayLiteral("row"));
+    QCOMPARE(roleNames.value(ActionModel::ColumnRole), QByteArrayLiteral("column"));
+    QCOMPARE(roleNames.value(ActionModel::LabelRole), QByteArrayLiteral("label"));
+    QCOMPARE(roleNames.value(ActionModel::ActiveRole), QByteArrayLiteral("active"));
+
+    QCOMPARE(data(model, 0, ActionModel::ActionRole).toString(), QStringLiteral("L"));
+    QCOMPARE(data(model, 0, ActionModel::ForceRole).toInt(), 0);
+    QCOMPARE(data(model, 0, ActionModel::RowRole).toInt(), 5);
+    QCOMPARE(data(model, 0, ActionModel::ColumnRole).toInt(), 3);
+    QCOMPARE(data(model, 0, ActionModel::LabelRole).toString(), QStringLiteral("L0"));
+    QCOMPARE(data(model, 0, Qt::DisplayRole).toString(), QStringLiteral("L0"));
+
+    QCOMPARE(data(model, s_forward2Row, ActionModel::LabelRole).toString(), QStringLiteral("F2"));
+    QCOMPARE(data(model, s_forward2Row, ActionModel::RowRole).toInt(), 2);
+    QCOMPARE(data(model, s_forward2Row, ActionModel::ColumnRole).toInt(), 4);
+
+    // the pause has no force and sits in the middle of the drive actions
+    QCOMPARE(data(model, s_pauseRow, ActionModel::ActionRole).toString(), QStringLiteral("S"));
+    QCOMPARE(data(model, s_pauseRow, ActionModel::ForceRole).toInt(), -1);
+    QCOMPARE(data(model, s_pauseRow, ActionModel::LabelRole).toString(), QStringLiteral("S"));
+    QCOMPARE(data(model, s_pauseRow, ActionModel::RowRole).toInt(), 5);
+    QCOMPARE(data(model, s_pauseRow, ActionModel::ColumnRole).toInt(), 4);
+
+    QCOMPARE(data(model, s_eyes3Row, ActionModel::LabelRole).toString(), QStringLiteral("E3"));
+    QCOMPARE(data(model, model.count() - 1, ActionModel::LabelRole).toString(), QStringLiteral("V31"));
+}
+
+// Only the rows whose state changed get notified.
+void ActionModelTest::activeState()
+{
+    ActionModel model;
+    QCOMPARE(activeRows(model), QList<int>{s_pauseRow});
+
+    QSignalSpy currentMessageChanged{&model, &ActionModel::currentMessageChanged};
+    QSignalSpy dataChanged{&model, &ActionModel::dataChanged};
+
+    const auto &encoding = ActionEncoding::forFirmware(-1);
+    const auto forward = withAction(RobotFrame::pause(), encoding.encode('F', 2));
+    model.setCurrentMessage(forward);
+
+    QCOMPARE(model.currentMessage(), forward);
+    QCOMPARE(currentMessageChanged.count(), 1);
+    QCOMPARE(activeRows(model), QList<int>{s_forward2Row});
+
+    QCOMPARE(dataChanged.count(), 2);
+
+    for (const auto &arguments: dataChanged) {
+        const auto row = arguments.at(0).value<QModelIndex>().row();
+        QVERIFY2(row == s_forward2Row || row == s_pauseRow, qPrintable(QString::number(row)));
+        QCOMPARE(arguments.at(1).value<QModelIndex>().row(), row);
+        QCOMPARE(arguments.at(2).value<QVector<int>>(), QVector<int>{ActionModel::ActiveRole});
+    }
+
+    model.setCurrentMessage(forward);
+
+    QCOMPARE(currentMessageChanged.count(), 1);
+    QCOMPARE(dataChanged.count(), 2);
+
+    model.setCurrentMessage(withAction(forward, encoding.encode('V', 5)));
+
+    QCOMPARE(currentMessageChanged.count(), 2);
+    QCOMPARE(dataChanged.count(), 3);
+    QCOMPARE(activeRows(model), (QList<int>{s_forward2Row, model.count() - 32 + 5}));
+
+    model.setCurrentMessage(RobotFrame::pause());
+    QCOMPARE(activeRows(model), QList<int>{s_pauseRow});
+}
+
+// The eye colors are encoded differently by the firmware revisions.
+void ActionModelTest::firmwareRevision()
+{
+    ActionModel model;
+    QSignalSpy firmwareRevisionChanged{&model, &ActionModel::firmwareRevisionChanged};
+
+    model.setCurrentMessage(withAction(RobotFrame::pause(), ActionEncoding::forFirmware(2).encode('E', 3)));
+    model.setFirmwareRevision(2);
+
+    QCOMPARE(model.firmwareRevision(), 2);
+    QCOMPARE(firmwareRevisionChanged.count(), 1);
+    QVERIFY(data(model, s_eyes3Row, ActionModel::ActiveRole).toBool());
+
+    model.setFirmwareRevision(2);
+    QCOMPARE(firmwareRevisionChanged.count(), 1);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::ActionModelTest)
+
+#include "tst_actionmodel.moc"
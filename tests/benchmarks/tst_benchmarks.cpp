@@ -0,0 +1,374 @@
+#include "actionencoding.h"
+#include "controller.h"
+#include "deviceregistry.h"
+#include "notificationdecoder.h"
+#include "robotservice.h"
+#include "sequencer.h"
+#include "simulatedtransport.h"
+#include "utilities.h"
+
+#include <QBluetoothUuid>
+#include <QFile>
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+
+const auto s_robotName = QStringLiteral("Evolution-Robot");
+const QBluetoothUuid s_serviceUuid{quint16{0xfff3}};
+const auto s_macro = QStringLiteral("F3 500ms; L1 200ms; V5; O U 300ms; R2 C 250ms; E7; B1 D 400ms; S");
+const auto s_robotCount = 8;
+
+std::vector<std::unique_ptr<RobotService>> connectedRobots(int count)
+{
+    std::vector<std::unique_ptr<RobotService>> robots;
+
+    for (auto i = 0; i < count; ++i) {
+        robots.push_back(std::make_unique<RobotService>());
+
+        const auto transport = new SimulatedTransport;
+        robots.back()->attach(transport);
+        transport->connectToRobot();
+    }
+
+    return robots;
+}
+
+// One in sixteen advertisers is a robot, the others are phones, watches and beacons.
+std::vector<QBluetoothDeviceInfo> advertisements(int count)
+{
+    std::vector<QBluetoothDeviceInfo> devices;
+    devices.reserve(static_cast<size_t>(count));
+
+    for (auto i = 0; i < count; ++i) {
+        const auto robot = (i % 16 == 0);
+        const QBluetoothAddress address{0x0012a1000000ull + static_cast<quint64>(i)};
+
+        QBluetoothDeviceInfo device{address, robot ? s_robotName : QStringLiteral("Device %1").arg(i), 0};
+        device.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+        device.setRssi(static_cast<qint16>(-40 - i % 50));
+
+        if (robot)
+            device.setServiceUuids({s_serviceUuid});
+
+        devices.push_back(device);
+    }
+
+    return devices;
+}
+
+// What a robot playing all of its sounds reports, with some unexpected chatter.
+QList<QByteArray> syntheticNotifications()
+{
+    QList<QByteArray> notifications;
+
+    for (auto index = 0; index < 107; ++index) {
+        notifications.append("V" + QByteArray::number(index) + "Play");
+
+        if (index % 10 == 0)
+            notifications.append(QByteArrayLiteral("Battery"));
+
+        notifications.append("V" + QByteArray::number(index) + "End");
+    }
+
+    return notifications;
+}
+
+bool readNotifications(const QString &fileName, QList<QByteArray> *notifications, QString *errorString)
+{
+    QFile file{fileName};
+
+    if (!file.open(QFile::ReadOnly)) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    while (!file.atEnd()) {
+        const auto line = file.readLine().trimmed();
+
+        if (!line.isEmpty())
+            notifications->append(line);
+    }
+
+    return true;
+}
+
+} // namespace
+
+class BenchmarksTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encode();
+    void setCurrentMessage_data();
+    void setCurrentMessage();
+    void setCurrentMessageField_data();
+    void setCurrentMessageField();
+    void decode_data();
+    void decode();
+    void replayNotifications();
+    void key();
+    void parseMacro();
+    void compileMacro();
+    void playMacro_data();
+    void playMacro();
+    void discovery_data();
+    void discovery();
+};
+
+void BenchmarksTest::encode()
+{
+    const char actions[] = {'F', 'B', 'L', 'R', 'O', 'C', 'U', 'D', 'V', 'M', 'E'};
+    const auto &encoding = ActionEncoding::forFirmware(2);
+    auto checksum = 0;
+
+    QBENCHMARK {
+        for (const auto action: actions) {
+            for (auto index = 0; index < 4; ++index)
+                checksum += encoding.encode(action, index).value;
+        }
+    }
+
+    QVERIFY(checksum != 0);
+}
+
+void BenchmarksTest::setCurrentMessage_data()
+{
+    QTest::addColumn<bool>("connected");
+
+    QTest::newRow("disconnected") << false;
+    QTest::newRow("connected") << true;
+}
+
+void BenchmarksTest::setCurrentMessage()
+{
+    QFETCH(bool, connected);
+
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+
+    if (connected)
+        transport->connectToRobot();
+
+    auto frame = RobotFrame::pause();
+    auto drive = 0;
+
+    QBENCHMARK {
+        frame.setDrive(1 + (drive++ & 15));
+        service.setCurrentMessage(frame);
+    }
+
+    QCOMPARE(service.currentMessage(), frame);
+}
+
+void BenchmarksTest::setCurrentMessageField_data()
+{
+    setCurrentMessage_data();
+}
+
+void BenchmarksTest::setCurrentMessageField()
+{
+    QFETCH(bool, connected);
+
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+
+    if (connected)
+        transport->connectToRobot();
+
+    auto drive = 0;
+
+    QBENCHMARK {
+        service.setDrive(1 + (drive++ & 15));
+    }
+
+    QVERIFY(service.drive() > 0);
+}
+
+void BenchmarksTest::decode_data()
+{
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("play") << QByteArrayLiteral("V12Play") << static_cast<int>(Notification::SoundStarted);
+    QTest::newRow("end") << QByteArrayLiteral("V107End") << static_cast<int>(Notification::SoundEnded);
+    QTest::newRow("unknown") << QByteArrayLiteral("Battery") << static_cast<int>(Notification::UnknownNotification);
+}
+
+void BenchmarksTest::decode()
+{
+    QFETCH(QByteArray, value);
+    QFETCH(int, type);
+
+    Notification notification;
+
+    QBENCHMARK {
+        notification = NotificationDecoder::decode(value);
+    }
+
+    QCOMPARE(static_cast<int>(notification.type), type);
+}
+
+// Set EVOBOT_NOTIFICATION_LOG to replay a recording with one notification per line instead.
+void BenchmarksTest::replayNotifications()
+{
+    const auto fileName = qEnvironmentVariable("EVOBOT_NOTIFICATION_LOG");
+    const auto synthetic = fileName.isEmpty();
+
+    QList<QByteArray> notifications;
+
+    if (synthetic) {
+        notifications = syntheticNotifications();
+    } else {
+        QString errorString;
+        QVERIFY2(readNotifications(fileName, &notifications, &errorString), qPrintable(errorString));
+    }
+
+    QVERIFY(!notifications.isEmpty());
+
+    auto started = 0;
+    auto ended = 0;
+
+    QBENCHMARK {
+        started = 0;
+        ended = 0;
+
+        for (const auto &value: notifications) {
+            switch (NotificationDecoder::decode(value).type) {
+            case Notification::SoundStarted:
+                ++started;
+                break;
+            case Notification::SoundEnded:
+                ++ended;
+                break;
+            case Notification::UnknownNotification:
+                break;
+            }
+        }
+    }
+
+    QVERIFY(started + ended <= notifications.size());
+
+    if (synthetic) {
+        QCOMPARE(started, 107);
+        QCOMPARE(ended, 107);
+    }
+}
+
+void BenchmarksTest::key()
+{
+    const char *name = {};
+
+    QBENCHMARK {
+        for (auto state = 0; state <= Controller::ErrorState; ++state)
+            name = EvoBot::key(static_cast<Controller::State>(state));
+    }
+
+    QCOMPARE(name, "ErrorState");
+}
+
+void BenchmarksTest::parseMacro()
+{
+    Routine routine;
+
+    QBENCHMARK {
+        EvoBot::parseMacro(s_macro, &routine);
+    }
+
+    QCOMPARE(routine.size(), size_t{13});
+}
+
+// Loading a routine compiles it into the frames of each robot.
+void BenchmarksTest::compileMacro()
+{
+    Routine routine;
+    QVERIFY(EvoBot::parseMacro(s_macro, &routine));
+
+    const auto robots = connectedRobots(s_robotCount);
+    Sequencer sequencer;
+
+    for (const auto &robot: robots)
+        sequencer.addRobotService(robot.get());
+
+    QBENCHMARK {
+        QVERIFY(sequencer.load(routine));
+    }
+
+    QCOMPARE(sequencer.duration(), 1650);
+}
+
+void BenchmarksTest::playMacro_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("defined each time") << false;
+    QTest::newRow("cached") << true;
+}
+
+// Starting a macro also sends its first frames, but doesn't wait for the later ones.
+void BenchmarksTest::playMacro()
+{
+    QFETCH(bool, cached);
+
+    const auto robots = connectedRobots(s_robotCount);
+    Sequencer sequencer;
+
+    for (const auto &robot: robots)
+        sequencer.addRobotService(robot.get());
+
+    QVERIFY(sequencer.defineMacro("dance", s_macro));
+
+    QBENCHMARK {
+        if (!cached)
+            sequencer.defineMacro("dance", s_macro);
+
+        sequencer.playMacro("dance");
+        sequencer.stop();
+    }
+
+    QVERIFY(robots.front()->isActionActive(RobotService::ForwardAction, 3));
+}
+
+void BenchmarksTest::discovery_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("serviceFilter");
+
+    QTest::newRow("1000 by name") << 1000 << false;
+    QTest::newRow("1000 by service") << 1000 << true;
+    QTest::newRow("10000 by name") << 10000 << false;
+    QTest::newRow("10000 by service") << 10000 << true;
+}
+
+// Feeds the registry like the Controller does, with each device advertising repeatedly.
+void BenchmarksTest::discovery()
+{
+    QFETCH(int, count);
+    QFETCH(bool, serviceFilter);
+
+    const auto devices = advertisements(count);
+
+    DeviceRegistry registry;
+    registry.setServiceUuid(serviceFilter ? s_serviceUuid : QBluetoothUuid{});
+    registry.setNameFilter(serviceFilter ? QString{} : s_robotName);
+
+    QBENCHMARK {
+        for (const auto &device: devices)
+            registry.addDevice(device);
+    }
+
+    QCOMPARE(registry.count(), qMin(registry.capacity(), (count + 15) / 16));
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::BenchmarksTest)
+
+#include "tst_benchmarks.moc"
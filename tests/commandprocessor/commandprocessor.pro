@@ -0,0 +1,12 @@
+TARGET = tst_commandprocessor
+
+include(../tests.pri)
+
+INCLUDEPATH += $$PWD/../../daemon
+
+HEADERS += \
+    ../../daemon/commandprocessor.h
+
+SOURCES += \
+    ../../daemon/commandprocessor.cpp \
+    tst_commandprocessor.cpp
@@ -0,0 +1,160 @@
+#include "commandprocessor.h"
+#include "controller.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+// The controller never connects to a real robot in the test. The robot commands are covered
+// by attaching a simulated robot, which only works where a Bluetooth controller is available.
+class CommandProcessorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyLine();
+    void help();
+    void state();
+    void quit();
+    void macro_data();
+    void macro();
+    void notConnected_data();
+    void notConnected();
+    void audioLoop_data();
+    void audioLoop();
+};
+
+void CommandProcessorTest::emptyLine()
+{
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    QCOMPARE(processor.execute({}), QByteArray{});
+    QCOMPARE(processor.execute("   "), QByteArray{});
+}
+
+void CommandProcessorTest::help()
+{
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    const auto reply = processor.execute("help");
+    QVERIFY(reply.startsWith("ok commands: "));
+    QVERIFY(reply.contains("macro <name> <macro>"));
+    QVERIFY(!reply.contains('\n'));
+}
+
+void CommandProcessorTest::state()
+{
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    QCOMPARE(processor.execute("state"), "ok " + QByteArray{Controller::stateName(controller.state())});
+    QCOMPARE(processor.execute("  state  "), processor.execute("state"));
+}
+
+void CommandProcessorTest::quit()
+{
+    Controller controller;
+    CommandProcessor processor{&controller};
+    QSignalSpy quitRequested{&processor, &CommandProcessor::quitRequested};
+
+    QCOMPARE(processor.execute("quit"), QByteArray{"ok"});
+    QCOMPARE(quitRequested.count(), 1);
+}
+
+void CommandProcessorTest::macro_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<QByteArray>("reply");
+
+    QTest::newRow("valid") << QByteArray{"macro wiggle F3 500ms; L1 200ms; V5"} << QByteArray{"ok"};
+    QTest::newRow("extra spaces") << QByteArray{"macro  wiggle   F3  500ms;  L1"} << QByteArray{"ok"};
+    QTest::newRow("no macro") << QByteArray{"macro wiggle"} << QByteArray{"error usage: macro <name> <macro>"};
+    QTest::newRow("invalid time") << QByteArray{"macro wiggle F3 5x0ms"} << QByteArray{"error "};
+    QTest::newRow("invalid action") << QByteArray{"macro wiggle F3x 500ms"} << QByteArray{"error "};
+}
+
+// Macros are defined without a robot, so that they are ready once it connects.
+void CommandProcessorTest::macro()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(QByteArray, reply);
+
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    const auto result = processor.execute(line);
+
+    if (reply.endsWith(' '))
+        QVERIFY2(result.startsWith(reply) && result.size() > reply.size(), result.constData());
+    else
+        QCOMPARE(result, reply);
+}
+
+void CommandProcessorTest::notConnected_data()
+{
+    QTest::addColumn<QByteArray>("line");
+
+    QTest::newRow("actions") << QByteArray{"F2 O -F2"};
+    QTest::newRow("pause") << QByteArray{"pause"};
+    QTest::newRow("drive") << QByteArray{"drive 0 1"};
+    QTest::newRow("sound") << QByteArray{"sound 3"};
+    QTest::newRow("play") << QByteArray{"play wiggle"};
+}
+
+void CommandProcessorTest::notConnected()
+{
+    QFETCH(QByteArray, line);
+
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    QVERIFY(controller.state() != Controller::ConnectedState);
+    QCOMPARE(processor.execute(line), "error not connected, state is " + QByteArray{Controller::stateName(controller.state())});
+}
+
+void CommandProcessorTest::audioLoop_data()
+{
+    QTest::addColumn<QByteArrayList>("lines");
+
+    QTest::newRow("loop") << QByteArrayList{"loop 5"};
+    QTest::newRow("macro") << QByteArrayList{"macro wiggle M5; F3 200ms", "play wiggle"};
+}
+
+// Audio loops keep running after the robot reported their start and end.
+void CommandProcessorTest::audioLoop()
+{
+    QFETCH(QByteArrayList, lines);
+
+    Controller controller;
+    CommandProcessor processor{&controller};
+
+    const auto service = controller.robotService();
+    const auto transport = new SimulatedTransport;
+    transport->setSoundStartDelay(10);
+    transport->setSoundDuration(50);
+    service->attach(transport);
+    transport->connectToRobot();
+
+    if (controller.state() != Controller::ConnectedState)
+        QSKIP("The controller is in error state without a Bluetooth controller");
+
+    QSignalSpy currentSoundChanged{service, &RobotService::currentSoundChanged};
+
+    for (const auto &line: lines)
+        QCOMPARE(processor.execute(line), QByteArray{"ok"});
+
+    QTRY_COMPARE(currentSoundChanged.count(), 2);
+    QCOMPARE(service->currentSound(), 5);
+    QVERIFY(service->isActionActive(RobotService::PlayLoopAction, 5));
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::CommandProcessorTest)
+
+#include "tst_commandprocessor.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_devicecache
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_devicecache.cpp
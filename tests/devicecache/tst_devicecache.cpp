@@ -0,0 +1,153 @@
+#include "devicecache.h"
+
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <memory>
+
+namespace EvoBot {
+
+namespace {
+
+DeviceCache::Entry robot(const QString &address, quint16 firstHandle = 0x0010)
+{
+    DeviceCache::Entry entry;
+    entry.address = QBluetoothAddress{address};
+    entry.name = QStringLiteral("Evolution-Robot");
+    entry.firmwareRevision = 2;
+    entry.layout.notifyHandle = firstHandle;
+    entry.layout.notifyConfigHandle = static_cast<quint16>(firstHandle + 1);
+    entry.layout.writeHandle = static_cast<quint16>(firstHandle + 3);
+    return entry;
+}
+
+void compareEntries(const DeviceCache::Entry &actual, const DeviceCache::Entry &expected)
+{
+    QCOMPARE(actual.address, expected.address);
+    QCOMPARE(actual.name, expected.name);
+    QCOMPARE(actual.firmwareRevision, expected.firmwareRevision);
+    QVERIFY(actual.layout == expected.layout);
+}
+
+} // namespace
+
+class DeviceCacheTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void storeAndLoad();
+    void outdatedLayout();
+    void remove();
+    void invalidEntries();
+
+private:
+    QString fileName() const { return m_directory->filePath("devicecache.ini"); }
+
+    std::unique_ptr<QTemporaryDir> m_directory;
+};
+
+void DeviceCacheTest::init()
+{
+    m_directory = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_directory->isValid());
+}
+
+// Entries survive the cache, the last stored one is reported by lastEntry().
+void DeviceCacheTest::storeAndLoad()
+{
+    const auto first = robot("00:11:22:33:44:01");
+    const auto second = robot("00:11:22:33:44:02", 0x0020);
+
+    {
+        DeviceCache cache{fileName()};
+        QVERIFY(!cache.lastEntry().isValid());
+        QVERIFY(cache.entries().isEmpty());
+
+        cache.store(first);
+        cache.store(second);
+    }
+
+    DeviceCache cache{fileName()};
+    QCOMPARE(cache.entries().count(), 2);
+    compareEntries(cache.entry(first.address), first);
+    compareEntries(cache.entry(second.address), second);
+    compareEntries(cache.lastEntry(), second);
+
+    QVERIFY(!cache.entry(QBluetoothAddress{"00:11:22:33:44:03"}).isValid());
+    QVERIFY(!cache.entry({}).isValid());
+}
+
+// A robot reporting another attribute layout, like after a firmware update, replaces its entry.
+void DeviceCacheTest::outdatedLayout()
+{
+    const auto cached = robot("00:11:22:33:44:01");
+    auto updated = robot("00:11:22:33:44:01", 0x0030);
+    updated.firmwareRevision = 3;
+
+    {
+        DeviceCache cache{fileName()};
+        cache.store(cached);
+        cache.store(robot("00:11:22:33:44:02"));
+
+        QVERIFY(cache.entry(cached.address).layout != updated.layout);
+        cache.store(updated);
+    }
+
+    DeviceCache cache{fileName()};
+    QCOMPARE(cache.entries().count(), 2);
+    compareEntries(cache.entry(updated.address), updated);
+    compareEntries(cache.lastEntry(), updated);
+}
+
+void DeviceCacheTest::remove()
+{
+    const auto first = robot("00:11:22:33:44:01");
+    const auto second = robot("00:11:22:33:44:02");
+
+    DeviceCache cache{fileName()};
+    cache.store(first);
+    cache.store(second);
+
+    // removing another robot keeps the last entry
+    cache.remove(first.address);
+    QCOMPARE(cache.entries().count(), 1);
+    QVERIFY(!cache.entry(first.address).isValid());
+    compareEntries(cache.lastEntry(), second);
+
+    cache.remove(second.address);
+    QVERIFY(cache.entries().isEmpty());
+    QVERIFY(!cache.lastEntry().isValid());
+
+    cache.store(first);
+    cache.clear();
+    QVERIFY(cache.entries().isEmpty());
+    QVERIFY(!cache.lastEntry().isValid());
+}
+
+// Groups without an address, like from a damaged file, are skipped; missing values get defaults.
+void DeviceCacheTest::invalidEntries()
+{
+    {
+        QSettings settings{fileName(), QSettings::IniFormat};
+        settings.setValue("devices/1/name", "Evolution-Robot");
+        settings.setValue("devices/1122334402/address", "00:11:22:33:44:02");
+    }
+
+    DeviceCache cache{fileName()};
+    const auto entries = cache.entries();
+    QCOMPARE(entries.count(), 1);
+    QCOMPARE(entries.first().address, QBluetoothAddress{"00:11:22:33:44:02"});
+    QCOMPARE(entries.first().firmwareRevision, -1);
+    QVERIFY(!entries.first().layout.isValid());
+    QVERIFY(!cache.lastEntry().isValid());
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::DeviceCacheTest)
+
+#include "tst_devicecache.moc"
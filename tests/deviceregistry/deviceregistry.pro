@@ -0,0 +1,6 @@
+TARGET = tst_deviceregistry
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_deviceregistry.cpp
@@ -0,0 +1,109 @@
+#include "deviceregistry.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+QBluetoothDeviceInfo robot(const QString &address, qint16 rssi = 0, const QString &name = "Evolution-Robot")
+{
+    QBluetoothDeviceInfo device{QBluetoothAddress{address}, name, 0};
+    device.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    device.setRssi(rssi);
+    return device;
+}
+
+} // namespace
+
+class DeviceRegistryTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void discoveryRuns();
+    void strongestEntry();
+};
+
+void DeviceRegistryTest::initTestCase()
+{
+    qRegisterMetaType<QBluetoothDeviceInfo>();
+}
+
+// Each discovery run reports every advertising robot once, known ones included.
+void DeviceRegistryTest::discoveryRuns()
+{
+    DeviceRegistry registry;
+    QSignalSpy deviceAdded{&registry, &DeviceRegistry::deviceAdded};
+    QSignalSpy deviceDiscovered{&registry, &DeviceRegistry::deviceDiscovered};
+
+    registry.beginDiscoveryRun();
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:01")));
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:01")));
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:02", 0, "Other-Device")));
+    QCOMPARE(deviceAdded.count(), 1);
+    QCOMPARE(deviceDiscovered.count(), 1);
+
+    // restarting discovery reports the robot again, without adding it another time
+    registry.beginDiscoveryRun();
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:01")));
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:01")));
+    QCOMPARE(deviceAdded.count(), 1);
+    QCOMPARE(deviceDiscovered.count(), 2);
+    QCOMPARE(deviceDiscovered.last().first().value<QBluetoothDeviceInfo>().address(),
+             QBluetoothAddress{"00:11:22:33:44:01"});
+    QCOMPARE(registry.count(), 1);
+
+    // robots forgotten during a run are reported again when they come back
+    registry.removeDevice(QBluetoothAddress{"00:11:22:33:44:01"});
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:01")));
+    QCOMPARE(deviceAdded.count(), 2);
+    QCOMPARE(deviceDiscovered.count(), 3);
+
+    registry.clear();
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:01")));
+    QCOMPARE(deviceDiscovered.count(), 4);
+}
+
+// Choosing the strongest robot of a restarted discovery run also considers robots
+// known from earlier runs, but only if they advertised again during the new run.
+void DeviceRegistryTest::strongestEntry()
+{
+    DeviceRegistry registry;
+    QSignalSpy deviceDiscovered{&registry, &DeviceRegistry::deviceDiscovered};
+
+    QVERIFY(!registry.strongestEntry().isValid());
+
+    registry.beginDiscoveryRun();
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:01", -40)));
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:02", -70)));
+    QVERIFY(registry.addDevice(robot("00:11:22:33:44:03")));
+    QCOMPARE(registry.strongestEntry().device.address(), QBluetoothAddress{"00:11:22:33:44:01"});
+    QCOMPARE(deviceDiscovered.count(), 3);
+
+    QTest::qWait(5);
+
+    const auto secondRun = registry.now();
+    registry.beginDiscoveryRun();
+    QVERIFY(!registry.strongestEntry(secondRun).isValid());
+
+    // robots with unknown signal strength are only chosen if there is no other
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:03")));
+    QCOMPARE(registry.strongestEntry(secondRun).device.address(), QBluetoothAddress{"00:11:22:33:44:03"});
+
+    QVERIFY(!registry.addDevice(robot("00:11:22:33:44:02", -60)));
+    QCOMPARE(registry.strongestEntry(secondRun).device.address(), QBluetoothAddress{"00:11:22:33:44:02"});
+    QCOMPARE(registry.strongestEntry(secondRun).rssi, qint16{-60});
+    QCOMPARE(deviceDiscovered.count(), 5);
+
+    // without filtering, the strongest robot of the first run still wins
+    QCOMPARE(registry.strongestEntry().device.address(), QBluetoothAddress{"00:11:22:33:44:01"});
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::DeviceRegistryTest)
+
+#include "tst_deviceregistry.moc"
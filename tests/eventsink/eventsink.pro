@@ -0,0 +1,6 @@
+TARGET = tst_eventsink
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_eventsink.cpp
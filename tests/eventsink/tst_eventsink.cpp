@@ -0,0 +1,355 @@
+#include "eventsink.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace EvoBot {
+
+namespace {
+
+// the frame as value of an event, the first byte becoming the lowest
+quint64 frameValue(const RobotFrame &frame)
+{
+    auto value = quint64{0};
+
+    for (auto field = RobotFrame::Size - 1; field >= 0; --field)
+        value = (value << 8) | static_cast<uchar>(frame.at(field));
+
+    return value;
+}
+
+} // namespace
+
+class EventSinkTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void capacity_data();
+    void capacity();
+    void writeAndRead();
+    void deviceHeader();
+    void droppedEvents();
+    void readInvalid();
+    void readTruncated();
+    void concurrentPosts();
+    void install();
+    void robotServiceEvents();
+};
+
+void EventSinkTest::capacity_data()
+{
+    QTest::addColumn<int>("requested");
+    QTest::addColumn<int>("capacity");
+
+    QTest::newRow("tiny") << 1 << 2;
+    QTest::newRow("power of two") << 64 << 64;
+    QTest::newRow("rounded") << 100 << 128;
+}
+
+void EventSinkTest::capacity()
+{
+    QFETCH(int, requested);
+    QFETCH(int, capacity);
+
+    QCOMPARE(EventSink{requested}.capacity(), capacity);
+}
+
+void EventSinkTest::writeAndRead()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("events.log");
+    const auto before = QDateTime::currentMSecsSinceEpoch();
+
+    EventSink sink;
+    sink.setDrainInterval(0);
+    QVERIFY2(sink.open(fileName), qPrintable(sink.errorString()));
+
+    sink.post(EventSink::TransportStateChanged, 3, RobotService::ConnectedState);
+    sink.post(EventSink::FrameIssued, 3, 1, frameValue(RobotFrame::pause()));
+    sink.post(EventSink::DeviceDiscovered, EventSink::NoRobot, -67, Q_UINT64_C(0x0012a1000042));
+    sink.drain();
+
+    QList<EventRecord> records;
+    qint64 startTime = 0;
+    QString errorString;
+    QVERIFY2(EventSink::read(fileName, &records, &startTime, &errorString), qPrintable(errorString));
+
+    QVERIFY(startTime >= before - 1000);
+    QVERIFY(startTime <= QDateTime::currentMSecsSinceEpoch());
+    QCOMPARE(records.size(), 3);
+
+    QCOMPARE(records[0].event, quint16{EventSink::TransportStateChanged});
+    QCOMPARE(records[0].robot, quint16{3});
+    QCOMPARE(records[0].argument, qint32{RobotService::ConnectedState});
+    QCOMPARE(records[1].event, quint16{EventSink::FrameIssued});
+    QCOMPARE(records[1].value, frameValue(RobotFrame::pause()));
+    QCOMPARE(records[2].robot, EventSink::NoRobot);
+    QCOMPARE(records[2].argument, -67);
+    QCOMPARE(records[2].value, Q_UINT64_C(0x0012a1000042));
+
+    QVERIFY(records[0].timestamp >= 0);
+    QVERIFY(records[0].timestamp <= records[1].timestamp);
+    QVERIFY(records[1].timestamp <= records[2].timestamp);
+
+    // drained events aren't written twice
+    sink.post(EventSink::FrameLost, 3);
+    sink.drain();
+    sink.drain();
+
+    QVERIFY(EventSink::read(fileName, &records));
+    QCOMPARE(records.size(), 4);
+    QCOMPARE(records.last().event, quint16{EventSink::FrameLost});
+}
+
+// Events posted without device only count, a new device starts with the header.
+void EventSinkTest::deviceHeader()
+{
+    EventSink sink;
+    sink.setDrainInterval(0);
+
+    sink.post(EventSink::FrameLost, 1);
+    sink.drain();
+    QCOMPARE(sink.postedEvents(), quint64{1});
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QBuffer::WriteOnly));
+    sink.setDevice(&buffer);
+    QCOMPARE(sink.device(), &buffer);
+
+    QCOMPARE(buffer.data().size(), EventSink::HeaderSize);
+    QVERIFY(buffer.data().startsWith(EventSink::Magic));
+
+    sink.post(EventSink::FrameLost, 2);
+    sink.post(EventSink::FrameLost, 3);
+    sink.drain();
+    QCOMPARE(buffer.data().size(), EventSink::HeaderSize + 2 * EventSink::RecordSize);
+
+    // a destroyed device is dropped
+    auto temporary = std::make_unique<QBuffer>();
+    QVERIFY(temporary->open(QBuffer::WriteOnly));
+    sink.setDevice(temporary.get());
+    temporary.reset();
+    QVERIFY(!sink.device());
+
+    sink.post(EventSink::FrameLost, 4);
+    sink.drain();
+    QCOMPARE(buffer.data().size(), EventSink::HeaderSize + 2 * EventSink::RecordSize);
+}
+
+void EventSinkTest::droppedEvents()
+{
+    EventSink sink{4};
+    sink.setDrainInterval(0);
+
+    for (auto i = 0; i < 6; ++i)
+        sink.post(EventSink::FrameIssued, 1, i);
+
+    QCOMPARE(sink.postedEvents(), quint64{6});
+    QCOMPARE(sink.droppedEvents(), quint64{2});
+
+    // draining frees the buffer again
+    sink.drain();
+
+    for (auto i = 0; i < 4; ++i)
+        sink.post(EventSink::FrameIssued, 1, i);
+
+    QCOMPARE(sink.postedEvents(), quint64{10});
+    QCOMPARE(sink.droppedEvents(), quint64{2});
+}
+
+void EventSinkTest::readInvalid()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    QString errorString;
+    QVERIFY(!EventSink::read(temporaryDir.filePath("missing.log"), nullptr, nullptr, &errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    const auto fileName = temporaryDir.filePath("session.log");
+    QFile file{fileName};
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write("EvoBotS1 is a session log");
+    file.close();
+
+    errorString.clear();
+    QVERIFY(!EventSink::read(fileName, nullptr, nullptr, &errorString));
+    QVERIFY(errorString.contains(fileName));
+}
+
+// A log cut off within a record, like after a crash, still reads up to that record.
+void EventSinkTest::readTruncated()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QBuffer::WriteOnly));
+
+    {
+        EventSink sink;
+        sink.setDevice(&buffer);
+        sink.post(EventSink::FrameLost, 1);
+        sink.post(EventSink::FrameLost, 2);
+    }
+
+    QCOMPARE(buffer.data().size(), EventSink::HeaderSize + 2 * EventSink::RecordSize);
+
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("events.log");
+    QFile file{fileName};
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(buffer.data().chopped(EventSink::RecordSize / 2));
+    file.close();
+
+    QList<EventRecord> records;
+    QVERIFY(EventSink::read(fileName, &records));
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records.first().robot, quint16{1});
+}
+
+// Each thread's events keep their order, and none get lost while the buffer has room.
+void EventSinkTest::concurrentPosts()
+{
+    const auto threadCount = 4;
+    const auto eventCount = 1000;
+
+    EventSink sink{threadCount * eventCount};
+    sink.setDrainInterval(0);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QBuffer::WriteOnly));
+    sink.setDevice(&buffer);
+
+    std::vector<std::unique_ptr<QThread>> threads;
+
+    for (auto i = 0; i < threadCount; ++i) {
+        threads.emplace_back(QThread::create([&sink, i] {
+            for (auto argument = 0; argument < eventCount; ++argument)
+                sink.post(EventSink::NotificationReceived, static_cast<quint16>(i), argument);
+        }));
+
+        threads.back()->start();
+    }
+
+    for (const auto &thread: threads)
+        QVERIFY(thread->wait(10000));
+
+    sink.drain();
+
+    QCOMPARE(sink.postedEvents(), quint64{threadCount * eventCount});
+    QCOMPARE(sink.droppedEvents(), quint64{0});
+    QCOMPARE(buffer.data().size(), EventSink::HeaderSize + threadCount * eventCount * EventSink::RecordSize);
+
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("events.log");
+    QFile file{fileName};
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(buffer.data());
+    file.close();
+
+    QList<EventRecord> records;
+    QVERIFY(EventSink::read(fileName, &records));
+
+    std::vector<qint32> next(threadCount, 0);
+
+    for (const auto &record: records) {
+        QVERIFY(record.robot < threadCount);
+        QCOMPARE(record.argument, next[record.robot]++);
+    }
+
+    QVERIFY(std::all_of(next.begin(), next.end(), [](auto count) { return count == eventCount; }));
+}
+
+void EventSinkTest::install()
+{
+    QVERIFY(!EventSink::installed());
+
+    // nothing to post to
+    postEvent(EventSink::FrameLost, 1);
+
+    auto sink = std::make_unique<EventSink>();
+    EventSink::install(sink.get());
+    QCOMPARE(EventSink::installed(), sink.get());
+
+    postEvent(EventSink::FrameLost, 1);
+    postEvent(EventSink::FrameLost, 2);
+    QCOMPARE(sink->postedEvents(), quint64{2});
+
+    EventSink::install(nullptr);
+    postEvent(EventSink::FrameLost, 3);
+    QCOMPARE(sink->postedEvents(), quint64{2});
+
+    // destroying the installed sink uninstalls it
+    EventSink::install(sink.get());
+    sink.reset();
+    QVERIFY(!EventSink::installed());
+}
+
+void EventSinkTest::robotServiceEvents()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("events.log");
+
+    EventSink sink;
+    QVERIFY(sink.open(fileName));
+    EventSink::install(&sink);
+
+    RobotFrame frame;
+
+    {
+        RobotService service;
+        const auto transport = new SimulatedTransport;
+        service.attach(transport);
+        transport->connectToRobot(1);
+
+        QVERIFY(service.startAction(RobotService::ForwardAction, 3));
+        QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+        QTRY_VERIFY(!service.transmitScheduler()->isWritePending());
+        frame = service.currentMessage();
+    }
+
+    EventSink::install(nullptr);
+    sink.drain();
+
+    QList<EventRecord> records;
+    QVERIFY(EventSink::read(fileName, &records));
+
+    const auto hasEvent = [&records](EventSink::Event event, qint32 argument, quint64 value) {
+        return std::any_of(records.begin(), records.end(), [=](const auto &record) {
+            return record.event == event && record.argument == argument && record.value == value;
+        });
+    };
+
+    QVERIFY(hasEvent(EventSink::FirmwareRevisionChanged, 1, 0));
+    QVERIFY(hasEvent(EventSink::TransportStateChanged, RobotService::ConnectedState, 0));
+    QVERIFY(hasEvent(EventSink::FrameIssued, 1, frameValue(frame)));
+    QVERIFY(hasEvent(EventSink::FrameAcknowledged, 0, frameValue(frame)));
+
+    // all events of the service share its robot id
+    QVERIFY(std::all_of(records.begin(), records.end(), [&records](const auto &record) {
+        return record.robot == records.first().robot;
+    }));
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::EventSinkTest)
+
+#include "tst_eventsink.moc"
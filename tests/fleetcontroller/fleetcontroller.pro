@@ -0,0 +1,6 @@
+TARGET = tst_fleetcontroller
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_fleetcontroller.cpp
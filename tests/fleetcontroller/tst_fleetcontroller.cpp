@@ -0,0 +1,199 @@
+#include "deviceregistry.h"
+#include "fleetcontroller.h"
+#include "simulatedtransport.h"
+
+#include <QMap>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+const auto s_first = QStringLiteral("00:12:A1:00:00:01");
+const auto s_second = QStringLiteral("00:12:A1:00:00:02");
+
+// The transport of each robot's latest connection attempt.
+struct SimulatedRobots
+{
+    int attempts = 0;
+    QMap<QString, QPointer<SimulatedTransport>> transports;
+};
+
+QBluetoothDeviceInfo robot(const QString &address)
+{
+    QBluetoothDeviceInfo device{QBluetoothAddress{address}, QStringLiteral("Evolution-Robot"), 0};
+    device.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    return device;
+}
+
+// Each connection attempt gets a simulated robot, which the test then connects or fails.
+void simulateRobots(FleetController *fleet, SimulatedRobots *robots)
+{
+    fleet->setTransportFactory([robots](const QBluetoothDeviceInfo &device) {
+        const auto transport = new SimulatedTransport;
+        transport->beginConnecting();
+
+        ++robots->attempts;
+        robots->transports.insert(device.address().toString(), transport);
+        return transport;
+    });
+}
+
+int state(const FleetController &fleet, int row)
+{
+    return fleet.data(fleet.index(row), FleetController::StateRole).toInt();
+}
+
+} // namespace
+
+class FleetControllerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void concurrentConnections();
+    void retries();
+    void lostConnection();
+    void vanishedRobots();
+};
+
+void FleetControllerTest::concurrentConnections()
+{
+    FleetController fleet;
+    SimulatedRobots robots;
+    simulateRobots(&fleet, &robots);
+    fleet.setMaximumConcurrentConnections(2);
+
+    const QStringList addresses{s_first, s_second, QStringLiteral("00:12:A1:00:00:03"), QStringLiteral("00:12:A1:00:00:04")};
+
+    for (const auto &address: addresses)
+        fleet.deviceRegistry()->addDevice(robot(address));
+
+    QCOMPARE(fleet.count(), 4);
+    QCOMPARE(robots.attempts, 2);
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::ConnectingState));
+    QCOMPARE(state(fleet, 1), static_cast<int>(FleetController::ConnectingState));
+    QCOMPARE(state(fleet, 2), static_cast<int>(FleetController::QueuedState));
+    QCOMPARE(state(fleet, 3), static_cast<int>(FleetController::QueuedState));
+
+    QSignalSpy connectedCountChanged{&fleet, &FleetController::connectedCountChanged};
+
+    // a robot done connecting makes room for the next one
+    robots.transports.value(s_first)->connectToRobot();
+
+    QCOMPARE(fleet.connectedCount(), 1);
+    QCOMPARE(connectedCountChanged.count(), 1);
+    QCOMPARE(robots.attempts, 3);
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::ConnectedState));
+    QCOMPARE(state(fleet, 1), static_cast<int>(FleetController::ConnectingState));
+    QCOMPARE(state(fleet, 2), static_cast<int>(FleetController::ConnectingState));
+    QCOMPARE(state(fleet, 3), static_cast<int>(FleetController::QueuedState));
+
+    fleet.setMaximumConcurrentConnections(3);
+
+    QCOMPARE(robots.attempts, 4);
+    QCOMPARE(state(fleet, 3), static_cast<int>(FleetController::ConnectingState));
+    QCOMPARE(fleet.robotServices().size(), 4);
+}
+
+// Failed attempts are retried with growing delays, until all attempts are used up.
+void FleetControllerTest::retries()
+{
+    FleetController fleet;
+    SimulatedRobots robots;
+    simulateRobots(&fleet, &robots);
+
+    fleet.deviceRegistry()->addDevice(robot(s_first));
+    QCOMPARE(robots.attempts, 1);
+
+    for (auto attempt = 1; attempt < 3; ++attempt) {
+        robots.transports.value(s_first)->disconnectFromRobot();
+
+        QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::QueuedState));
+        QVERIFY(!fleet.data(fleet.index(0), FleetController::ErrorStringRole).toString().isEmpty());
+        QCOMPARE(robots.attempts, attempt);
+
+        QTRY_COMPARE(robots.attempts, attempt + 1);
+        QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::ConnectingState));
+    }
+
+    robots.transports.value(s_first)->disconnectFromRobot();
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::FailedState));
+
+    // a fourth attempt would have followed after two seconds
+    QTest::qWait(2500);
+
+    QCOMPARE(robots.attempts, 3);
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::FailedState));
+    QCOMPARE(fleet.count(), 1);
+}
+
+// Robots losing an established connection start over with a full set of attempts.
+void FleetControllerTest::lostConnection()
+{
+    FleetController fleet;
+    SimulatedRobots robots;
+    simulateRobots(&fleet, &robots);
+
+    fleet.deviceRegistry()->addDevice(robot(s_first));
+    robots.transports.value(s_first)->connectToRobot();
+    QCOMPARE(fleet.connectedCount(), 1);
+
+    robots.transports.value(s_first)->disconnectFromRobot();
+
+    QCOMPARE(fleet.connectedCount(), 0);
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::QueuedState));
+
+    QTRY_COMPARE(robots.attempts, 2);
+    robots.transports.value(s_first)->connectToRobot();
+
+    QCOMPARE(fleet.connectedCount(), 1);
+    QVERIFY(fleet.data(fleet.index(0), FleetController::ErrorStringRole).toString().isEmpty());
+}
+
+// Failed robots are removed when they stop advertising, connected ones once they failed too.
+void FleetControllerTest::vanishedRobots()
+{
+    FleetController fleet;
+    SimulatedRobots robots;
+    simulateRobots(&fleet, &robots);
+
+    fleet.deviceRegistry()->addDevice(robot(s_first));
+    fleet.deviceRegistry()->addDevice(robot(s_second));
+    robots.transports.value(s_second)->connectToRobot();
+
+    for (auto attempt = 1; attempt <= 3; ++attempt) {
+        QTRY_COMPARE(state(fleet, 0), static_cast<int>(FleetController::ConnectingState));
+        robots.transports.value(s_first)->disconnectFromRobot();
+    }
+
+    QCOMPARE(state(fleet, 0), static_cast<int>(FleetController::FailedState));
+    QCOMPARE(fleet.connectedCount(), 1);
+
+    QSignalSpy rowsRemoved{&fleet, &FleetController::rowsRemoved};
+
+    fleet.deviceRegistry()->removeDevice(QBluetoothAddress{s_first});
+    fleet.deviceRegistry()->removeDevice(QBluetoothAddress{s_second});
+
+    QCOMPARE(rowsRemoved.count(), 1);
+    QCOMPARE(fleet.count(), 1);
+    QCOMPARE(fleet.data(fleet.index(0), FleetController::AddressRole).toString(), s_second);
+
+    robots.transports.value(s_second)->disconnectFromRobot();
+
+    for (auto attempt = 1; attempt <= 3; ++attempt) {
+        QTRY_COMPARE(state(fleet, 0), static_cast<int>(FleetController::ConnectingState));
+        robots.transports.value(s_second)->disconnectFromRobot();
+    }
+
+    QTRY_COMPARE(fleet.count(), 0);
+    QCOMPARE(rowsRemoved.count(), 2);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::FleetControllerTest)
+
+#include "tst_fleetcontroller.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_proxies
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_proxies.cpp
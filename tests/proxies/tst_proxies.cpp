@@ -0,0 +1,145 @@
+#include "controller.h"
+#include "controllerproxy.h"
+#include "robotservice.h"
+#include "robotserviceproxy.h"
+#include "simulatedtransport.h"
+
+#include <QSignalSpy>
+#include <QThread>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+// A robot service living in a worker thread, like the one of ControllerProxy.
+class Worker
+{
+public:
+    Worker()
+    {
+        m_thread.start();
+
+        const auto context = new QObject;
+        context->moveToThread(&m_thread);
+        QObject::connect(&m_thread, &QThread::finished, context, &QObject::deleteLater);
+
+        QMetaObject::invokeMethod(context, [this, context] {
+            service = new RobotService{context};
+            transport = new SimulatedTransport;
+            service->attach(transport);
+            transport->connectToRobot(1);
+        }, Qt::BlockingQueuedConnection);
+    }
+
+    ~Worker()
+    {
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    RobotService *service = {};
+    SimulatedTransport *transport = {};
+
+private:
+    QThread m_thread;
+};
+
+} // namespace
+
+class ProxiesTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void robotServiceSnapshot();
+    void robotServiceActions();
+    void robotServiceSound();
+    void controllerSettings();
+};
+
+void ProxiesTest::robotServiceSnapshot()
+{
+    Worker worker;
+    RobotServiceProxy proxy{worker.service};
+
+    QCOMPARE(proxy.service(), worker.service);
+    QCOMPARE(proxy.state(), static_cast<int>(RobotService::ConnectedState));
+    QCOMPARE(proxy.firmwareRevision(), 1);
+    QVERIFY(proxy.currentMessage() == RobotFrame::pause());
+    QVERIFY(proxy.isActionActive('S'));
+    QVERIFY(!proxy.writeWithoutResponse());
+}
+
+void ProxiesTest::robotServiceActions()
+{
+    Worker worker;
+    RobotServiceProxy proxy{worker.service};
+    QSignalSpy driveChanged{&proxy, &RobotServiceProxy::driveChanged};
+    QSignalSpy clawChanged{&proxy, &RobotServiceProxy::clawChanged};
+
+    proxy.startAction('F', 2);
+    QTRY_VERIFY(proxy.isActionActive('F', 2));
+    QCOMPARE(driveChanged.count(), 1);
+    QCOMPARE(clawChanged.count(), 0);
+    QVERIFY(!proxy.isActionActive('S'));
+
+    proxy.applyActions("-F2 O");
+    QTRY_VERIFY(proxy.isActionActive('O'));
+    QVERIFY(!proxy.isActionActive('F', 2));
+    QCOMPARE(driveChanged.count(), 2);
+    QCOMPARE(clawChanged.count(), 1);
+
+    proxy.setWriteWithoutResponse(true);
+    QTRY_VERIFY(proxy.writeWithoutResponse());
+
+    proxy.startAction('S');
+    QTRY_VERIFY(proxy.isActionActive('S'));
+    QTRY_VERIFY(worker.transport->currentFrame() == RobotFrame::pause());
+}
+
+void ProxiesTest::robotServiceSound()
+{
+    Worker worker;
+    RobotServiceProxy proxy{worker.service};
+    QSignalSpy currentSoundChanged{&proxy, &RobotServiceProxy::currentSoundChanged};
+
+    proxy.playSound(3);
+
+    // started sounds are reported by their index, ended ones by the negated index
+    QTRY_COMPARE(proxy.currentSound(), 3);
+    QTRY_COMPARE(proxy.currentSound(), -3);
+    QVERIFY(currentSoundChanged.count() >= 2);
+}
+
+// Without Bluetooth the controller just reports an error, but keeps its settings.
+void ProxiesTest::controllerSettings()
+{
+    ControllerProxy proxy;
+    QVERIFY(proxy.controller());
+    QVERIFY(proxy.robotService());
+    QVERIFY(proxy.error() == Controller::NoError || proxy.error() == Controller::BluetoothMissingError);
+
+    QSignalSpy autoReconnectEnabledChanged{&proxy, &ControllerProxy::autoReconnectEnabledChanged};
+    const auto autoReconnectEnabled = !proxy.isAutoReconnectEnabled();
+
+    proxy.setAutoReconnectEnabled(autoReconnectEnabled);
+    QTRY_COMPARE(proxy.isAutoReconnectEnabled(), autoReconnectEnabled);
+    QCOMPARE(autoReconnectEnabledChanged.count(), 1);
+
+    proxy.setConnectionProfile(Controller::LowLatencyProfile);
+    QTRY_COMPARE(proxy.connectionProfile(), static_cast<int>(Controller::LowLatencyProfile));
+
+    proxy.setDiscoveryPolicy(Controller::StrongestSignalPolicy);
+    QTRY_COMPARE(proxy.discoveryPolicy(), static_cast<int>(Controller::StrongestSignalPolicy));
+
+    // invalid addresses are dropped by the controller, and the proxy mirrors that
+    proxy.setAddressFilter({"00:11:22:33:44:55", "invalid"});
+    QTRY_COMPARE(proxy.addressFilter(), QStringList{"00:11:22:33:44:55"});
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::ProxiesTest)
+
+#include "tst_proxies.moc"
@@ -0,0 +1,14 @@
+TARGET = tst_robotgateway
+
+include(../tests.pri)
+
+QT += network
+
+INCLUDEPATH += $$PWD/../../daemon
+
+HEADERS += \
+    ../../daemon/robotgateway.h
+
+SOURCES += \
+    ../../daemon/robotgateway.cpp \
+    tst_robotgateway.cpp
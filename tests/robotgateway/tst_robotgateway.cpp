@@ -0,0 +1,267 @@
+#include "robotgateway.h"
+#include "robotservice.h"
+
+#include <QSignalSpy>
+#include <QUdpSocket>
+#include <QtTest>
+
+#include <utility>
+
+namespace EvoBot {
+
+namespace {
+
+QByteArray message(quint8 type, quint8 robot, const QByteArray &payload = {})
+{
+    return QByteArray{1, static_cast<char>(type)} + static_cast<char>(robot) + payload;
+}
+
+QByteArray actionMessage(quint8 type, quint8 robot, char action, quint16 index)
+{
+    return message(type, robot, QByteArray{1, action} + static_cast<char>(index >> 8) + static_cast<char>(index & 0xff));
+}
+
+QByteArray errorMessage(quint8 type, quint8 robot, RobotGateway::Error error)
+{
+    return message(RobotGateway::ErrorMessage, robot, QByteArray{1, static_cast<char>(type)} + static_cast<char>(error));
+}
+
+QByteArray frameMessage(quint8 robot, const RobotFrame &frame)
+{
+    return message(RobotGateway::FrameMessage, robot, frame.toByteArray());
+}
+
+QByteArray stateMessage(quint8 robot, RobotService::State state)
+{
+    return message(RobotGateway::StateMessage, robot, QByteArray{1, static_cast<char>(state)});
+}
+
+// Waits for the gateway's reply while running the event loop, so that the gateway handles the request.
+QByteArray nextDatagram(QUdpSocket *socket, int timeout = 1000)
+{
+    if (!QTest::qWaitFor([socket] { return socket->hasPendingDatagrams(); }, timeout))
+        return {};
+
+    QByteArray datagram{static_cast<int>(socket->pendingDatagramSize()), Qt::Uninitialized};
+    datagram.resize(static_cast<int>(socket->readDatagram(datagram.data(), datagram.size())));
+    return datagram;
+}
+
+} // namespace
+
+class RobotGatewayTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void subscribe();
+    void subscribeAll();
+    void unsubscribe();
+    void subscriptionTimeout();
+    void errors_data();
+    void errors();
+    void frame();
+    void actions();
+    void burst();
+
+private:
+    void send(const QByteArray &datagram);
+
+    RobotGateway *m_gateway = {};
+    RobotService *m_service = {};
+    QUdpSocket *m_client = {};
+};
+
+void RobotGatewayTest::init()
+{
+    m_gateway = new RobotGateway{this};
+    m_service = new RobotService{this};
+    m_client = new QUdpSocket{this};
+
+    m_gateway->addRobot(1, m_service);
+
+    QVERIFY2(m_gateway->listen(QHostAddress::LocalHost, 0), qPrintable(m_gateway->errorString()));
+    QVERIFY(m_gateway->isListening());
+    QVERIFY(m_client->bind(QHostAddress::LocalHost, 0));
+}
+
+void RobotGatewayTest::cleanup()
+{
+    delete std::exchange(m_client, nullptr);
+    delete std::exchange(m_gateway, nullptr);
+    delete std::exchange(m_service, nullptr);
+}
+
+void RobotGatewayTest::send(const QByteArray &datagram)
+{
+    QCOMPARE(m_client->writeDatagram(datagram, QHostAddress::LocalHost, m_gateway->port()), qint64{datagram.size()});
+}
+
+// New subscribers receive the robot's state and frame, and then every change of them.
+void RobotGatewayTest::subscribe()
+{
+    send(message(RobotGateway::SubscribeMessage, 1));
+
+    QCOMPARE(nextDatagram(m_client), stateMessage(1, RobotService::DisconnectedState));
+    QCOMPARE(nextDatagram(m_client), frameMessage(1, RobotFrame::pause()));
+
+    QVERIFY(m_service->startAction(RobotService::ForwardAction, 3));
+    QCOMPARE(nextDatagram(m_client), frameMessage(1, m_service->currentMessage()));
+
+    // subscribing twice doesn't duplicate the messages
+    send(message(RobotGateway::SubscribeMessage, 1));
+    QCOMPARE(nextDatagram(m_client), stateMessage(1, RobotService::DisconnectedState));
+    QCOMPARE(nextDatagram(m_client), frameMessage(1, m_service->currentMessage()));
+
+    QVERIFY(m_service->startAction(RobotService::OpenClawAction));
+    QCOMPARE(nextDatagram(m_client), frameMessage(1, m_service->currentMessage()));
+    QCOMPARE(nextDatagram(m_client, 100), QByteArray{});
+}
+
+void RobotGatewayTest::subscribeAll()
+{
+    RobotService other;
+    m_gateway->addRobot(2, &other);
+
+    send(message(RobotGateway::SubscribeMessage, RobotGateway::AllRobots));
+
+    QList<QByteArray> datagrams;
+
+    for (auto i = 0; i < 4; ++i)
+        datagrams.append(nextDatagram(m_client));
+
+    QVERIFY(datagrams.contains(stateMessage(1, RobotService::DisconnectedState)));
+    QVERIFY(datagrams.contains(stateMessage(2, RobotService::DisconnectedState)));
+    QVERIFY(datagrams.contains(frameMessage(1, RobotFrame::pause())));
+    QVERIFY(datagrams.contains(frameMessage(2, RobotFrame::pause())));
+
+    QVERIFY(other.startAction(RobotService::ForwardAction, 1));
+    QCOMPARE(nextDatagram(m_client), frameMessage(2, other.currentMessage()));
+
+    // removed robots are no longer published
+    m_gateway->removeRobot(2);
+    QVERIFY(other.startAction(RobotService::ForwardAction, 2));
+    QCOMPARE(nextDatagram(m_client, 100), QByteArray{});
+}
+
+void RobotGatewayTest::unsubscribe()
+{
+    send(message(RobotGateway::SubscribeMessage, 1));
+    QVERIFY(!nextDatagram(m_client).isEmpty());
+    QVERIFY(!nextDatagram(m_client).isEmpty());
+
+    send(message(RobotGateway::UnsubscribeMessage, 1));
+    QTest::qWait(50);
+
+    QVERIFY(m_service->startAction(RobotService::ForwardAction, 3));
+    QCOMPARE(nextDatagram(m_client, 100), QByteArray{});
+}
+
+void RobotGatewayTest::subscriptionTimeout()
+{
+    QSignalSpy subscriptionTimeoutChanged{m_gateway, &RobotGateway::subscriptionTimeoutChanged};
+
+    m_gateway->setSubscriptionTimeout(100);
+    m_gateway->setSubscriptionTimeout(100);
+    QCOMPARE(subscriptionTimeoutChanged.count(), 1);
+    QCOMPARE(m_gateway->subscriptionTimeout(), 100);
+
+    send(message(RobotGateway::SubscribeMessage, 1));
+    QVERIFY(!nextDatagram(m_client).isEmpty());
+    QVERIFY(!nextDatagram(m_client).isEmpty());
+
+    // any message of the subscriber keeps the subscription alive
+    QTest::qWait(60);
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'F', 1));
+    QCOMPARE(nextDatagram(m_client), frameMessage(1, m_service->currentMessage()));
+
+    QTest::qWait(150);
+    QVERIFY(m_service->startAction(RobotService::ForwardAction, 3));
+    QCOMPARE(nextDatagram(m_client, 100), QByteArray{});
+}
+
+void RobotGatewayTest::errors_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<QByteArray>("reply");
+
+    QTest::newRow("subscribe unknown robot")
+            << message(RobotGateway::SubscribeMessage, 7)
+            << errorMessage(RobotGateway::SubscribeMessage, 7, RobotGateway::UnknownRobotError);
+    QTest::newRow("start action of unknown robot")
+            << actionMessage(RobotGateway::StartActionMessage, 7, 'F', 3)
+            << errorMessage(RobotGateway::StartActionMessage, 7, RobotGateway::UnknownRobotError);
+    QTest::newRow("frame of unknown robot")
+            << frameMessage(7, RobotFrame::pause())
+            << errorMessage(RobotGateway::FrameMessage, 7, RobotGateway::UnknownRobotError);
+    QTest::newRow("truncated action")
+            << actionMessage(RobotGateway::StopActionMessage, 1, 'F', 3).chopped(1)
+            << errorMessage(RobotGateway::StopActionMessage, 1, RobotGateway::MalformedMessageError);
+    QTest::newRow("oversized frame")
+            << frameMessage(1, RobotFrame::pause()) + '\0'
+            << errorMessage(RobotGateway::FrameMessage, 1, RobotGateway::MalformedMessageError);
+    QTest::newRow("unknown message")
+            << message(0x55, 1)
+            << errorMessage(0x55, 1, RobotGateway::MalformedMessageError);
+    QTest::newRow("unknown action")
+            << actionMessage(RobotGateway::StartActionMessage, 1, 'X', 0)
+            << errorMessage(RobotGateway::StartActionMessage, 1, RobotGateway::RejectedError);
+}
+
+void RobotGatewayTest::errors()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(QByteArray, reply);
+
+    send(request);
+    QCOMPARE(nextDatagram(m_client), reply);
+    QCOMPARE(m_service->currentMessage(), RobotFrame::pause());
+}
+
+void RobotGatewayTest::frame()
+{
+    auto frame = RobotFrame::pause();
+    frame.setDrive(3);
+    frame.setEyes(7);
+
+    send(frameMessage(1, frame));
+    QTRY_COMPARE(m_service->currentMessage(), frame);
+}
+
+void RobotGatewayTest::actions()
+{
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'F', 3));
+    QTRY_VERIFY(m_service->isActionActive(RobotService::ForwardAction, 3));
+
+    // the index is sent in network byte order, read the other way round it would be clamped
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'V', 5));
+    QTRY_VERIFY(m_service->isActionActive(RobotService::PlaySoundAction, 5));
+
+    send(actionMessage(RobotGateway::StopActionMessage, 1, 'F', 3));
+    QTRY_VERIFY(!m_service->isActionActive(RobotService::ForwardAction, 3));
+    QCOMPARE(nextDatagram(m_client, 100), QByteArray{});
+}
+
+// Datagrams that arrive together change the frame only once.
+void RobotGatewayTest::burst()
+{
+    QSignalSpy currentMessageChanged{m_service, &RobotService::currentMessageChanged};
+
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'F', 3));
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'O', 0));
+    send(actionMessage(RobotGateway::StartActionMessage, 1, 'U', 0));
+
+    QTRY_VERIFY(m_service->isActionActive(RobotService::RaiseArmAction));
+    QVERIFY(m_service->isActionActive(RobotService::ForwardAction, 3));
+    QVERIFY(m_service->isActionActive(RobotService::OpenClawAction));
+    QCOMPARE(currentMessageChanged.count(), 1);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::RobotGatewayTest)
+
+#include "tst_robotgateway.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_robotgroup
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_robotgroup.cpp
@@ -0,0 +1,285 @@
+#include "actionencoding.h"
+#include "robotgroup.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+namespace EvoBot {
+
+class RobotGroupTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void membership();
+    void apply();
+    void unknownAction();
+    void rejectedCommands();
+    void firmwareRevisions();
+    void heldBackActions();
+    void skew();
+    void soundSkew();
+    void writeModes();
+};
+
+void RobotGroupTest::membership()
+{
+    RobotGroup group;
+    QSignalSpy countChanged{&group, &RobotGroup::countChanged};
+
+    RobotService first;
+    RobotService second;
+    auto third = std::make_unique<RobotService>();
+
+    group.addService(&first);
+    group.addService(&first);
+    group.addService(nullptr);
+    group.addService(&second);
+    group.addService(third.get());
+
+    QCOMPARE(group.count(), 3);
+    QCOMPARE(countChanged.count(), 3);
+    QCOMPARE(group.services(), (QList<RobotService *>{&first, &second, third.get()}));
+
+    // destroyed members leave the group
+    third.reset();
+    QCOMPARE(group.count(), 2);
+
+    group.removeService(&first);
+    QCOMPARE(group.services(), QList<RobotService *>{&second});
+
+    QVERIFY(group.startAction(RobotService::ForwardAction, 2));
+    QVERIFY(!first.isActionActive(RobotService::ForwardAction, 2));
+
+    group.clear();
+    QCOMPARE(group.count(), 0);
+    QCOMPARE(countChanged.count(), 6);
+}
+
+void RobotGroupTest::apply()
+{
+    RobotService first;
+    RobotService second;
+
+    RobotGroup group;
+    group.addService(&first);
+    group.addService(&second);
+
+    QSignalSpy firstChanged{&first, &RobotService::currentMessageChanged};
+    QSignalSpy secondChanged{&second, &RobotService::currentMessageChanged};
+
+    // each member changes its frame once for all of the commands
+    QVERIFY(group.applyActions("F2 O V5"));
+    QCOMPARE(firstChanged.count(), 1);
+    QCOMPARE(secondChanged.count(), 1);
+
+    for (const auto service: {&first, &second}) {
+        QVERIFY(service->isActionActive(RobotService::ForwardAction, 2));
+        QVERIFY(service->isActionActive(RobotService::OpenClawAction));
+        QVERIFY(service->isActionActive(RobotService::PlaySoundAction, 5));
+    }
+
+    QVERIFY(group.stopAction(RobotService::ForwardAction, 2));
+    QVERIFY(group.playSound(7));
+    QCOMPARE(first.currentMessage(), second.currentMessage());
+    QVERIFY(!first.isActionActive(RobotService::ForwardAction, 2));
+    QVERIFY(first.isActionActive(RobotService::PlaySoundAction, 7));
+}
+
+// Unknown actions are refused before any member gets changed.
+void RobotGroupTest::unknownAction()
+{
+    RobotService service;
+
+    RobotGroup group;
+    group.addService(&service);
+
+    auto rejected = 0;
+    connect(&group, &RobotGroup::commandsRejected, this, [&rejected] { ++rejected; });
+
+    QVERIFY(!group.applyActions("F2 X1"));
+    QVERIFY(!group.applyActions("F2 *"));
+    QCOMPARE(service.currentMessage(), RobotFrame::pause());
+    QCOMPARE(rejected, 0);
+}
+
+// Members rejecting a command don't keep the others from applying it.
+void RobotGroupTest::rejectedCommands()
+{
+    RobotService driving;
+    RobotService standing;
+    QVERIFY(driving.startAction(RobotService::ForwardAction, 2));
+
+    RobotGroup group;
+    group.addService(&driving);
+    group.addService(&standing);
+
+    QList<RobotService *> rejectingServices;
+    connect(&group, &RobotGroup::commandsRejected, this, [&rejectingServices](const auto &services) {
+        rejectingServices = services;
+    });
+
+    QVERIFY(!group.applyActions("-F2 O"));
+    QCOMPARE(rejectingServices, QList<RobotService *>{&standing});
+
+    QVERIFY(!driving.isActionActive(RobotService::ForwardAction, 2));
+    QVERIFY(driving.isActionActive(RobotService::OpenClawAction));
+    QVERIFY(standing.isActionActive(RobotService::OpenClawAction));
+}
+
+// Each member encodes the commands for its own firmware.
+void RobotGroupTest::firmwareRevisions()
+{
+    RobotService first;
+    first.setFirmwareRevision(1);
+    RobotService second;
+    second.setFirmwareRevision(2);
+
+    RobotGroup group;
+    group.addService(&first);
+    group.addService(&second);
+
+    QVERIFY(group.startAction(RobotService::EyesAction, 5));
+
+    QCOMPARE(first.currentMessage().at(RobotFrame::EyesField), ActionEncoding::forFirmware(1).encode('E', 5).value);
+    QCOMPARE(second.currentMessage().at(RobotFrame::EyesField), ActionEncoding::forFirmware(2).encode('E', 5).value);
+}
+
+void RobotGroupTest::heldBackActions()
+{
+    RobotService waiting;
+    waiting.attach(new SimulatedTransport);
+    RobotService ready;
+    ready.setFirmwareRevision(2);
+
+    RobotGroup group;
+    group.addService(&waiting);
+    group.addService(&ready);
+
+    QVERIFY(group.startAction(RobotService::EyesAction, 5));
+    QVERIFY(ready.isActionActive(RobotService::EyesAction, 5));
+    QVERIFY(!waiting.isActionActive(RobotService::EyesAction, 5));
+
+    waiting.setFirmwareRevision(2);
+    QVERIFY(waiting.isActionActive(RobotService::EyesAction, 5));
+}
+
+// The skew is the spread of the acknowledgements, here at least the difference of the latencies.
+void RobotGroupTest::skew()
+{
+    std::vector<std::unique_ptr<RobotService>> services;
+    RobotGroup group;
+
+    for (const auto latency: {10, 30, 60}) {
+        services.push_back(std::make_unique<RobotService>());
+
+        const auto transport = new SimulatedTransport;
+        transport->setWriteLatency(latency);
+        services.back()->attach(transport);
+        transport->connectToRobot();
+
+        group.addService(services.back().get());
+    }
+
+    QSignalSpy skewMeasured{&group, &RobotGroup::skewMeasured};
+    QCOMPARE(group.skew(), -1);
+
+    QVERIFY(group.startAction(RobotService::ForwardAction, 3));
+    QTRY_COMPARE(skewMeasured.count(), 1);
+
+    QCOMPARE(skewMeasured.first().at(1).toInt(), 3);
+    QCOMPARE(skewMeasured.first().at(0).toInt(), group.skew());
+    QVERIFY(group.skew() >= 35);
+    QVERIFY(group.skew() < 1000);
+
+    for (const auto &service: services)
+        QVERIFY(service->isActionActive(RobotService::ForwardAction, 3));
+}
+
+// Robots with the same latency play a sound together, whenever they last wrote a keep-alive.
+void RobotGroupTest::soundSkew()
+{
+    std::vector<std::unique_ptr<RobotService>> services;
+    RobotGroup group;
+
+    for (auto i = 0; i < 3; ++i) {
+        services.push_back(std::make_unique<RobotService>());
+
+        // only the connection starts a write, no keep-alive follows during the test
+        const auto scheduler = services.back()->transmitScheduler();
+        scheduler->setMinimumInterval(2000);
+        scheduler->setKeepAliveInterval(2000);
+
+        const auto transport = new SimulatedTransport;
+        transport->setWriteLatency(20);
+        services.back()->attach(transport);
+
+        group.addService(services.back().get());
+    }
+
+    // the first robot wrote a while ago, the others just now
+    qobject_cast<SimulatedTransport *>(services[0]->transport())->connectToRobot();
+    QTest::qWait(250);
+
+    for (size_t i = 1; i < services.size(); ++i)
+        qobject_cast<SimulatedTransport *>(services[i]->transport())->connectToRobot();
+
+    for (const auto &service: services)
+        QTRY_VERIFY(!service->transmitScheduler()->isWritePending());
+
+    QSignalSpy skewMeasured{&group, &RobotGroup::skewMeasured};
+
+    QVERIFY(group.playSound(3));
+    QTRY_COMPARE(skewMeasured.count(), 1);
+
+    QCOMPARE(skewMeasured.first().at(1).toInt(), 3);
+    QVERIFY(group.skew() >= 0);
+    QVERIFY2(group.skew() < 100, qPrintable(QString::number(group.skew())));
+}
+
+// Asking for writes without response only counts if the transport supports them.
+void RobotGroupTest::writeModes()
+{
+    std::vector<std::unique_ptr<RobotService>> services;
+    RobotGroup group;
+
+    for (const auto supported: {true, false, false}) {
+        services.push_back(std::make_unique<RobotService>());
+        services.back()->setWriteWithoutResponse(true);
+
+        const auto transport = new SimulatedTransport;
+        transport->setWriteLatency(10);
+        transport->setWriteWithoutResponseSupported(supported);
+        services.back()->attach(transport);
+        transport->connectToRobot();
+
+        group.addService(services.back().get());
+    }
+
+    QVERIFY(services[0]->writesWithoutResponse());
+    QVERIFY(!services[1]->writesWithoutResponse());
+    QVERIFY(!services[2]->writesWithoutResponse());
+
+    for (const auto &service: services)
+        QTRY_VERIFY(!service->transmitScheduler()->isWritePending());
+
+    QSignalSpy skewMeasured{&group, &RobotGroup::skewMeasured};
+
+    QVERIFY(group.startAction(RobotService::ForwardAction, 3));
+    QTRY_COMPARE(skewMeasured.count(), 1);
+
+    QCOMPARE(skewMeasured.first().at(1).toInt(), 2);
+    QVERIFY(group.skew() >= 0);
+    QVERIFY(group.skew() < 1000);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::RobotGroupTest)
+
+#include "tst_robotgroup.moc"
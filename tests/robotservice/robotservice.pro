@@ -0,0 +1,6 @@
+TARGET = tst_robotservice
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_robotservice.cpp
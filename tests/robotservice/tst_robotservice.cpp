@@ -0,0 +1,356 @@
+#include "actionencoding.h"
+#include "robotmetrics.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+#include "transmitscheduler.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest>
+
+#include <algorithm>
+
+namespace EvoBot {
+
+namespace {
+
+bool carries(const QList<QVariant> &arguments, const ActionEncoding::Fragment &fragment)
+{
+    return arguments.first().value<RobotFrame>().at(fragment.offset) == fragment.value;
+}
+
+bool hasReceived(const QSignalSpy &frames, const ActionEncoding::Fragment &fragment)
+{
+    return std::any_of(frames.begin(), frames.end(), [&fragment](const auto &arguments) {
+        return carries(arguments, fragment);
+    });
+}
+
+int timesReceived(const QSignalSpy &frames, const ActionEncoding::Fragment &fragment)
+{
+    return static_cast<int>(std::count_if(frames.begin(), frames.end(), [&fragment](const auto &arguments) {
+        return carries(arguments, fragment);
+    }));
+}
+
+} // namespace
+
+class RobotServiceTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void driveVector_data();
+    void driveVector();
+    void driveAxisHysteresis();
+    void driveLevelHysteresis();
+    void driveRateLimit();
+    void holdBackUntilFirmwareRevision();
+    void holdBackUntilTimeout();
+    void holdBackStops();
+    void eyesPulse();
+    void eyesPulseKeepsNewerValue();
+    void fieldSignals();
+    void resetCurrentMessage();
+};
+
+void RobotServiceTest::driveVector_data()
+{
+    QTest::addColumn<qreal>("x");
+    QTest::addColumn<qreal>("y");
+    QTest::addColumn<QChar>("action");
+    QTest::addColumn<int>("level");
+
+    QTest::newRow("forward") << qreal{0} << qreal{1} << QChar{'F'} << 3;
+    QTest::newRow("backward") << qreal{0} << qreal{-0.3} << QChar{'B'} << 0;
+    QTest::newRow("right") << qreal{0.5} << qreal{0} << QChar{'R'} << 1;
+    QTest::newRow("left") << qreal{-0.5} << qreal{0} << QChar{'L'} << 1;
+    QTest::newRow("diagonal") << qreal{0.6} << qreal{0.6} << QChar{'F'} << 3;
+    QTest::newRow("dead zone") << qreal{0} << qreal{0.1} << QChar{'S'} << 0;
+}
+
+void RobotServiceTest::driveVector()
+{
+    QFETCH(qreal, x);
+    QFETCH(qreal, y);
+    QFETCH(QChar, action);
+    QFETCH(int, level);
+
+    RobotService service;
+    service.setDriveVector(x, y);
+
+    if (action == 'S')
+        QCOMPARE(service.drive(), RobotFrame::pause().drive());
+    else
+        QVERIFY(service.isActionActive(action, level));
+}
+
+// Near the diagonal the robot keeps the axis it already drives on.
+void RobotServiceTest::driveAxisHysteresis()
+{
+    RobotService forward;
+    forward.setDriveVector(0, 1);
+    QVERIFY(forward.isActionActive('F', 3));
+
+    forward.setDriveVector(0.8, 0.7);
+    QTest::qWait(2 * forward.transmitScheduler()->effectiveMinimumInterval());
+    QVERIFY(forward.isActionActive('F', 3));
+
+    RobotService idle;
+    idle.setDriveVector(0.8, 0.7);
+    QVERIFY(idle.isActionActive('R', 3));
+
+    forward.setDriveVector(1, 0.7);
+    QTRY_VERIFY(forward.isActionActive('R', 3));
+}
+
+void RobotServiceTest::driveLevelHysteresis()
+{
+    RobotService service;
+    service.setDriveVector(0, 0.47);
+    QVERIFY(service.isActionActive('F', 1));
+
+    // slightly above the next level's threshold
+    service.setDriveVector(0, 0.596);
+    QTest::qWait(2 * service.transmitScheduler()->effectiveMinimumInterval());
+    QVERIFY(service.isActionActive('F', 1));
+
+    service.setDriveVector(0, 0.62);
+    QTRY_VERIFY(service.isActionActive('F', 2));
+}
+
+// Changes within the transmit interval are merged into one change at its end.
+void RobotServiceTest::driveRateLimit()
+{
+    RobotService service;
+    const auto interval = service.transmitScheduler()->effectiveMinimumInterval();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    service.setDriveVector(0, 1);
+    QVERIFY(service.isActionActive('F', 3));
+
+    QSignalSpy driveChanged{&service, &RobotService::driveChanged};
+
+    service.setDriveVector(0, -1);
+    service.setDriveVector(1, 0);
+    QVERIFY(service.isActionActive('F', 3));
+
+    QTRY_VERIFY(service.isActionActive('R', 3));
+    QVERIFY(clock.elapsed() >= interval - 5);
+    QCOMPARE(driveChanged.count(), 1);
+
+    // going back to the current command cancels the pending change
+    service.setDriveVector(0, 1);
+    service.setDriveVector(1, 0);
+    QTest::qWait(2 * interval);
+    QVERIFY(service.isActionActive('R', 3));
+    QCOMPARE(driveChanged.count(), 1);
+}
+
+// Eyes look different with each firmware, so they wait until the revision is known.
+void RobotServiceTest::holdBackUntilFirmwareRevision()
+{
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+
+    QSignalSpy currentMessageChanged{&service, &RobotService::currentMessageChanged};
+    QSignalSpy framesReceived{transport, &SimulatedTransport::currentFrameChanged};
+
+    QVERIFY(service.startAction(RobotService::EyesAction, 5));
+    QCOMPARE(service.eyes(), RobotFrame::pause().eyes());
+    QCOMPARE(currentMessageChanged.count(), 0);
+
+    // other actions don't wait
+    QVERIFY(service.startAction(RobotService::ForwardAction, 2));
+    QCOMPARE(currentMessageChanged.count(), 1);
+
+    transport->connectToRobot(1);
+    QCOMPARE(service.firmwareRevision(), 1);
+    QCOMPARE(currentMessageChanged.count(), 2);
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 2));
+
+    QTRY_VERIFY(hasReceived(framesReceived, ActionEncoding::forFirmware(1).encode('E', 5)));
+    QVERIFY(!hasReceived(framesReceived, ActionEncoding::forFirmware(2).encode('E', 5)));
+}
+
+void RobotServiceTest::holdBackUntilTimeout()
+{
+    RobotService service;
+    service.attach(new SimulatedTransport);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QVERIFY(service.startAction(RobotService::EyesAction, 5));
+    QVERIFY(!service.isActionActive(RobotService::EyesAction, 5));
+
+    QTRY_VERIFY_WITH_TIMEOUT(service.isActionActive(RobotService::EyesAction, 5), 7000);
+    QVERIFY(clock.elapsed() >= 4900);
+    QCOMPARE(service.firmwareRevision(), -1);
+
+    // once released, nothing is held back anymore
+    QVERIFY(service.startAction(RobotService::EyesAction, 6));
+    QVERIFY(service.isActionActive(RobotService::EyesAction, 6));
+}
+
+// Held back actions are applied in order, so a stop cancels the earlier start.
+void RobotServiceTest::holdBackStops()
+{
+    RobotService service;
+    service.attach(new SimulatedTransport);
+
+    QSignalSpy eyesChanged{&service, &RobotService::eyesChanged};
+
+    QVERIFY(service.startAction(RobotService::EyesAction, 5));
+    QVERIFY(service.stopAction(RobotService::EyesAction, 5));
+    QVERIFY(service.startAction(RobotService::EyesAction, 7));
+
+    service.setFirmwareRevision(2);
+
+    QVERIFY(service.isActionActive(RobotService::EyesAction, 7));
+    QCOMPARE(eyesChanged.count(), 1);
+}
+
+// The eyes animation is written once, clearing the field afterwards is no change to transmit.
+void RobotServiceTest::eyesPulse()
+{
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+    transport->connectToRobot();
+
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+
+    QSignalSpy eyesChanged{&service, &RobotService::eyesChanged};
+    QSignalSpy framesReceived{transport, &SimulatedTransport::currentFrameChanged};
+    const auto changeWrites = service.metrics()->changeWrites();
+
+    QVERIFY(service.startAction(RobotService::EyesAction, 5));
+    QCOMPARE(eyesChanged.count(), 1);
+
+    QTRY_COMPARE(service.eyes(), 0);
+    QCOMPARE(eyesChanged.count(), 2);
+    QCOMPARE(eyesChanged.last().first().toInt(), 0);
+
+    // the keep-alives that follow don't repeat the animation
+    const auto eyes = ActionEncoding::forFirmware(2).encode('E', 5);
+    QTRY_VERIFY(timesReceived(framesReceived, eyes) < framesReceived.count());
+    QTest::qWait(2 * service.transmitScheduler()->keepAliveInterval());
+
+    QCOMPARE(timesReceived(framesReceived, eyes), 1);
+    QCOMPARE(service.metrics()->changeWrites(), changeWrites + 1);
+}
+
+// Eyes changed while the previous animation was still being written aren't cleared by its acknowledgement.
+void RobotServiceTest::eyesPulseKeepsNewerValue()
+{
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    transport->setWriteLatency(200);
+    service.attach(transport);
+    service.transmitScheduler()->setCosmeticInterval(0);
+    transport->connectToRobot();
+
+    QTRY_VERIFY(!service.transmitScheduler()->isWritePending());
+
+    QSignalSpy framesReceived{transport, &SimulatedTransport::currentFrameChanged};
+
+    QVERIFY(service.startAction(RobotService::EyesAction, 5));
+    QVERIFY(service.transmitScheduler()->isWritePending());
+    QVERIFY(service.startAction(RobotService::EyesAction, 6));
+
+    QTRY_VERIFY(hasReceived(framesReceived, ActionEncoding::forFirmware(2).encode('E', 5)));
+    QVERIFY(service.isActionActive(RobotService::EyesAction, 6));
+
+    QTRY_VERIFY(hasReceived(framesReceived, ActionEncoding::forFirmware(2).encode('E', 6)));
+    QTRY_COMPARE(service.eyes(), 0);
+}
+
+void RobotServiceTest::fieldSignals()
+{
+    RobotService service;
+
+    QSignalSpy currentMessageChanged{&service, &RobotService::currentMessageChanged};
+    QSignalSpy driveChanged{&service, &RobotService::driveChanged};
+    QSignalSpy clawChanged{&service, &RobotService::clawChanged};
+    QSignalSpy armChanged{&service, &RobotService::armChanged};
+    QSignalSpy soundChanged{&service, &RobotService::soundChanged};
+
+    // setting the current values changes nothing
+    service.setCurrentMessage(RobotFrame::pause());
+    service.setDrive(RobotFrame::pause().drive());
+    QCOMPARE(currentMessageChanged.count(), 0);
+    QCOMPARE(driveChanged.count(), 0);
+
+    QVERIFY(service.startAction(RobotService::ForwardAction, 2));
+    QCOMPARE(currentMessageChanged.count(), 1);
+    QCOMPARE(driveChanged.count(), 1);
+    QCOMPARE(driveChanged.first().first().toInt(), service.drive());
+    QCOMPARE(clawChanged.count(), 0);
+
+    auto frame = service.currentMessage();
+    frame.setClaw(0x3c);
+    frame.setArm(0x3e);
+    service.setCurrentMessage(frame);
+
+    QCOMPARE(currentMessageChanged.count(), 2);
+    QCOMPARE(driveChanged.count(), 1);
+    QCOMPARE(clawChanged.count(), 1);
+    QCOMPARE(armChanged.count(), 1);
+    QCOMPARE(soundChanged.count(), 0);
+
+    // an update emits the fields that differ at its end
+    service.beginUpdate();
+    QVERIFY(service.startAction(RobotService::CloseClawAction));
+    QVERIFY(service.startAction(RobotService::OpenClawAction));
+    QVERIFY(service.startAction(RobotService::PlaySoundAction, 3));
+    service.commit();
+
+    QCOMPARE(currentMessageChanged.count(), 3);
+    QCOMPARE(clawChanged.count(), 1);
+    QCOMPARE(soundChanged.count(), 1);
+}
+
+// Resetting the message while reconnecting doesn't write to the transport, the robot receives it later.
+void RobotServiceTest::resetCurrentMessage()
+{
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+    transport->connectToRobot();
+
+    QVERIFY(service.startAction(RobotService::ForwardAction, 2));
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+    QTRY_VERIFY(!service.transmitScheduler()->isWritePending());
+
+    QSignalSpy currentMessageChanged{&service, &RobotService::currentMessageChanged};
+    QSignalSpy driveChanged{&service, &RobotService::driveChanged};
+    const auto writesIssued = service.metrics()->writesIssued();
+
+    service.resetCurrentMessage(RobotFrame::pause());
+
+    QCOMPARE(service.currentMessage(), RobotFrame::pause());
+    QCOMPARE(currentMessageChanged.count(), 1);
+    QCOMPARE(driveChanged.count(), 1);
+    QCOMPARE(service.metrics()->writesIssued(), writesIssued);
+    QVERIFY(transport->currentFrame() != RobotFrame::pause());
+
+    // setting the message instead transmits a stop right away
+    QVERIFY(service.startAction(RobotService::ForwardAction, 2));
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+    QTRY_VERIFY(!service.transmitScheduler()->isWritePending());
+
+    const auto writesBeforeStop = service.metrics()->writesIssued();
+    service.setCurrentMessage(RobotFrame::pause());
+    QCOMPARE(service.metrics()->writesIssued(), writesBeforeStop + 1);
+    QTRY_COMPARE(transport->currentFrame(), RobotFrame::pause());
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::RobotServiceTest)
+
+#include "tst_robotservice.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_sequencer
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_sequencer.cpp
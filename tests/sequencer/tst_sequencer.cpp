@@ -0,0 +1,354 @@
+#include "actionencoding.h"
+#include "robotservice.h"
+#include "sequencer.h"
+#include "simulatedtransport.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+// Describes the steps like "0:F2,O 500:-F2", which is easier to compare than the routine.
+QString describe(const Routine &routine)
+{
+    QStringList steps;
+
+    for (const auto &step: routine) {
+        QStringList commands;
+
+        for (const auto &command: step.commands) {
+            commands.append((command.stop ? QStringLiteral("-") : QString{})
+                            + QChar::fromLatin1(command.action) + QString::number(command.index));
+        }
+
+        steps.append(QString::number(step.time.count()) + ':' + commands.join(','));
+    }
+
+    return steps.join(' ');
+}
+
+} // namespace
+
+class SequencerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseRoutine_data();
+    void parseRoutine();
+    void parseMacro_data();
+    void parseMacro();
+    void play();
+    void loop();
+    void defineMacro();
+    void macroFirmwareRevision();
+    void oneShotActions_data();
+    void oneShotActions();
+    void soundNotifications_data();
+    void soundNotifications();
+    void macroAudioLoop();
+};
+
+void SequencerTest::parseRoutine_data()
+{
+    QTest::addColumn<QStringList>("lines");
+    QTest::addColumn<QString>("steps");
+
+    QTest::newRow("sorted") << QStringList{"0 F2 O", "500ms -F2 V3", "1.5s S"} << "0:F2,O0 500:-F2,V3 1500:S0";
+    QTest::newRow("unsorted") << QStringList{"1s B1", "0 F1", "1s L1"} << "0:F1 1000:B1 1000:L1";
+    QTest::newRow("comments") << QStringList{"# forward", "", "  200 F3  "} << "200:F3";
+    QTest::newRow("invalid time") << QStringList{"0 F1", "5x F2"} << QString{};
+    QTest::newRow("invalid action") << QStringList{"100ms F2*"} << QString{};
+    QTest::newRow("negative time") << QStringList{"-100 F2"} << QString{};
+}
+
+void SequencerTest::parseRoutine()
+{
+    QFETCH(QStringList, lines);
+    QFETCH(QString, steps);
+
+    Routine routine;
+    QString errorString;
+    const auto valid = EvoBot::parseRoutine(lines, &routine, &errorString);
+
+    QCOMPARE(valid, !steps.isEmpty());
+    QCOMPARE(errorString.isEmpty(), valid);
+
+    if (valid)
+        QCOMPARE(describe(routine), steps);
+}
+
+void SequencerTest::parseMacro_data()
+{
+    QTest::addColumn<QString>("macro");
+    QTest::addColumn<QString>("steps");
+
+    QTest::newRow("segments") << "F3 500ms; L1 200ms; V5" << "0:F3 500:-F3 500:L1 700:-L1 700:V5";
+    QTest::newRow("without duration") << "F2 O; V5 300ms" << "0:F2,O0 0:V5 300:-V5";
+    QTest::newRow("trailing pause") << "F1 100ms; 300ms" << "0:F1 100:-F1 400:";
+    QTest::newRow("empty segments") << "; F1 1s;; " << "0:F1 1000:-F1";
+    QTest::newRow("pause") << "F1 O 100ms; S" << "0:F1,O0 100:-F1,-O0 100:S0";
+    QTest::newRow("invalid duration") << "F3 5x0ms" << QString{};
+    QTest::newRow("invalid action") << "F3 100ms; L1* 200ms" << QString{};
+}
+
+void SequencerTest::parseMacro()
+{
+    QFETCH(QString, macro);
+    QFETCH(QString, steps);
+
+    Routine routine;
+    QString errorString;
+    const auto valid = EvoBot::parseMacro(macro, &routine, &errorString);
+
+    QCOMPARE(valid, !steps.isEmpty());
+    QCOMPARE(errorString.isEmpty(), valid);
+
+    if (valid)
+        QCOMPARE(describe(routine), steps);
+}
+
+void SequencerTest::play()
+{
+    RobotService service;
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    sequencer.addRobotService(&service);
+    QCOMPARE(sequencer.robotServices(), QList<RobotService *>{&service});
+
+    QSignalSpy durationChanged{&sequencer, &Sequencer::durationChanged};
+    QSignalSpy playingChanged{&sequencer, &Sequencer::playingChanged};
+    QSignalSpy finished{&sequencer, &Sequencer::finished};
+
+    QVERIFY(sequencer.load(QStringList{"0 F2", "100ms -F2 O", "200ms S"}));
+    QCOMPARE(sequencer.duration(), 200);
+    QCOMPARE(durationChanged.count(), 1);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    // the first cue is applied right away
+    sequencer.start();
+    QVERIFY(sequencer.isPlaying());
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 2));
+
+    QTRY_VERIFY(service.isActionActive(RobotService::OpenClawAction));
+    QVERIFY(!service.isActionActive(RobotService::ForwardAction, 2));
+    QVERIFY(clock.elapsed() >= 95);
+
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(clock.elapsed() >= 195);
+    QVERIFY(!sequencer.isPlaying());
+    QCOMPARE(playingChanged.count(), 2);
+    QCOMPARE(service.currentMessage(), RobotFrame::pause());
+
+    // invalid routines keep the loaded one
+    QVERIFY(!sequencer.load(QStringList{"0 F2", "later S"}));
+    QVERIFY(!sequencer.errorString().isEmpty());
+    QCOMPARE(sequencer.duration(), 200);
+}
+
+void SequencerTest::loop()
+{
+    RobotService service;
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    sequencer.setLooping(true);
+
+    QSignalSpy driveChanged{&service, &RobotService::driveChanged};
+    QSignalSpy finished{&sequencer, &Sequencer::finished};
+
+    QVERIFY(sequencer.load(QStringList{"0 F1", "50 F2", "100 F2"}));
+    sequencer.start();
+
+    QTest::qWait(450);
+    QVERIFY(sequencer.isPlaying());
+    QVERIFY(driveChanged.count() >= 6);
+    QCOMPARE(finished.count(), 0);
+
+    sequencer.stop();
+    QVERIFY(!sequencer.isPlaying());
+
+    const auto changes = driveChanged.count();
+    QTest::qWait(150);
+    QCOMPARE(driveChanged.count(), changes);
+}
+
+void SequencerTest::defineMacro()
+{
+    RobotService service;
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+
+    QVERIFY(sequencer.defineMacro("forward", "F1 100ms"));
+    QVERIFY(!sequencer.defineMacro("broken", "F1 1x"));
+    QCOMPARE(sequencer.macros(), QStringList{"forward"});
+
+    QVERIFY(!sequencer.playMacro("backward"));
+    QVERIFY(sequencer.errorString().contains("backward"));
+
+    QVERIFY(sequencer.playMacro("forward"));
+    QVERIFY(sequencer.errorString().isEmpty());
+    QVERIFY(sequencer.isPlaying());
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 1));
+    QCOMPARE(sequencer.duration(), 100);
+    sequencer.stop();
+
+    // redefining a macro replaces its compiled frames
+    QVERIFY(sequencer.defineMacro("forward", "F3 100ms"));
+    QVERIFY(sequencer.playMacro("forward"));
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 3));
+    QTRY_VERIFY(!sequencer.isPlaying());
+    QCOMPARE(service.currentMessage(), RobotFrame::pause());
+
+    sequencer.removeMacro("forward");
+    QVERIFY(sequencer.macros().isEmpty());
+    QVERIFY(!sequencer.playMacro("forward"));
+}
+
+// Compiled macros are dropped once the robot reports another firmware revision.
+void SequencerTest::macroFirmwareRevision()
+{
+    RobotService service;
+    service.setFirmwareRevision(2);
+
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    QVERIFY(sequencer.defineMacro("eyes", "E5; F1 100ms"));
+
+    QVERIFY(sequencer.playMacro("eyes"));
+    QCOMPARE(service.currentMessage().at(RobotFrame::EyesField), ActionEncoding::forFirmware(2).encode('E', 5).value);
+    sequencer.stop();
+
+    service.setFirmwareRevision(1);
+
+    QVERIFY(sequencer.playMacro("eyes"));
+    QCOMPARE(service.currentMessage().at(RobotFrame::EyesField), ActionEncoding::forFirmware(1).encode('E', 5).value);
+}
+
+void SequencerTest::oneShotActions_data()
+{
+    QTest::addColumn<QString>("macro");
+    QTest::addColumn<int>("field");
+    QTest::addColumn<bool>("repeated");
+
+    QTest::newRow("sound") << "V5; F3 200ms; F1 200ms" << static_cast<int>(RobotFrame::SoundField) << false;
+    QTest::newRow("eyes") << "E7; L1 200ms; R1 200ms" << static_cast<int>(RobotFrame::EyesField) << false;
+    QTest::newRow("audio loop") << "M5; F3 200ms; F1 200ms" << static_cast<int>(RobotFrame::SoundField) << true;
+}
+
+// Sounds and eye animations trigger once, only audio loops remain in the later frames.
+void SequencerTest::oneShotActions()
+{
+    QFETCH(QString, macro);
+    QFETCH(int, field);
+    QFETCH(bool, repeated);
+
+    RobotService service;
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    QVERIFY(sequencer.defineMacro("macro", macro));
+
+    QSignalSpy currentMessageChanged{&service, &RobotService::currentMessageChanged};
+
+    QVERIFY(sequencer.playMacro("macro"));
+
+    const auto value = service.currentMessage().at(field);
+    QVERIFY(value != RobotFrame::pause().at(field));
+
+    QTRY_COMPARE(currentMessageChanged.count(), 2);
+    QCOMPARE(service.currentMessage().at(field) == value, repeated);
+
+    QTRY_VERIFY(!sequencer.isPlaying());
+}
+
+void SequencerTest::soundNotifications_data()
+{
+    QTest::addColumn<QString>("macro");
+    QTest::addColumn<int>("manualLoop");
+    QTest::addColumn<bool>("looping");
+
+    QTest::newRow("sound") << "V5; F3 300ms" << -1 << false;
+    QTest::newRow("audio loop") << "M5; F3 300ms" << -1 << true;
+    QTest::newRow("sound after manual loop") << "V5; F3 300ms" << 3 << false;
+}
+
+// The robot reports played sounds, which ends sounds played with V but not audio loops.
+void SequencerTest::soundNotifications()
+{
+    QFETCH(QString, macro);
+    QFETCH(int, manualLoop);
+    QFETCH(bool, looping);
+
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    transport->setSoundStartDelay(10);
+    transport->setSoundDuration(50);
+    service.attach(transport);
+    transport->connectToRobot();
+
+    if (manualLoop >= 0) {
+        QVERIFY(service.playLoop(manualLoop));
+        QTRY_COMPARE(service.currentSound(), manualLoop);
+    }
+
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    QVERIFY(sequencer.defineMacro("macro", macro));
+
+    QSignalSpy currentSoundChanged{&service, &RobotService::currentSoundChanged};
+    QVERIFY(sequencer.playMacro("macro"));
+
+    QTRY_COMPARE(currentSoundChanged.count(), 1);
+    QCOMPARE(service.currentSound(), 5);
+    QCOMPARE(service.isActionActive(RobotService::PlayLoopAction, 5), looping);
+
+    QTRY_COMPARE(currentSoundChanged.count(), 2);
+    QCOMPARE(service.currentSound(), looping ? 5 : -5);
+    QCOMPARE(service.isActionActive(RobotService::PlayLoopAction, 5), looping);
+    QVERIFY(sequencer.isPlaying());
+
+    // the later cues keep the loop running
+    QTRY_VERIFY(!sequencer.isPlaying());
+    QCOMPARE(service.isActionActive(RobotService::PlayLoopAction, 5), looping);
+}
+
+// Compiled macros keep telling the service that their sound loops when played again.
+void SequencerTest::macroAudioLoop()
+{
+    RobotService service;
+    const auto transport = new SimulatedTransport;
+    transport->setSoundStartDelay(10);
+    transport->setSoundDuration(50);
+    service.attach(transport);
+    transport->connectToRobot();
+
+    Sequencer sequencer;
+    sequencer.addRobotService(&service);
+    QVERIFY(sequencer.defineMacro("loop", "M5; F1 200ms"));
+
+    QSignalSpy currentSoundChanged{&service, &RobotService::currentSoundChanged};
+
+    for (auto play = 0; play < 2; ++play) {
+        QVERIFY(sequencer.playMacro("loop"));
+        QTRY_VERIFY(!sequencer.isPlaying());
+
+        QVERIFY(currentSoundChanged.count() >= 2);
+        QCOMPARE(service.currentSound(), 5);
+        QVERIFY(service.isActionActive(RobotService::PlayLoopAction, 5));
+
+        // a new sound has to start for the robot to report it again
+        QVERIFY(service.stopAction(RobotService::PlayLoopAction, 5));
+        QTRY_COMPARE(transport->currentFrame().sound(), RobotFrame::pause().sound());
+        currentSoundChanged.clear();
+    }
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::SequencerTest)
+
+#include "tst_sequencer.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_session
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_session.cpp
@@ -0,0 +1,279 @@
+#include "robotservice.h"
+#include "sessionrecorder.h"
+#include "sessionreplayer.h"
+#include "simulatedtransport.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+
+namespace EvoBot {
+
+namespace {
+
+RobotFrame driveFrame(int drive)
+{
+    auto frame = RobotFrame::pause();
+    frame.setDrive(drive);
+    return frame;
+}
+
+// A session of frames written with response, each acknowledged after the given latency.
+QList<SessionRecord> acknowledgedFrames(int count, qint64 interval, qint64 latency)
+{
+    QList<SessionRecord> records;
+
+    for (auto i = 0; i < count; ++i) {
+        const auto timestamp = i * interval;
+
+        records.append({timestamp, SessionRecord::FrameRecord, driveFrame(1 + i).toByteArray()});
+        records.append({timestamp + latency, SessionRecord::AcknowledgementRecord, {}});
+    }
+
+    return records;
+}
+
+} // namespace
+
+class SessionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void recordAndRead();
+    void readUnfinished();
+    void readInvalid();
+    void recordService();
+    void replayFastest();
+    void replayOriginalTiming();
+    void replayDisconnected();
+};
+
+void SessionTest::recordAndRead()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("session.log");
+
+    SessionRecorder recorder;
+    QSignalSpy recordingChanged{&recorder, &SessionRecorder::recordingChanged};
+
+    QVERIFY(!recorder.isRecording());
+    QVERIFY2(recorder.open(fileName), qPrintable(recorder.errorString()));
+    QVERIFY(recorder.isRecording());
+    QCOMPARE(recorder.size(), qint64{SessionRecorder::HeaderSize});
+
+    recorder.recordStateChange(RobotService::ConnectedState);
+    recorder.recordFrame(driveFrame(3), true);
+    recorder.recordAcknowledgement();
+    recorder.recordNotification("V12Play");
+    recorder.recordFrame(RobotFrame::pause(), false);
+
+    QCOMPARE(recorder.size(), qint64{SessionRecorder::HeaderSize + 5 * SessionRecorder::RecordHeaderSize
+                                     + 1 + RobotFrame::Size + 7 + RobotFrame::Size});
+
+    recorder.close();
+    QVERIFY(!recorder.isRecording());
+    QCOMPARE(recordingChanged.count(), 2);
+    QCOMPARE(QFileInfo{fileName}.size(), qint64{SessionRecorder::HeaderSize + 5 * SessionRecorder::RecordHeaderSize
+                                                 + 1 + RobotFrame::Size + 7 + RobotFrame::Size});
+
+    // records after closing are dropped
+    recorder.recordAcknowledgement();
+
+    QList<SessionRecord> records;
+    QString errorString;
+    QVERIFY2(SessionRecorder::read(fileName, &records, &errorString), qPrintable(errorString));
+    QCOMPARE(records.size(), 5);
+
+    QCOMPARE(records[0].type, SessionRecord::StateRecord);
+    QCOMPARE(records[0].payload, QByteArray{1, static_cast<char>(RobotService::ConnectedState)});
+    QCOMPARE(records[1].type, SessionRecord::FrameRecord);
+    QCOMPARE(records[1].frame(), driveFrame(3));
+    QCOMPARE(records[2].type, SessionRecord::AcknowledgementRecord);
+    QVERIFY(records[2].payload.isEmpty());
+    QCOMPARE(records[3].type, SessionRecord::NotificationRecord);
+    QCOMPARE(records[3].payload, QByteArray{"V12Play"});
+    QCOMPARE(records[4].type, SessionRecord::UnacknowledgedFrameRecord);
+    QCOMPARE(records[4].frame(), RobotFrame::pause());
+
+    QVERIFY(std::is_sorted(records.begin(), records.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.timestamp < rhs.timestamp;
+    }));
+}
+
+// A log that wasn't closed, like after a crash, ends at the zeros of its last chunk.
+void SessionTest::readUnfinished()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("session.log");
+
+    SessionRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+
+    recorder.recordFrame(driveFrame(1), true);
+    recorder.recordFrame(driveFrame(2), true);
+
+    QList<SessionRecord> records;
+    QVERIFY(SessionRecorder::read(fileName, &records));
+    QVERIFY(QFileInfo{fileName}.size() > recorder.size());
+
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records[0].frame(), driveFrame(1));
+    QCOMPARE(records[1].frame(), driveFrame(2));
+}
+
+void SessionTest::readInvalid()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    QList<SessionRecord> records;
+    QString errorString;
+
+    QVERIFY(!SessionRecorder::read(temporaryDir.filePath("missing.log"), &records, &errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    const auto fileName = temporaryDir.filePath("other.log");
+    QFile file{fileName};
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write("EvoBotX1 but not a session log");
+    file.close();
+
+    errorString.clear();
+    QVERIFY(!SessionRecorder::read(fileName, &records, &errorString));
+    QVERIFY(errorString.contains(fileName));
+}
+
+// The service records its traffic with the simulated robot.
+void SessionTest::recordService()
+{
+    QTemporaryDir temporaryDir;
+    QVERIFY(temporaryDir.isValid());
+
+    const auto fileName = temporaryDir.filePath("session.log");
+
+    SessionRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+
+    RobotService service;
+    service.setRecorder(&recorder);
+
+    const auto transport = new SimulatedTransport;
+    transport->setSoundDuration(50);
+    service.attach(transport);
+    transport->connectToRobot();
+
+    QVERIFY(service.startAction(RobotService::ForwardAction, 3));
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+    QVERIFY(service.playSound(4));
+    QTRY_COMPARE(service.currentSound(), 4);
+    QTRY_COMPARE(service.currentSound(), -4);
+
+    recorder.close();
+
+    QList<SessionRecord> records;
+    QVERIFY(SessionRecorder::read(fileName, &records));
+
+    const auto hasRecord = [&records](SessionRecord::Type type, const QByteArray &payload) {
+        return std::any_of(records.begin(), records.end(), [type, &payload](const auto &record) {
+            return record.type == type && record.payload == payload;
+        });
+    };
+
+    QVERIFY(hasRecord(SessionRecord::StateRecord, QByteArray{1, static_cast<char>(RobotService::ConnectedState)}));
+    QVERIFY(hasRecord(SessionRecord::FrameRecord, driveFrame(3).toByteArray()));
+    QVERIFY(hasRecord(SessionRecord::AcknowledgementRecord, {}));
+    QVERIFY(hasRecord(SessionRecord::NotificationRecord, "V4Play"));
+    QVERIFY(hasRecord(SessionRecord::NotificationRecord, "V4End"));
+}
+
+void SessionTest::replayFastest()
+{
+    SimulatedTransport transport;
+    transport.setWriteLatency(5);
+    transport.connectToRobot();
+
+    SessionReplayer replayer;
+    QSignalSpy recordsChanged{&replayer, &SessionReplayer::recordsChanged};
+    QSignalSpy finished{&replayer, &SessionReplayer::finished};
+
+    // a slow session, which the replay doesn't wait for
+    replayer.setRecords(acknowledgedFrames(20, 500000000, 20000000));
+    QCOMPARE(recordsChanged.count(), 1);
+    QCOMPARE(replayer.frameCount(), 20);
+    QCOMPARE(replayer.recordedLatency(), 20.0);
+
+    replayer.setTransport(&transport);
+    replayer.setTiming(SessionReplayer::FastestTiming);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QVERIFY2(replayer.start(), qPrintable(replayer.errorString()));
+    QVERIFY(replayer.isRunning());
+    QTRY_COMPARE(finished.count(), 1);
+
+    QVERIFY(clock.elapsed() < 5000);
+    QVERIFY(!replayer.isRunning());
+    QCOMPARE(replayer.framesReplayed(), 20);
+    QCOMPARE(transport.framesReceived(), 20);
+    QCOMPARE(transport.currentFrame(), driveFrame(20));
+    QVERIFY(replayer.replayedLatency() >= 4);
+}
+
+void SessionTest::replayOriginalTiming()
+{
+    SimulatedTransport transport;
+    transport.connectToRobot();
+
+    auto records = acknowledgedFrames(1, 0, 10000000);
+    records.append({300000000, SessionRecord::UnacknowledgedFrameRecord, driveFrame(7).toByteArray()});
+
+    SessionReplayer replayer;
+    QSignalSpy finished{&replayer, &SessionReplayer::finished};
+    replayer.setRecords(records);
+    replayer.setTransport(&transport);
+    QCOMPARE(replayer.timing(), SessionReplayer::OriginalTiming);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QVERIFY(replayer.start());
+    QTRY_COMPARE(transport.currentFrame(), driveFrame(1));
+    QCOMPARE(replayer.framesReplayed(), 1);
+
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(clock.elapsed() >= 295);
+    QCOMPARE(replayer.framesReplayed(), 2);
+    QTRY_COMPARE(transport.currentFrame(), driveFrame(7));
+}
+
+void SessionTest::replayDisconnected()
+{
+    SimulatedTransport transport;
+    SessionReplayer replayer;
+    replayer.setRecords(acknowledgedFrames(3, 1000000, 1000000));
+
+    QVERIFY(!replayer.start());
+    QVERIFY(!replayer.errorString().isEmpty());
+
+    replayer.setTransport(&transport);
+    QVERIFY(!replayer.start());
+    QVERIFY(!replayer.isRunning());
+    QCOMPARE(transport.framesReceived(), 0);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::SessionTest)
+
+#include "tst_session.moc"
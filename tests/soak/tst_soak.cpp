@@ -0,0 +1,144 @@
+#include "deviceregistry.h"
+#include "robotmetrics.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+#include "transmitscheduler.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QtTest>
+
+#include <numeric>
+
+namespace EvoBot {
+
+namespace {
+
+// Milliseconds per test row. The default keeps a plain test run short,
+// set EVOBOT_SOAK_DURATION for real soak runs.
+const auto s_defaultDuration = 5000;
+const auto s_acknowledgeTimeout = 1000;
+
+const char s_actions[] = {'F', 'B', 'L', 'R', 'O', 'C', 'U', 'D', 'V', 'E'};
+
+int soakDuration()
+{
+    auto ok = false;
+    const auto duration = qEnvironmentVariableIntValue("EVOBOT_SOAK_DURATION", &ok);
+    return ok && duration > 0 ? duration : s_defaultDuration;
+}
+
+QBluetoothDeviceInfo advertisement(QRandomGenerator *random)
+{
+    const QBluetoothAddress address{0x0012a1000000ull + random->bounded(4096u)};
+
+    QBluetoothDeviceInfo device{address, QStringLiteral("Evolution-Robot"), 0};
+    device.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    device.setRssi(static_cast<qint16>(-40 - static_cast<int>(random->bounded(50u))));
+    return device;
+}
+
+} // namespace
+
+class SoakTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void soak_data();
+    void soak();
+};
+
+void SoakTest::soak_data()
+{
+    QTest::addColumn<bool>("writeWithoutResponse");
+    QTest::addColumn<double>("packetLoss");
+
+    QTest::newRow("with response") << false << 0.0;
+    QTest::newRow("with response, lossy") << false << 0.05;
+    QTest::newRow("without response") << true << 0.0;
+}
+
+// Drives a simulated robot with random actions while thousands of devices advertise, and
+// checks that neither the registry nor the write bookkeeping drifts over time.
+void SoakTest::soak()
+{
+    QFETCH(bool, writeWithoutResponse);
+    QFETCH(double, packetLoss);
+
+    QRandomGenerator random{42};
+
+    RobotService service;
+    service.setWriteWithoutResponse(writeWithoutResponse);
+
+    const auto transport = new SimulatedTransport;
+    transport->setWriteJitter(30);
+    transport->setPacketLoss(packetLoss);
+    transport->setSoundDuration(300);
+    service.attach(transport);
+    transport->connectToRobot();
+
+    DeviceRegistry registry;
+    registry.setTimeToLive(500);
+
+    QVERIFY(service.state() == RobotService::ConnectedState);
+
+    const auto duration = soakDuration();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    while (clock.elapsed() < duration) {
+        const auto action = s_actions[random.bounded(static_cast<quint32>(sizeof s_actions))];
+        const auto index = static_cast<int>(random.bounded(8u));
+
+        if (random.bounded(8u) == 0)
+            service.startAction(RobotService::PauseAction);
+        else if (random.bounded(3u) == 0)
+            service.stopAction(QChar::fromLatin1(action), index);
+        else
+            service.startAction(QChar::fromLatin1(action), index);
+
+        for (auto i = 0; i < 50; ++i)
+            registry.addDevice(advertisement(&random));
+
+        QVERIFY(registry.count() <= registry.capacity());
+        QTest::qWait(static_cast<int>(random.bounded(5u, 40u)));
+    }
+
+    // let the last write settle, lost writes are retried after the acknowledge timeout
+    service.startAction(RobotService::PauseAction);
+    QTRY_VERIFY_WITH_TIMEOUT(transport->currentFrame() == service.currentMessage(), 3 * s_acknowledgeTimeout);
+    QTRY_VERIFY_WITH_TIMEOUT(!service.transmitScheduler()->isWritePending(), 2 * s_acknowledgeTimeout);
+
+    const auto metrics = service.metrics();
+
+    QVERIFY(metrics->writesIssued() > 0);
+    QCOMPARE(metrics->changeWrites() + metrics->keepAliveWrites(), metrics->writesIssued());
+    QVERIFY(metrics->writesAcknowledged() + metrics->writesLost() <= metrics->writesIssued());
+
+    if (writeWithoutResponse) {
+        QCOMPARE(metrics->writesAcknowledged(), 0);
+        QCOMPARE(metrics->writesLost(), 0);
+    } else {
+        QVERIFY(metrics->writesAcknowledged() > 0);
+        QVERIFY(metrics->maximumLatency() < s_acknowledgeTimeout);
+        QVERIFY(metrics->minimumLatency() <= metrics->averageLatency());
+        QVERIFY(metrics->averageLatency() <= metrics->maximumLatency());
+
+        const auto histogram = metrics->latencyHistogram();
+        QVERIFY(std::accumulate(histogram.begin(), histogram.end(), 0) <= metrics->writesAcknowledged());
+
+        if (packetLoss == 0)
+            QCOMPARE(metrics->writesLost(), 0);
+    }
+
+    // silent devices expire, so the registry drains once the advertisements stop
+    QTRY_COMPARE_WITH_TIMEOUT(registry.count(), 0, 2000);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::SoakTest)
+
+#include "tst_soak.moc"
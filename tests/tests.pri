@@ -0,0 +1,8 @@
+# Shared settings of the test cases, include this from each test's project.
+
+QT = core testlib
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+include($$PWD/../evobot/evobot.pri)
@@ -0,0 +1,19 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    actionmodel \
+    benchmarks \
+    commandprocessor \
+    devicecache \
+    deviceregistry \
+    eventsink \
+    fleetcontroller \
+    proxies \
+    robotgateway \
+    robotgroup \
+    robotservice \
+    sequencer \
+    session \
+    soak \
+    transmitscheduler \
+    utilities
@@ -0,0 +1,6 @@
+TARGET = tst_transmitscheduler
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_transmitscheduler.cpp
@@ -0,0 +1,406 @@
+#include "controller.h"
+#include "robotmetrics.h"
+#include "robotservice.h"
+#include "simulatedtransport.h"
+#include "transmitscheduler.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace EvoBot {
+
+namespace {
+
+// Completes each requested write right away, like writes without response do.
+void completeWrites(TransmitScheduler *scheduler, QList<TransmitScheduler::Reason> *reasons)
+{
+    QObject::connect(scheduler, &TransmitScheduler::transmitRequested, scheduler, [scheduler, reasons](auto reason) {
+        reasons->append(reason);
+        scheduler->writeCompleted();
+    });
+}
+
+void recordRequests(TransmitScheduler *scheduler, QList<TransmitScheduler::Reason> *reasons)
+{
+    QObject::connect(scheduler, &TransmitScheduler::transmitRequested, scheduler, [reasons](auto reason) {
+        reasons->append(reason);
+    });
+}
+
+} // namespace
+
+class TransmitSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void connectionInterval();
+    void roundTripTime();
+    void driveRateLimit();
+    void connectionProfile();
+    void idlePolicy();
+    void idleWithoutKeepAlives();
+    void idleRobot();
+    void stopPriority();
+    void stopWhileWritePending();
+    void stopAfterLostWrite();
+    void cosmeticInterval();
+    void urgentWithoutResponse();
+};
+
+void TransmitSchedulerTest::connectionInterval()
+{
+    TransmitScheduler scheduler;
+    QSignalSpy connectionIntervalChanged{&scheduler, &TransmitScheduler::connectionIntervalChanged};
+
+    QCOMPARE(scheduler.connectionInterval(), 0);
+    QCOMPARE(scheduler.effectiveMinimumInterval(), scheduler.minimumInterval());
+
+    // a short connection interval doesn't speed up transmission
+    scheduler.setConnectionInterval(50);
+    QCOMPARE(connectionIntervalChanged.count(), 1);
+    QCOMPARE(scheduler.effectiveMinimumInterval(), 100);
+
+    scheduler.setConnectionInterval(150);
+    scheduler.setConnectionInterval(150);
+    QCOMPARE(connectionIntervalChanged.count(), 2);
+    QCOMPARE(scheduler.effectiveMinimumInterval(), 150);
+
+    // the transmit interval follows with the next change
+    scheduler.start();
+    QCOMPARE(scheduler.interval(), 150);
+
+    scheduler.setConnectionInterval(-10);
+    QCOMPARE(scheduler.connectionInterval(), 0);
+    scheduler.messageChanged();
+    QCOMPARE(scheduler.interval(), 100);
+}
+
+void TransmitSchedulerTest::roundTripTime()
+{
+    TransmitScheduler scheduler;
+    scheduler.setMinimumInterval(10);
+    scheduler.start();
+
+    QSignalSpy roundTripTimeChanged{&scheduler, &TransmitScheduler::roundTripTimeChanged};
+
+    scheduler.writeIssued();
+    QVERIFY(scheduler.isWritePending());
+    QTest::qWait(40);
+    scheduler.writeAcknowledged();
+
+    QVERIFY(!scheduler.isWritePending());
+    QCOMPARE(roundTripTimeChanged.count(), 1);
+    QVERIFY(scheduler.roundTripTime() >= 40);
+    QCOMPARE(scheduler.effectiveMinimumInterval(), scheduler.roundTripTime());
+
+    // the slowest of the three limits wins
+    scheduler.setConnectionInterval(scheduler.roundTripTime() + 20);
+    QCOMPARE(scheduler.effectiveMinimumInterval(), scheduler.connectionInterval());
+}
+
+// The drive vector isn't changed more often than frames can reach the robot.
+void TransmitSchedulerTest::driveRateLimit()
+{
+    RobotService service;
+    service.transmitScheduler()->setConnectionInterval(250);
+
+    service.setDriveVector(0, 1);
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 3));
+
+    QElapsedTimer clock;
+    clock.start();
+
+    service.setDriveVector(1, 0);
+    QTest::qWait(150);
+    QVERIFY(service.isActionActive(RobotService::ForwardAction, 3));
+
+    QTRY_VERIFY(service.isActionActive(RobotService::TurnRightAction, 3));
+    QVERIFY(clock.elapsed() >= 240);
+}
+
+// Without a connected robot the profile is only remembered, and the interval stays unknown.
+void TransmitSchedulerTest::connectionProfile()
+{
+    Controller controller;
+    QSignalSpy connectionProfileChanged{&controller, &Controller::connectionProfileChanged};
+
+    QCOMPARE(controller.connectionProfile(), Controller::DefaultProfile);
+
+    controller.setConnectionProfile(Controller::LowLatencyProfile);
+    controller.setConnectionProfile(Controller::LowLatencyProfile);
+    QCOMPARE(connectionProfileChanged.count(), 1);
+    QCOMPARE(controller.connectionProfile(), Controller::LowLatencyProfile);
+
+    QCOMPARE(controller.connectionInterval(), 0.0);
+    QCOMPARE(controller.robotService()->transmitScheduler()->connectionInterval(), 0);
+}
+
+void TransmitSchedulerTest::idlePolicy()
+{
+    TransmitScheduler scheduler;
+    scheduler.setMinimumInterval(20);
+    scheduler.setKeepAliveInterval(50);
+    scheduler.setIdleTimeout(200);
+    scheduler.setIdleKeepAliveInterval(400);
+
+    QList<TransmitScheduler::Reason> reasons;
+    completeWrites(&scheduler, &reasons);
+    QSignalSpy idleChanged{&scheduler, &TransmitScheduler::idleChanged};
+
+    // only a paused robot becomes idle
+    scheduler.start();
+    QTest::qWait(300);
+    QVERIFY(!scheduler.isIdle());
+
+    scheduler.setPaused(true);
+    QTest::qWait(150);
+    QVERIFY(!scheduler.isIdle());
+
+    QTRY_VERIFY(scheduler.isIdle());
+    QCOMPARE(idleChanged.count(), 1);
+
+    reasons.clear();
+    QTest::qWait(900);
+    QVERIFY(reasons.count(TransmitScheduler::KeepAlive) >= 1);
+    QVERIFY(reasons.count(TransmitScheduler::KeepAlive) <= 3);
+
+    // the next change resumes the full rate
+    scheduler.messageChanged();
+    QVERIFY(!scheduler.isIdle());
+    QCOMPARE(idleChanged.count(), 2);
+
+    reasons.clear();
+    QTest::qWait(150);
+    QVERIFY(reasons.count(TransmitScheduler::KeepAlive) >= 2);
+
+    QTRY_VERIFY(scheduler.isIdle());
+    scheduler.setPaused(false);
+    QVERIFY(!scheduler.isIdle());
+
+    // without idle timeout the robot stays active
+    scheduler.setPaused(true);
+    scheduler.setIdleTimeout(0);
+    QTest::qWait(300);
+    QVERIFY(!scheduler.isIdle());
+
+    scheduler.stop();
+    QCOMPARE(idleChanged.count(), 4);
+}
+
+void TransmitSchedulerTest::idleWithoutKeepAlives()
+{
+    TransmitScheduler scheduler;
+    scheduler.setMinimumInterval(20);
+    scheduler.setKeepAliveInterval(50);
+    scheduler.setIdleTimeout(100);
+    scheduler.setIdleKeepAliveInterval(0);
+    scheduler.setPaused(true);
+
+    QList<TransmitScheduler::Reason> reasons;
+    completeWrites(&scheduler, &reasons);
+
+    scheduler.start();
+    QTRY_VERIFY(scheduler.isIdle());
+
+    reasons.clear();
+    QTest::qWait(500);
+    QVERIFY(reasons.isEmpty());
+
+    scheduler.messageChanged();
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+    QTRY_VERIFY(reasons.contains(TransmitScheduler::KeepAlive));
+}
+
+// A paused robot stops receiving keep-alives, and driving it resumes them.
+void TransmitSchedulerTest::idleRobot()
+{
+    RobotService service;
+    const auto scheduler = service.transmitScheduler();
+    scheduler->setIdleTimeout(200);
+    scheduler->setIdleKeepAliveInterval(0);
+
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+    transport->connectToRobot();
+
+    QVERIFY(scheduler->isPaused());
+    QTRY_VERIFY(scheduler->isIdle());
+    QTRY_VERIFY(!scheduler->isWritePending());
+
+    const auto framesReceived = transport->framesReceived();
+    QTest::qWait(2 * scheduler->keepAliveInterval());
+    QCOMPARE(transport->framesReceived(), framesReceived);
+
+    QVERIFY(service.startAction(RobotService::ForwardAction, 1));
+    QVERIFY(!scheduler->isPaused());
+    QVERIFY(!scheduler->isIdle());
+
+    QTRY_VERIFY(transport->framesReceived() >= framesReceived + 3);
+    QVERIFY(!scheduler->isIdle());
+}
+
+void TransmitSchedulerTest::stopPriority()
+{
+    TransmitScheduler scheduler;
+    QList<TransmitScheduler::Reason> reasons;
+    recordRequests(&scheduler, &reasons);
+
+    // nothing is requested before the scheduler runs
+    scheduler.messageChanged(TransmitScheduler::StopPriority);
+    QVERIFY(reasons.isEmpty());
+
+    scheduler.start();
+    scheduler.messageChanged(TransmitScheduler::StopPriority);
+    scheduler.messageChanged(TransmitScheduler::MotionPriority);
+
+    QCOMPARE(reasons, (QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged,
+                                                         TransmitScheduler::UrgentChange,
+                                                         TransmitScheduler::MessageChanged}));
+}
+
+// Only one write is in flight, a stop goes out as soon as the pending write got acknowledged.
+void TransmitSchedulerTest::stopWhileWritePending()
+{
+    TransmitScheduler scheduler;
+    QList<TransmitScheduler::Reason> reasons;
+    recordRequests(&scheduler, &reasons);
+
+    scheduler.start();
+    scheduler.writeIssued();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::MotionPriority);
+    scheduler.messageChanged(TransmitScheduler::StopPriority);
+    scheduler.messageChanged(TransmitScheduler::ActuatorPriority);
+    QVERIFY(reasons.isEmpty());
+
+    scheduler.writeAcknowledged();
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::UrgentChange});
+
+    // the urgency ends with the write that delivered the stop
+    scheduler.writeIssued();
+    scheduler.messageChanged(TransmitScheduler::MotionPriority);
+    scheduler.writeAcknowledged();
+    QCOMPARE(reasons, (QList<TransmitScheduler::Reason>{TransmitScheduler::UrgentChange,
+                                                         TransmitScheduler::MessageChanged}));
+}
+
+void TransmitSchedulerTest::stopAfterLostWrite()
+{
+    TransmitScheduler scheduler;
+    QList<TransmitScheduler::Reason> reasons;
+    recordRequests(&scheduler, &reasons);
+    QSignalSpy writeLost{&scheduler, &TransmitScheduler::writeLost};
+
+    scheduler.start();
+    scheduler.writeIssued();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::StopPriority);
+    QVERIFY(reasons.isEmpty());
+
+    QTRY_COMPARE_WITH_TIMEOUT(writeLost.count(), 1, 2000);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::UrgentChange});
+    QVERIFY(!scheduler.isWritePending());
+}
+
+// Cosmetic changes only wait for the cosmetic interval since the previous cosmetic change,
+// more urgent changes and keep-alives don't delay them.
+void TransmitSchedulerTest::cosmeticInterval()
+{
+    TransmitScheduler scheduler;
+    QCOMPARE(scheduler.cosmeticInterval(), 0);
+
+    scheduler.setMinimumInterval(400);
+    scheduler.setCosmeticInterval(150);
+
+    QList<TransmitScheduler::Reason> reasons;
+    recordRequests(&scheduler, &reasons);
+
+    scheduler.start();
+    scheduler.writeIssued();
+    scheduler.writeAcknowledged();
+    reasons.clear();
+
+    // the write before doesn't matter
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+
+    QElapsedTimer clock;
+    clock.start();
+
+    scheduler.writeIssued();
+    scheduler.writeAcknowledged();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    QVERIFY(reasons.isEmpty());
+
+    QTRY_VERIFY(!reasons.isEmpty());
+    QVERIFY(clock.elapsed() >= 140);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+
+    // a motion change takes the waiting cosmetic change along
+    scheduler.writeIssued();
+    scheduler.writeAcknowledged();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    scheduler.messageChanged(TransmitScheduler::MotionPriority);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+
+    QTest::qWait(200);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+
+    // a keep-alive written just before doesn't delay the next cosmetic change
+    scheduler.writeIssued();
+    scheduler.writeAcknowledged();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+
+    // without cosmetic interval cosmetic changes go out right away
+    scheduler.setCosmeticInterval(0);
+    scheduler.writeIssued();
+    scheduler.writeAcknowledged();
+    reasons.clear();
+
+    scheduler.messageChanged(TransmitScheduler::CosmeticPriority);
+    QCOMPARE(reasons, QList<TransmitScheduler::Reason>{TransmitScheduler::MessageChanged});
+}
+
+// Writes without response are coalesced until the event loop runs again, stops aren't.
+void TransmitSchedulerTest::urgentWithoutResponse()
+{
+    RobotService service;
+    service.setWriteWithoutResponse(true);
+
+    const auto transport = new SimulatedTransport;
+    service.attach(transport);
+    transport->connectToRobot();
+
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+
+    const auto metrics = service.metrics();
+    const auto writesIssued = metrics->writesIssued();
+
+    QVERIFY(service.startAction(RobotService::ForwardAction, 3));
+    QVERIFY(service.startAction(RobotService::OpenClawAction));
+    QCOMPARE(metrics->writesIssued(), writesIssued);
+
+    QVERIFY(service.stopAction(RobotService::ForwardAction, 3));
+    QCOMPARE(metrics->writesIssued(), writesIssued + 1);
+
+    QTRY_COMPARE(transport->currentFrame(), service.currentMessage());
+    QCOMPARE(metrics->writesAcknowledged(), 0);
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::TransmitSchedulerTest)
+
+#include "tst_transmitscheduler.moc"
@@ -0,0 +1,43 @@
+#include "utilities.h"
+
+#include <QtTest>
+
+namespace EvoBot {
+
+using namespace std::chrono_literals;
+
+class UtilitiesTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void backoffDelay_data();
+    void backoffDelay();
+};
+
+void UtilitiesTest::backoffDelay_data()
+{
+    QTest::addColumn<int>("failedAttempts");
+    QTest::addColumn<int>("delay");
+
+    QTest::newRow("first attempt") << 0 << 250;
+    QTest::newRow("second attempt") << 1 << 500;
+    QTest::newRow("fourth attempt") << 3 << 2000;
+    QTest::newRow("maximum") << 5 << 8000;
+    QTest::newRow("beyond maximum") << 6 << 8000;
+    QTest::newRow("many attempts") << 100 << 8000;
+}
+
+void UtilitiesTest::backoffDelay()
+{
+    QFETCH(int, failedAttempts);
+    QFETCH(int, delay);
+
+    QCOMPARE(EvoBot::backoffDelay(failedAttempts, 250ms, 8s).count(), std::chrono::milliseconds::rep{delay});
+}
+
+} // namespace EvoBot
+
+QTEST_GUILESS_MAIN(EvoBot::UtilitiesTest)
+
+#include "tst_utilities.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_utilities
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_utilities.cpp